@@ -11,6 +11,9 @@
 #include <QtGlobal>
 #include <QStringListIterator>
 #include "CaptureFactory.h"
+#include "CvSyntheticCapture.h"
+#include "CvRawCapture.h"
+#include "CvImageSequenceCapture.h"
 
 /*
  * Capture Factory constructor.
@@ -20,6 +23,13 @@
  * 	- [-m | --mirror] : flip image horizontally
  * 	- [-g | --gray] : convert to gray level
  * 	- [-s | --size] <width>x<height>: preferred width and height
+ * 	- [-p | --pool] <threads> : number of threads shared among
+ * 	streams when multiple devices or files are provided
+ * 	- [-y | --synthetic] <width>x<height>[@<rate>][:<pattern>] :
+ * 	synthetic frames (patterns are gradient, noise or moving), a
+ * 	missing or 0 rate means unthrottled
+ * 	- --raw <path>:<width>x<height>[@<rate>] : raw BGR frames file
+ * 	- --sequence <glob pattern>[@<rate>] : images sequence
  * @param argList program the argument list provided as a list of
  * strings
  */
@@ -32,7 +42,12 @@ CaptureFactory::CaptureFactory(const QStringList & argList) :
 	skipImages(false),
 	preferredWidth(0),
 	preferredHeight(0),
-	videoPath()
+	videoPath(),
+	frameSourceVideo(false),
+	frameSourceType(SYNTHETIC_SOURCE),
+	frameSourceSpec(),
+	sources(),
+	poolThreads(QThread::idealThreadCount())
 {
 	// C++ Like iterator
 	// for (QStringList::const_iterator it = argList.begin(); it != argList.end(); ++it)
@@ -55,6 +70,9 @@ CaptureFactory::CaptureFactory(const QStringList & argList) :
 					deviceNumber = 0;
 				}
 				liveVideo = true;
+				frameSourceVideo = false;
+				StreamSource source = {DEVICE_SOURCE, deviceNumber, QString()};
+				sources.append(source);
 			}
 			else
 			{
@@ -68,12 +86,44 @@ CaptureFactory::CaptureFactory(const QStringList & argList) :
 			{
 				videoPath = it.next();
 				liveVideo = false;
+				frameSourceVideo = false;
+				StreamSource source = {FILE_SOURCE, 0, videoPath};
+				sources.append(source);
 			}
 			else
 			{
 				qWarning("file tag found with no following filename");
 			}
 		}
+		else if (currentArg == "-y" || currentArg == "--synthetic" ||
+				 currentArg == "--raw" || currentArg == "--sequence")
+		{
+			// Next argument should be a frame source specification
+			if (it.hasNext())
+			{
+				if (currentArg == "--raw")
+				{
+					frameSourceType = RAW_SOURCE;
+				}
+				else if (currentArg == "--sequence")
+				{
+					frameSourceType = SEQUENCE_SOURCE;
+				}
+				else
+				{
+					frameSourceType = SYNTHETIC_SOURCE;
+				}
+				frameSourceSpec = it.next();
+				frameSourceVideo = true;
+				StreamSource source = {frameSourceType, 0, frameSourceSpec};
+				sources.append(source);
+			}
+			else
+			{
+				qWarning() << currentArg
+						   << "tag found with no following specification";
+			}
+		}
 		else if (currentArg == "-m" || currentArg == "--mirror")
 		{
 			flippedVideo = true;
@@ -86,6 +136,28 @@ CaptureFactory::CaptureFactory(const QStringList & argList) :
 		{
 			skipImages = true;
 		}
+		else if (currentArg == "-p" || currentArg == "--pool")
+		{
+			// Next argument should be the number of shared threads
+			if (it.hasNext())
+			{
+				QString threadsString(it.next());
+				bool convertOk;
+				int threads = threadsString.toInt(&convertOk, 10);
+				if (convertOk && threads >= 0)
+				{
+					poolThreads = threads;
+				}
+				else
+				{
+					qWarning("Warning: Invalid pool threads number %d", threads);
+				}
+			}
+			else
+			{
+				qWarning("Warning: pool tag found with no following threads number");
+			}
+		}
 		else if (currentArg == "-s" || currentArg == "--size")
 		{
 			if (it.hasNext())
@@ -131,6 +203,8 @@ CaptureFactory::~CaptureFactory()
 void CaptureFactory::setLiveVideo(const bool live)
 {
 	liveVideo = live;
+	frameSourceVideo = false;
+	sources.clear(); // overrides streams from arguments
 }
 
 /*
@@ -143,6 +217,7 @@ void CaptureFactory::setDeviceNumber(const int deviceNumber)
 	if (deviceNumber >= 0)
 	{
 		this->deviceNumber = deviceNumber;
+		sources.clear(); // overrides streams from arguments
 	}
 	else
 	{
@@ -159,6 +234,7 @@ void CaptureFactory::setFile(const QString & path)
 	if (QFile::exists(path))
 	{
 		videoPath = path;
+		sources.clear(); // overrides streams from arguments
 	}
 	else
 	{
@@ -167,6 +243,45 @@ void CaptureFactory::setFile(const QString & path)
 	}
 }
 
+/*
+ * Set synthetic frames specification and use synthetic frames
+ * @param spec the synthetic frames specification
+ * <width>x<height>[@<rate>][:<pattern>]
+ */
+void CaptureFactory::setSynthetic(const QString & spec)
+{
+	frameSourceSpec = spec;
+	frameSourceType = SYNTHETIC_SOURCE;
+	frameSourceVideo = true;
+	sources.clear(); // overrides streams from arguments
+}
+
+/*
+ * Set raw frames file specification and use raw frames file
+ * @param spec the raw frames specification
+ * <path>:<width>x<height>[@<rate>]
+ */
+void CaptureFactory::setRaw(const QString & spec)
+{
+	frameSourceSpec = spec;
+	frameSourceType = RAW_SOURCE;
+	frameSourceVideo = true;
+	sources.clear(); // overrides streams from arguments
+}
+
+/*
+ * Set images sequence specification and use images sequence
+ * @param spec the images sequence specification
+ * <glob pattern>[@<rate>]
+ */
+void CaptureFactory::setSequence(const QString & spec)
+{
+	frameSourceSpec = spec;
+	frameSourceType = SEQUENCE_SOURCE;
+	frameSourceVideo = true;
+	sources.clear(); // overrides streams from arguments
+}
+
 /*
  * Set video horizontal flip state (useful for selfies)
  * @param flipped the horizontal flip state
@@ -220,51 +335,273 @@ void CaptureFactory::setSize(const QSize & size)
 
 /*
  * Provide capture instanciated according to values
- * extracted from argument lists
+ * extracted from argument lists : the first stream when several
+ * streams are provided
  * @param updateThread the thread to run this capture or NULL if this
  * capture run in the current thread
  * @return the new capture instance
  */
 QcvVideoCapture * CaptureFactory::getCaptureInstance(QThread * updateThread)
 {
-	// ------------------------------------------------------------------------
-	// Opening Video Capture
-	// ------------------------------------------------------------------------
-	if (liveVideo)
+	// First stream of arguments list if any, otherwise the source set
+	// with setDeviceNumber or setFile
+	StreamSource source =
+	{
+		frameSourceVideo ? frameSourceType :
+			(liveVideo ? DEVICE_SOURCE : FILE_SOURCE),
+		deviceNumber,
+		frameSourceVideo ? frameSourceSpec : videoPath
+	};
+
+	if (!sources.isEmpty())
 	{
-		qDebug() << "opening device # " << deviceNumber;
+		source = sources.first();
+	}
+
+	capture = createCapture(source, updateThread);
+
+	return capture;
+}
+
+/*
+ * Set number of threads shared among captures in multi-stream mode
+ * @param nbThreads the number of threads (0 to update all captures
+ * in the current thread)
+ */
+void CaptureFactory::setPoolThreads(const int nbThreads)
+{
+	if (nbThreads >= 0)
+	{
+		poolThreads = nbThreads;
 	}
 	else
 	{
-		qDebug() << "opening video file " << videoPath;
+		qWarning("CaptureFactory::setPoolThreads: invalid number %d", nbThreads);
 	}
+}
 
-	qDebug() << "Opening ";
-	if (liveVideo)
+/*
+ * Number of streams found in arguments list
+ * @return the number of streams to open (at least 1)
+ */
+int CaptureFactory::getNbStreams() const
+{
+	return sources.isEmpty() ? 1 : sources.size();
+}
+
+/*
+ * Provide capture instanciated for a specific stream
+ * @param index the index of the stream in sources
+ * @param updateThread the thread to run this capture or NULL if this
+ * capture run in the current thread
+ * @return the new capture instance
+ */
+QcvVideoCapture * CaptureFactory::getStreamInstance(const int index,
+													QThread * updateThread)
+{
+	if (sources.isEmpty())
 	{
-		// Live video feed
-		qDebug() << "Live Video ... from camera # " << deviceNumber;
-		capture = new QcvVideoCapture(deviceNumber,
-									  flippedVideo,
-									  grayVideo,
-									  skipImages,
-									  preferredWidth,
-									  preferredHeight,
-									  updateThread);
+		// default source
+		return getCaptureInstance(updateThread);
 	}
-	else
+
+	if (index < 0 || index >= sources.size())
 	{
-		// Video file or stream
-		qDebug() << videoPath << " ... ";
-		capture = new QcvVideoCapture(videoPath,
-									  flippedVideo,
-									  grayVideo,
-									  skipImages,
-									  preferredWidth,
-									  preferredHeight,
-									  updateThread);
+		qWarning("CaptureFactory::getStreamInstance: invalid stream index %d",
+				 index);
+		return NULL;
 	}
 
-	return capture;
+	return createCapture(sources.at(index), updateThread);
 }
 
+/*
+ * Provide a capture pool containing one capture per stream found in
+ * arguments list running on poolThreads shared threads.
+ * @return a new capture pool (to be deleted by the caller)
+ */
+QcvCapturePool * CaptureFactory::getCapturePool()
+{
+	int nbStreams = getNbStreams();
+	// no need for more threads than streams
+	int nbThreads = poolThreads < nbStreams ? poolThreads : nbStreams;
+
+	qDebug() << "Opening " << nbStreams << " streams on " << nbThreads
+			 << " threads";
+
+	QcvCapturePool * pool = new QcvCapturePool((size_t) nbThreads);
+
+	for (int i = 0; i < nbStreams; i++)
+	{
+		QcvVideoCapture * streamCapture =
+			getStreamInstance(i, pool->nextThread());
+		if (streamCapture != NULL)
+		{
+			pool->addCapture(streamCapture);
+		}
+	}
+
+	return pool;
+}
+
+/*
+ * Creates a new capture instance
+ * @param source the source to open
+ * @param updateThread the thread to run this capture or NULL
+ * @return the new capture instance or NULL if source is invalid
+ */
+QcvVideoCapture * CaptureFactory::createCapture(const StreamSource & source,
+												QThread * updateThread)
+{
+	QcvVideoCapture * newCapture = NULL;
+
+	// ------------------------------------------------------------------------
+	// Opening Video Capture
+	// ------------------------------------------------------------------------
+	switch (source.type)
+	{
+		case DEVICE_SOURCE:
+			qDebug() << "opening device # " << source.deviceNumber;
+			break;
+		case FILE_SOURCE:
+			qDebug() << "opening video file " << source.path;
+			break;
+		case SYNTHETIC_SOURCE:
+			qDebug() << "opening synthetic source " << source.path;
+			break;
+		case RAW_SOURCE:
+			qDebug() << "opening raw frames file " << source.path;
+			break;
+		case SEQUENCE_SOURCE:
+		default:
+			qDebug() << "opening images sequence " << source.path;
+			break;
+	}
+
+	qDebug() << "Opening ";
+	switch (source.type)
+	{
+		case DEVICE_SOURCE:
+			// Live video feed
+			qDebug() << "Live Video ... from camera # " << source.deviceNumber;
+			newCapture = new QcvVideoCapture(source.deviceNumber,
+											 flippedVideo,
+											 grayVideo,
+											 skipImages,
+											 preferredWidth,
+											 preferredHeight,
+											 updateThread);
+			break;
+		case FILE_SOURCE:
+			// Video file or stream
+			qDebug() << source.path << " ... ";
+			newCapture = new QcvVideoCapture(source.path,
+											 flippedVideo,
+											 grayVideo,
+											 skipImages,
+											 preferredWidth,
+											 preferredHeight,
+											 updateThread);
+			break;
+		case SYNTHETIC_SOURCE:
+		{
+			Size frameSize;
+			double rate;
+			CvSyntheticCapture::Pattern pattern;
+			if (!CvSyntheticCapture::parse(source.path.toStdString(),
+										   frameSize, rate, pattern))
+			{
+				qWarning() << "invalid synthetic specification" << source.path;
+				break;
+			}
+
+			QString name;
+			name.sprintf("Synthetic %dx%d %s", frameSize.width,
+						 frameSize.height,
+						 CvSyntheticCapture::patternName(pattern));
+			qDebug() << name << " ... ";
+			Ptr<VideoCapture> synthetic(new CvSyntheticCapture(frameSize,
+															   rate,
+															   pattern));
+			newCapture = new QcvVideoCapture(synthetic,
+											 name,
+											 flippedVideo,
+											 grayVideo,
+											 skipImages,
+											 preferredWidth,
+											 preferredHeight,
+											 updateThread);
+			break;
+		}
+		case RAW_SOURCE:
+		{
+			string rawPath;
+			Size frameSize;
+			double rate;
+			if (!CvRawCapture::parse(source.path.toStdString(),
+									 rawPath, frameSize, rate))
+			{
+				qWarning() << "invalid raw specification" << source.path;
+				break;
+			}
+
+			QString name;
+			name.sprintf("Raw %s", rawPath.c_str());
+			qDebug() << name << " ... ";
+			Ptr<VideoCapture> raw(new CvRawCapture(rawPath, frameSize,
+												   CV_8UC3, rate));
+			if (!raw->isOpened())
+			{
+				qWarning() << "can not open raw frames file" << source.path;
+				break;
+			}
+			newCapture = new QcvVideoCapture(raw,
+											 name,
+											 flippedVideo,
+											 grayVideo,
+											 skipImages,
+											 preferredWidth,
+											 preferredHeight,
+											 updateThread);
+			break;
+		}
+		case SEQUENCE_SOURCE:
+		{
+			string pattern;
+			double rate;
+			if (!CvImageSequenceCapture::parse(source.path.toStdString(),
+											   pattern, rate))
+			{
+				qWarning() << "invalid images sequence specification"
+						   << source.path;
+				break;
+			}
+
+			QString name;
+			name.sprintf("Sequence %s", pattern.c_str());
+			qDebug() << name << " ... ";
+			Ptr<VideoCapture> sequence(new CvImageSequenceCapture(pattern,
+																  rate));
+			if (!sequence->isOpened())
+			{
+				qWarning() << "can not open images sequence" << source.path;
+				break;
+			}
+			newCapture = new QcvVideoCapture(sequence,
+											 name,
+											 flippedVideo,
+											 grayVideo,
+											 skipImages,
+											 preferredWidth,
+											 preferredHeight,
+											 updateThread);
+			break;
+		}
+		default:
+			qWarning("CaptureFactory::createCapture: unknown source type %d",
+					 source.type);
+			break;
+	}
+
+	return newCapture;
+}
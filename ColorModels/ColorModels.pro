@@ -30,6 +30,9 @@ CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
 MODULES = 	Palette \
 	CvProcessor \
 	CvProcessorException \
+	CvColorKernels \
+	CvBandExecutor \
+	CvLatencyHistogram \
 	CvColorSpaces \
 	QcvProcessor \
 	QcvColorSpaces \
@@ -39,6 +42,11 @@ MODULES = 	Palette \
 	QcvMatWidgetImage \
 	QGLImageRender \
 	QcvVideoCapture \
+	QcvCapturePool \
+	CvFrameSource \
+	CvSyntheticCapture \
+	CvRawCapture \
+	CvImageSequenceCapture \
 	CaptureFactory \
 	mainwindow
 for(f, MODULES){
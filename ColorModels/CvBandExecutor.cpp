@@ -0,0 +1,255 @@
+/*
+ * CvBandExecutor.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include "CvBandExecutor.h"
+
+/*
+ * Band executor constructor
+ * @param nbThreads number of threads (i.e. bands) including the
+ * calling thread. 0 uses the number of hardware threads
+ */
+CvBandExecutor::CvBandExecutor(const size_t nbThreads) :
+	nbBands(1),
+	taskRows(0),
+	generation(0),
+	pending(0),
+	stopping(false),
+	bandTicks(1, 0),
+	nbRuns(0)
+{
+	setNbThreads(nbThreads);
+}
+
+/*
+ * Band executor destructor.
+ * Stops and joins worker threads
+ */
+CvBandExecutor::~CvBandExecutor()
+{
+	stopWorkers();
+}
+
+/*
+ * Number of threads (i.e. bands) including the calling thread
+ * @return the number of threads
+ */
+size_t CvBandExecutor::getNbThreads() const
+{
+	return nbBands;
+}
+
+/*
+ * Changes the number of threads : stops current workers and
+ * launches new ones.
+ * @param nbThreads number of threads including the calling thread.
+ * 0 uses the number of hardware threads
+ * @note waits for the end of a run in progress
+ */
+void CvBandExecutor::setNbThreads(const size_t nbThreads)
+{
+	lock_guard<mutex> running(runLock);
+
+	size_t count = nbThreads;
+	if (count == 0)
+	{
+		count = thread::hardware_concurrency();
+		if (count == 0)
+		{
+			count = 1;
+		}
+	}
+
+	if (count == nbBands && workers.size() == nbBands - 1)
+	{
+		return;
+	}
+
+	stopWorkers();
+	nbBands = count;
+	bandTicks.assign(nbBands, 0);
+	nbRuns = 0;
+	startWorkers();
+}
+
+/*
+ * Runs a function on bands of rows and waits until all bands are
+ * processed. When there is less rows than bands, empty bands are
+ * skipped so function is only called on non empty ranges
+ * @param rows the number of rows to split into bands
+ * @param function the function to run on each band
+ */
+void CvBandExecutor::run(const int rows, const BandFunction & function)
+{
+	if (rows <= 0)
+	{
+		return;
+	}
+
+	lock_guard<mutex> running(runLock);
+
+	if (workers.empty() || rows == 1)
+	{
+		// nothing to split : run in the calling thread.
+		// Otherwise, when there is less rows than bands, some bands are
+		// empty and function is not called on them
+		int64 start = getTickCount();
+		function(Range(0, rows));
+		int64 ticks = getTickCount() - start;
+
+		unique_lock<mutex> lock(taskLock);
+		bandTicks[0] += ticks;
+		nbRuns++;
+		return;
+	}
+
+	{
+		unique_lock<mutex> lock(taskLock);
+		task = function;
+		taskRows = rows;
+		pending = workers.size();
+		generation++;
+	}
+	taskCondition.notify_all();
+
+	// calling thread processes the first band
+	const Range first = bandRange(0, rows);
+	int64 start = getTickCount();
+	if (!first.empty())
+	{
+		function(first);
+	}
+	int64 ticks = getTickCount() - start;
+
+	unique_lock<mutex> lock(taskLock);
+	doneCondition.wait(lock, [this] { return pending == 0; });
+	bandTicks[0] += ticks;
+	task = BandFunction();
+	nbRuns++;
+}
+
+/*
+ * Mean processing time of a band
+ * @param band the band index
+ * @return the mean processing time of this band per run in ms
+ * (or 0 if band does not exist)
+ */
+double CvBandExecutor::getBandTime(const size_t band) const
+{
+	if (band >= bandTicks.size() || nbRuns == 0)
+	{
+		return 0.0;
+	}
+
+	return ((double) bandTicks[band] * 1000.0) /
+		(getTickFrequency() * (double) nbRuns);
+}
+
+/*
+ * Resets bands processing times
+ */
+void CvBandExecutor::resetTimes()
+{
+	unique_lock<mutex> lock(taskLock);
+	bandTicks.assign(nbBands, 0);
+	nbRuns = 0;
+}
+
+/*
+ * Range of rows of a band
+ * @param band the band index
+ * @param rows the total number of rows
+ * @return the rows range of this band
+ */
+Range CvBandExecutor::bandRange(const size_t band, const int rows) const
+{
+	const int begin = (int) (((int64) rows * band) / nbBands);
+	const int end = (int) (((int64) rows * (band + 1)) / nbBands);
+	return Range(begin, end);
+}
+
+/*
+ * Worker thread loop : waits for new tasks and processes its band
+ * @param band the band processed by this worker
+ * @param startGeneration the task generation when worker was launched
+ */
+void CvBandExecutor::work(const size_t band, const size_t startGeneration)
+{
+	size_t lastGeneration = startGeneration;
+
+	unique_lock<mutex> lock(taskLock);
+
+	while (true)
+	{
+		taskCondition.wait(lock, [this, &lastGeneration]
+		{
+			return stopping || generation != lastGeneration;
+		});
+
+		if (stopping)
+		{
+			break;
+		}
+
+		lastGeneration = generation;
+		const Range range = bandRange(band, taskRows);
+		lock.unlock();
+
+		int64 start = getTickCount();
+		if (!range.empty())
+		{
+			task(range);
+		}
+		int64 ticks = getTickCount() - start;
+
+		lock.lock();
+		bandTicks[band] += ticks;
+		if (--pending == 0)
+		{
+			doneCondition.notify_one();
+		}
+	}
+}
+
+/*
+ * Launches worker threads
+ */
+void CvBandExecutor::startWorkers()
+{
+	size_t startGeneration;
+	{
+		unique_lock<mutex> lock(taskLock);
+		stopping = false;
+		startGeneration = generation;
+	}
+
+	for (size_t band = 1; band < nbBands; band++)
+	{
+		workers.push_back(thread(&CvBandExecutor::work, this, band,
+								 startGeneration));
+	}
+}
+
+/*
+ * Stops and joins worker threads
+ */
+void CvBandExecutor::stopWorkers()
+{
+	{
+		unique_lock<mutex> lock(taskLock);
+		stopping = true;
+	}
+	taskCondition.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		if (workers[i].joinable())
+		{
+			workers[i].join();
+		}
+	}
+	workers.clear();
+}
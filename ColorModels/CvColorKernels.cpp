@@ -0,0 +1,1247 @@
+/*
+ * CvColorKernels.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include <iostream>	// for cerr
+#include <algorithm>	// for min, max & fill
+#include <vector>
+using namespace std;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CVCOLORKERNELS_X86
+#include <immintrin.h>	// for SSSE3 & AVX2 intrinsics
+#endif
+
+#include "CvColorKernels.h"
+
+/*
+ * Indicates if SSSE3 instructions can be used on this processor
+ */
+#ifdef CVCOLORKERNELS_X86
+const bool CvColorKernels::useSSSE3 = checkHardwareSupport(CV_CPU_SSSE3);
+#else
+const bool CvColorKernels::useSSSE3 = false;
+#endif
+
+/*
+ * Indicates if AVX2 instructions can be used on this processor
+ */
+#if defined(CVCOLORKERNELS_X86) && defined(CV_CPU_AVX2)
+const bool CvColorKernels::useAVX2 = checkHardwareSupport(CV_CPU_AVX2);
+#elif defined(CVCOLORKERNELS_X86)
+const bool CvColorKernels::useAVX2 = __builtin_cpu_supports("avx2");
+#else
+const bool CvColorKernels::useAVX2 = false;
+#endif
+
+/*
+ * BGR to XYZ conversion coefficients (D65 white point) in BGR
+ * order for each of the X, Y and Z components
+ */
+const float CvColorKernels::xyzCoefficients[3][3] =
+{
+	{0.180423f, 0.357580f, 0.412453f},	// X
+	{0.072169f, 0.715160f, 0.212671f},	// Y
+	{0.950227f, 0.119193f, 0.019334f}	// Z
+};
+
+/*
+ * Saturation division table : (255 << HSV_SHIFT) / v
+ */
+int CvColorKernels::saturationDivisions[256];
+
+/*
+ * Full range hue division table : (256 << HSV_SHIFT) / (6 * delta)
+ */
+int CvColorKernels::hueDivisions[256];
+
+/*
+ * Indicates HSV division tables have been filled
+ */
+const bool CvColorKernels::hsvTablesReady = CvColorKernels::initHSVTables();
+
+/*
+ * Computes the per pixel maximum of B, G and R components of a BGR
+ * image into a single channel image
+ * @param src the source BGR image (CV_8UC3)
+ * @param dst the destination gray image (CV_8UC1)
+ */
+void CvColorKernels::maxChannels(const Mat & src, Mat & dst)
+{
+	if (src.type() != CV_8UC3)
+	{
+		cerr << "CvColorKernels::maxChannels : source is not CV_8UC3" << endl;
+		return;
+	}
+
+	dst.create(src.size(), CV_8UC1);
+
+	int rows = src.rows;
+	int cols = src.cols;
+
+	// process continuous images as a single row
+	if (src.isContinuous() && dst.isContinuous())
+	{
+		cols *= rows;
+		rows = 1;
+	}
+
+	for (int y = 0; y < rows; y++)
+	{
+		if (useSSSE3)
+		{
+			maxChannelsRowSSSE3(src.ptr<uchar>(y), dst.ptr<uchar>(y), cols);
+		}
+		else
+		{
+			maxChannelsRow(src.ptr<uchar>(y), dst.ptr<uchar>(y), cols);
+		}
+	}
+}
+
+/*
+ * Computes the colored maximum of B, G and R components : each
+ * component is colored with its own palette and the destination
+ * pixel receives the colored component with the largest norm.
+ * @param src the source BGR image (CV_8UC3)
+ * @param palettes the palettes to apply on B, G and R components
+ * @param dst the destination BGR image (CV_8UC3)
+ */
+void CvColorKernels::normMax(const Mat & src,
+							 const Palette * const palettes[3],
+							 Mat & dst)
+{
+	if (src.type() != CV_8UC3)
+	{
+		cerr << "CvColorKernels::normMax : source is not CV_8UC3" << endl;
+		return;
+	}
+
+	dst.create(src.size(), CV_8UC3);
+
+	// max(blue, green) then max(red, max(blue, green)) : green first so
+	// ties are resolved as in successive normMax calls
+	const int order[3] = {1, 0, 2};
+	const uchar * tables[3];
+	for (int i = 0; i < 3; i++)
+	{
+		tables[i] = palettes[order[i]]->getPackedMap();
+	}
+
+	int rows = src.rows;
+	int cols = src.cols;
+
+	// process continuous images as a single row
+	if (src.isContinuous() && dst.isContinuous())
+	{
+		cols *= rows;
+		rows = 1;
+	}
+
+	// colored components are built in small buffers (staying in cache)
+	// by chunks of pixels then combined by normMaxRow
+	const int chunk = 256;
+	vector<uchar> buffers(3 * 3 * chunk);
+	const uchar * colored[3];
+	for (int i = 0; i < 3; i++)
+	{
+		colored[i] = &buffers[i * 3 * chunk];
+	}
+
+	for (int y = 0; y < rows; y++)
+	{
+		const uchar * srcRow = src.ptr<uchar>(y);
+		uchar * dstRow = dst.ptr<uchar>(y);
+
+		for (int x = 0; x < cols; x += chunk)
+		{
+			const int width = MIN(chunk, cols - x);
+			for (int i = 0; i < 3; i++)
+			{
+				paletteRow(srcRow + 3 * x + order[i], 3, tables[i],
+						   &buffers[i * 3 * chunk], width);
+			}
+			normMaxRow(colored, 3, dstRow + 3 * x, width);
+		}
+	}
+}
+
+/*
+ * Computes the maximum of N images by comparing pixels integer
+ * squared norms rather than a per channel max like the OpenCV max
+ * function : each destination pixel receives the source pixel
+ * with the largest norm (the first one in sources order in case
+ * of ties).
+ * @param srcs the source images (all of the same size and type)
+ * @param dst the destination image
+ * @note norms are only compared on CV_8UC3 images, ordinary max is
+ * performed on other types
+ */
+void CvColorKernels::normMax(const vector<Mat> & srcs, Mat & dst)
+{
+	if (srcs.empty())
+	{
+		cerr << "CvColorKernels::normMax : no source images" << endl;
+		return;
+	}
+
+	for (size_t i = 1; i < srcs.size(); i++)
+	{
+		if (srcs[i].size() != srcs[0].size() ||
+			srcs[i].type() != srcs[0].type())
+		{
+			cerr << "CvColorKernels::normMax : incompatible images" << endl;
+			return;
+		}
+	}
+
+	if (srcs[0].type() != CV_8UC3)
+	{
+		// compute max the regular way with max function
+		srcs[0].copyTo(dst);
+		for (size_t i = 1; i < srcs.size(); i++)
+		{
+			max(dst, srcs[i], dst);
+		}
+		return;
+	}
+
+	dst.create(srcs[0].size(), CV_8UC3);
+
+	const int nbSources = (int) srcs.size();
+	bool continuous = true;
+	for (int i = 0; i < nbSources; i++)
+	{
+		continuous = continuous && srcs[i].isContinuous();
+	}
+
+	int rows = dst.rows;
+	int cols = dst.cols;
+
+	// process continuous images as a single row
+	if (continuous && dst.isContinuous())
+	{
+		cols *= rows;
+		rows = 1;
+	}
+
+	vector<const uchar *> srcRows(nbSources);
+	for (int y = 0; y < rows; y++)
+	{
+		for (int i = 0; i < nbSources; i++)
+		{
+			srcRows[i] = srcs[i].ptr<uchar>(y);
+		}
+		normMaxRow(&srcRows[0], nbSources, dst.ptr<uchar>(y), cols);
+	}
+}
+
+/*
+ * Norm maximum of N BGR rows (see normMax). Uses AVX2 or SSSE3
+ * instructions when available.
+ * @param srcs the source BGR rows
+ * @param nbSources the number of source rows
+ * @param dst the destination BGR row
+ * @param width the number of pixels in rows
+ */
+void CvColorKernels::normMaxRow(const uchar * const srcs[],
+								const int nbSources,
+								uchar * dst,
+								const int width)
+{
+	if (useAVX2)
+	{
+		normMaxRowAVX2(srcs, nbSources, dst, width);
+	}
+	else if (useSSSE3)
+	{
+		normMaxRowSSSE3(srcs, nbSources, dst, width);
+	}
+	else
+	{
+		normMaxRowScalar(srcs, nbSources, dst, 0, width);
+	}
+}
+
+/*
+ * Computes a single X, Y or Z component of a BGR image directly
+ * into a 8 bits image in a single pass (no intermediate
+ * XYZ image, no split, no scale conversion)
+ * @param src the source BGR image (CV_8UC3)
+ * @param component the component to compute : 0 for X, 1 for Y
+ * and 2 for Z
+ * @param precision number of fractional bits used for fixed point
+ * computation within [XYZ_MIN_BITS..XYZ_MAX_BITS] or
+ * XYZ_FLOAT for single precision floating point computation
+ * @param dst the destination image (CV_8UC1)
+ */
+void CvColorKernels::xyzComponent(const Mat & src,
+								  const int component,
+								  const int precision,
+								  Mat & dst)
+{
+	if (src.type() != CV_8UC3 || component < 0 || component > 2)
+	{
+		cerr << "CvColorKernels::xyzComponent : invalid source or component "
+			 << component << endl;
+		return;
+	}
+
+	dst.create(src.size(), CV_8UC1);
+
+	const float * coefs = xyzCoefficients[component];
+	int rows = src.rows;
+	int cols = src.cols;
+
+	// process continuous images as a single row
+	if (src.isContinuous() && dst.isContinuous())
+	{
+		cols *= rows;
+		rows = 1;
+	}
+
+	if (precision == XYZ_FLOAT)
+	{
+		const float cb = coefs[0];
+		const float cg = coefs[1];
+		const float cr = coefs[2];
+
+		for (int y = 0; y < rows; y++)
+		{
+			const uchar * srcRow = src.ptr<uchar>(y);
+			uchar * dstRow = dst.ptr<uchar>(y);
+
+			for (int x = 0; x < cols; x++)
+			{
+				const float value = cb * srcRow[3*x] +
+									cg * srcRow[3*x + 1] +
+									cr * srcRow[3*x + 2] + 0.5f;
+				// values are positive : truncation rounds
+				const int ivalue = (int) value;
+				dstRow[x] = (uchar) (ivalue > 255 ? 255 : ivalue);
+			}
+		}
+	}
+	else
+	{
+		const int bits = std::min(std::max(precision, (int) XYZ_MIN_BITS),
+								  (int) XYZ_MAX_BITS);
+		const float one = (float) (1 << bits);
+		const int cb = cvRound(coefs[0] * one);
+		const int cg = cvRound(coefs[1] * one);
+		const int cr = cvRound(coefs[2] * one);
+		const int half = 1 << (bits - 1);
+
+		for (int y = 0; y < rows; y++)
+		{
+			const uchar * srcRow = src.ptr<uchar>(y);
+			uchar * dstRow = dst.ptr<uchar>(y);
+
+			for (int x = 0; x < cols; x++)
+			{
+				const int value = (cb * srcRow[3*x] +
+								   cg * srcRow[3*x + 1] +
+								   cr * srcRow[3*x + 2] + half) >> bits;
+				dstRow[x] = (uchar) (value > 255 ? 255 : value);
+			}
+		}
+	}
+}
+
+/*
+ * Applies a packed BGR colormap on one channel of a row of pixels
+ * and writes interleaved BGR colors. Uses AVX2 gathers when
+ * available.
+ * @param src the first source value of the row
+ * @param stride the distance between two source values (i.e. the
+ * number of channels of the source image)
+ * @param table the packed BGR colormap : 256 BGR triplets followed
+ * by (at least) one padding byte
+ * @param dst the destination BGR row
+ * @param width the number of pixels in the row
+ */
+void CvColorKernels::paletteRow(const uchar * src,
+								const int stride,
+								const uchar * table,
+								uchar * dst,
+								const int width)
+{
+	if (useAVX2)
+	{
+		paletteRowAVX2(src, stride, table, dst, width);
+	}
+	else
+	{
+		paletteRowScalar(src, stride, table, dst, width);
+	}
+}
+
+/*
+ * Scalar colormap application on a row
+ * @param src the first source value of the row
+ * @param stride the distance between two source values
+ * @param table the packed BGR colormap
+ * @param dst the destination BGR row
+ * @param width the number of pixels in the row
+ */
+void CvColorKernels::paletteRowScalar(const uchar * src,
+									  const int stride,
+									  const uchar * table,
+									  uchar * dst,
+									  const int width)
+{
+	for (int x = 0; x < width; x++, src += stride, dst += 3)
+	{
+		const uchar * color = table + 3 * (*src);
+		dst[0] = color[0];
+		dst[1] = color[1];
+		dst[2] = color[2];
+	}
+}
+
+/*
+ * Fixed point BGR to HSV (full range hue) conversion into planar
+ * outputs in a single pass : max and min of components are
+ * computed once per pixel, hue palette and hue modulation by
+ * saturation or value are applied in the same pass.
+ * @param src the source BGR image (CV_8UC3)
+ * @param outputs the outputs to compute
+ */
+void CvColorKernels::hsv(const Mat & src, const PlanarOutputs & outputs)
+{
+	if (src.type() != CV_8UC3)
+	{
+		cerr << "CvColorKernels::hsv : source is not CV_8UC3" << endl;
+		return;
+	}
+
+	createOutputs(src, outputs);
+
+	const int round = 1 << (HSV_SHIFT - 1);
+	const uchar * hueTable =
+		(outputs.colored[0] != NULL && outputs.palettes[0] != NULL) ?
+		outputs.palettes[0]->getPackedMap() : NULL;
+	const bool mixing = (hueTable != NULL) && (outputs.mixed != NULL) &&
+		(outputs.mixPlane == 1 || outputs.mixPlane == 2);
+
+	for (int y = 0; y < src.rows; y++)
+	{
+		const uchar * srcRow = src.ptr<uchar>(y);
+		uchar * planes[3];
+		uchar * colored = hueTable != NULL ? outputs.colored[0]->ptr<uchar>(y) : NULL;
+		uchar * mixed = mixing ? outputs.mixed->ptr<uchar>(y) : NULL;
+		for (int c = 0; c < 3; c++)
+		{
+			planes[c] = outputs.planes[c] != NULL ? outputs.planes[c]->ptr<uchar>(y) : NULL;
+		}
+
+		for (int x = 0; x < src.cols; x++, srcRow += 3)
+		{
+			const int b = srcRow[0];
+			const int g = srcRow[1];
+			const int r = srcRow[2];
+
+			// shared terms
+			const int v = std::max(std::max(b, g), r);
+			const int diff = v - std::min(std::min(b, g), r);
+
+			const int s = (diff * saturationDivisions[v] + round) >> HSV_SHIFT;
+
+			int h;
+			if (v == r)
+			{
+				h = g - b;
+			}
+			else if (v == g)
+			{
+				h = b - r + 2 * diff;
+			}
+			else
+			{
+				h = r - g + 4 * diff;
+			}
+			h = (h * hueDivisions[diff] + round) >> HSV_SHIFT;
+			h += h < 0 ? 256 : 0;
+			h = h > 255 ? 255 : h;
+
+			writePlane(h, x, planes[0], hueTable, colored);
+			if (planes[1] != NULL)
+			{
+				planes[1][x] = (uchar) s;
+			}
+			if (planes[2] != NULL)
+			{
+				planes[2][x] = (uchar) v;
+			}
+
+			if (mixed != NULL)
+			{
+				// colored hue x (saturation or value) / 255
+				const int m = outputs.mixPlane == 1 ? s : v;
+				const uchar * color = hueTable + 3 * h;
+				for (int c = 0; c < 3; c++)
+				{
+					const int p = color[c] * m + 128;
+					mixed[3 * x + c] = (uchar) ((p + (p >> 8)) >> 8);
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Fixed point BGR to YCrCb conversion into planar outputs in a
+ * single pass : luma is computed once per pixel and shared by
+ * both chroma components, Cr and Cb palettes are applied in the
+ * same pass.
+ * @param src the source BGR image (CV_8UC3)
+ * @param outputs the outputs to compute
+ */
+void CvColorKernels::ycrcb(const Mat & src, const PlanarOutputs & outputs)
+{
+	if (src.type() != CV_8UC3)
+	{
+		cerr << "CvColorKernels::ycrcb : source is not CV_8UC3" << endl;
+		return;
+	}
+
+	createOutputs(src, outputs);
+
+	// ITU-R BT.601 coefficients as in CV_BGR2YCrCb
+	const int cb2y = 1868;	// 0.114
+	const int cg2y = 9617;	// 0.587
+	const int cr2y = 4899;	// 0.299
+	const int cy2cr = 11682;	// 0.713
+	const int cy2cb = 9241;	// 0.564
+	const int round = 1 << (YCRCB_SHIFT - 1);
+	const int delta = (128 << YCRCB_SHIFT) + round;
+
+	const uchar * tables[3];
+	for (int c = 0; c < 3; c++)
+	{
+		tables[c] = (outputs.colored[c] != NULL && outputs.palettes[c] != NULL) ?
+			outputs.palettes[c]->getPackedMap() : NULL;
+	}
+
+	for (int y = 0; y < src.rows; y++)
+	{
+		const uchar * srcRow = src.ptr<uchar>(y);
+		uchar * planes[3];
+		uchar * colored[3];
+		for (int c = 0; c < 3; c++)
+		{
+			planes[c] = outputs.planes[c] != NULL ? outputs.planes[c]->ptr<uchar>(y) : NULL;
+			colored[c] = tables[c] != NULL ? outputs.colored[c]->ptr<uchar>(y) : NULL;
+		}
+
+		for (int x = 0; x < src.cols; x++, srcRow += 3)
+		{
+			const int b = srcRow[0];
+			const int g = srcRow[1];
+			const int r = srcRow[2];
+
+			// shared luma
+			const int luma = (b * cb2y + g * cg2y + r * cr2y + round) >> YCRCB_SHIFT;
+			const int cr = saturate_cast<uchar>(((r - luma) * cy2cr + delta) >> YCRCB_SHIFT);
+			const int cb = saturate_cast<uchar>(((b - luma) * cy2cb + delta) >> YCRCB_SHIFT);
+
+			writePlane(luma, x, planes[0], tables[0], colored[0]);
+			writePlane(cr, x, planes[1], tables[1], colored[1]);
+			writePlane(cb, x, planes[2], tables[2], colored[2]);
+		}
+	}
+}
+
+/*
+ * Computes all components of a BGR color
+ * @param b the blue value
+ * @param g the green value
+ * @param r the red value
+ * @param values the components values in Component order
+ */
+void CvColorKernels::components(const int b, const int g, const int r,
+								uchar values[NbComponents])
+{
+	values[RED_COMPONENT] = (uchar) r;
+	values[GREEN_COMPONENT] = (uchar) g;
+	values[BLUE_COMPONENT] = (uchar) b;
+
+	// HSV with full range hue (as CV_BGR2HSV_FULL)
+	const int vmax = std::max(std::max(b, g), r);
+	const int vmin = std::min(std::min(b, g), r);
+	const int delta = vmax - vmin;
+	float hue = 0.0f;
+	if (delta > 0)
+	{
+		if (vmax == r)
+		{
+			hue = 60.0f * (g - b) / delta;
+		}
+		else if (vmax == g)
+		{
+			hue = 120.0f + 60.0f * (b - r) / delta;
+		}
+		else
+		{
+			hue = 240.0f + 60.0f * (r - g) / delta;
+		}
+		if (hue < 0.0f)
+		{
+			hue += 360.0f;
+		}
+	}
+	values[HUE_COMPONENT] = (uchar) (cvRound(hue * (256.0f / 360.0f)) & 0xFF);
+	values[SATURATION_COMPONENT] =
+		(uchar) (vmax > 0 ? cvRound(255.0f * delta / vmax) : 0);
+	values[VALUE_COMPONENT] = (uchar) vmax;
+
+	// YCrCb (as CV_BGR2YCrCb)
+	const float y = 0.114f * b + 0.587f * g + 0.299f * r;
+	values[Y_COMPONENT] = saturate_cast<uchar>(y);
+	values[CR_COMPONENT] = saturate_cast<uchar>((r - y) * 0.713f + 128.0f);
+	values[CB_COMPONENT] = saturate_cast<uchar>((b - y) * 0.564f + 128.0f);
+
+	// XYZ
+	for (int c = 0; c < 3; c++)
+	{
+		const float * coefs = xyzCoefficients[c];
+		values[X_COMPONENT + c] =
+			saturate_cast<uchar>(coefs[0] * b + coefs[1] * g + coefs[2] * r);
+	}
+}
+
+/*
+ * Builds a mosaic of all components of a BGR image in a single pass
+ * over the source : source is box averaged by factor x factor
+ * blocks, all components of the averaged colors are computed and
+ * written in their own tile of the destination (MOSAIC_COLUMNS
+ * tiles per row), so the cost depends on the destination size.
+ * @param src the source BGR image (CV_8UC3)
+ * @param factor the downscale factor of tiles
+ * @param palettes the palettes to apply on each component, or NULL
+ * to show a component as gray level
+ * @param dst the destination BGR mosaic (CV_8UC3) of
+ * MOSAIC_COLUMNS x (NbComponents / MOSAIC_COLUMNS) tiles
+ * @param tileRows the range of rows of tiles to compute (all rows
+ * by default) so bands of tiles can be computed concurrently on a
+ * destination allocated beforehand (see mosaicSize)
+ */
+void CvColorKernels::mosaic(const Mat & src,
+							const int factor,
+							const Palette * const palettes[NbComponents],
+							Mat & dst,
+							const Range & tileRows)
+{
+	const int tileWidth = factor > 0 ? src.cols / factor : 0;
+	const int tileHeight = factor > 0 ? src.rows / factor : 0;
+
+	if (src.type() != CV_8UC3 || tileWidth == 0 || tileHeight == 0)
+	{
+		cerr << "CvColorKernels::mosaic : invalid source or factor " << factor
+			 << endl;
+		return;
+	}
+
+	dst.create(mosaicSize(src.size(), factor), CV_8UC3);
+
+	const Range tiles = tileRows == Range::all() ? Range(0, tileHeight) :
+		Range(MAX(tileRows.start, 0), MIN(tileRows.end, tileHeight));
+
+	const uchar * tables[NbComponents];
+	int tileOffsets[NbComponents];
+	for (int c = 0; c < NbComponents; c++)
+	{
+		tables[c] = palettes[c] != NULL ? palettes[c]->getPackedMap() : NULL;
+		tileOffsets[c] = 3 * (c % MOSAIC_COLUMNS) * tileWidth;
+	}
+
+	const int area = factor * factor;
+	const int half = area / 2;
+	vector<int> sums(3 * tileWidth);
+	uchar values[NbComponents];
+	uchar * tileRowPtrs[NbComponents];
+
+	for (int ty = tiles.start; ty < tiles.end; ty++)
+	{
+		// box sums of factor source rows
+		std::fill(sums.begin(), sums.end(), 0);
+		for (int k = 0; k < factor; k++)
+		{
+			const uchar * srcRow = src.ptr<uchar>(ty * factor + k);
+			for (int tx = 0; tx < tileWidth; tx++)
+			{
+				int * sum = &sums[3 * tx];
+				for (int j = 0; j < factor; j++, srcRow += 3)
+				{
+					sum[0] += srcRow[0];
+					sum[1] += srcRow[1];
+					sum[2] += srcRow[2];
+				}
+			}
+		}
+
+		for (int c = 0; c < NbComponents; c++)
+		{
+			tileRowPtrs[c] =
+				dst.ptr<uchar>((c / MOSAIC_COLUMNS) * tileHeight + ty) +
+				tileOffsets[c];
+		}
+
+		for (int tx = 0; tx < tileWidth; tx++)
+		{
+			components((sums[3 * tx] + half) / area,
+					   (sums[3 * tx + 1] + half) / area,
+					   (sums[3 * tx + 2] + half) / area,
+					   values);
+
+			for (int c = 0; c < NbComponents; c++)
+			{
+				uchar * pixel = tileRowPtrs[c] + 3 * tx;
+				if (tables[c] != NULL)
+				{
+					const uchar * color = tables[c] + 3 * values[c];
+					pixel[0] = color[0];
+					pixel[1] = color[1];
+					pixel[2] = color[2];
+				}
+				else
+				{
+					pixel[0] = pixel[1] = pixel[2] = values[c];
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Size of the mosaic built by mosaic
+ * @param srcSize the source image size
+ * @param factor the downscale factor of tiles
+ * @return the size of the mosaic image (or an empty size if
+ * factor is too large)
+ */
+Size CvColorKernels::mosaicSize(const Size & srcSize, const int factor)
+{
+	if (factor <= 0)
+	{
+		return Size(0, 0);
+	}
+
+	return Size((srcSize.width / factor) * MOSAIC_COLUMNS,
+				(srcSize.height / factor) * (NbComponents / MOSAIC_COLUMNS));
+}
+
+/*
+ * Fills HSV division tables
+ * @return true
+ */
+bool CvColorKernels::initHSVTables()
+{
+	saturationDivisions[0] = 0;
+	hueDivisions[0] = 0;
+	for (int i = 1; i < 256; i++)
+	{
+		saturationDivisions[i] = cvRound((255 << HSV_SHIFT) / (double) i);
+		hueDivisions[i] = cvRound((256 << HSV_SHIFT) / (6.0 * i));
+	}
+	return true;
+}
+
+/*
+ * Writes a value into the gray and colored rows of a plane
+ * @param value the value to write
+ * @param x the pixel index in the row
+ * @param plane the gray plane row (or NULL)
+ * @param table the packed palette (or NULL)
+ * @param colored the colored plane row (or NULL)
+ */
+inline void CvColorKernels::writePlane(const int value,
+									   const int x,
+									   uchar * plane,
+									   const uchar * table,
+									   uchar * colored)
+{
+	if (plane != NULL)
+	{
+		plane[x] = (uchar) value;
+	}
+	if (colored != NULL)
+	{
+		const uchar * color = table + 3 * value;
+		colored[3 * x] = color[0];
+		colored[3 * x + 1] = color[1];
+		colored[3 * x + 2] = color[2];
+	}
+}
+
+/*
+ * Allocates planar outputs
+ * @param src the source image
+ * @param outputs the outputs to allocate
+ */
+void CvColorKernels::createOutputs(const Mat & src,
+								   const PlanarOutputs & outputs)
+{
+	for (int c = 0; c < 3; c++)
+	{
+		if (outputs.planes[c] != NULL)
+		{
+			outputs.planes[c]->create(src.size(), CV_8UC1);
+		}
+		if (outputs.colored[c] != NULL && outputs.palettes[c] != NULL)
+		{
+			outputs.colored[c]->create(src.size(), CV_8UC3);
+		}
+	}
+	if (outputs.mixed != NULL)
+	{
+		outputs.mixed->create(src.size(), CV_8UC3);
+	}
+}
+
+/*
+ * Scalar maximum of B, G and R components on a row
+ * @param src the source BGR row
+ * @param dst the destination gray row
+ * @param width the number of pixels in the row
+ */
+void CvColorKernels::maxChannelsRow(const uchar * src, uchar * dst,
+									const int width)
+{
+	for (int x = 0; x < width; x++, src += 3)
+	{
+		const uchar bg = src[0] > src[1] ? src[0] : src[1];
+		dst[x] = bg > src[2] ? bg : src[2];
+	}
+}
+
+/*
+ * Scalar norm maximum of N BGR rows from a given pixel
+ * @param srcs the source BGR rows
+ * @param nbSources the number of source rows
+ * @param dst the destination BGR row
+ * @param first the first pixel to process
+ * @param width the number of pixels in rows
+ */
+void CvColorKernels::normMaxRowScalar(const uchar * const srcs[],
+									  const int nbSources,
+									  uchar * dst,
+									  const int first,
+									  const int width)
+{
+	for (int x = 3 * first; x < 3 * width; x += 3)
+	{
+		const uchar * best = srcs[0] + x;
+		int bestNorm = best[0] * best[0] + best[1] * best[1] +
+			best[2] * best[2];
+		for (int i = 1; i < nbSources; i++)
+		{
+			const uchar * pixel = srcs[i] + x;
+			const int norm = pixel[0] * pixel[0] + pixel[1] * pixel[1] +
+				pixel[2] * pixel[2];
+			if (norm > bestNorm)
+			{
+				best = pixel;
+				bestNorm = norm;
+			}
+		}
+		dst[x] = best[0];
+		dst[x + 1] = best[1];
+		dst[x + 2] = best[2];
+	}
+}
+
+#ifdef CVCOLORKERNELS_X86
+/*
+ * Deinterleaves B, G and R components of 16 BGR pixels stored in 3
+ * consecutive 16 bytes blocks
+ * @param s0 the first block
+ * @param s1 the second block
+ * @param s2 the third block
+ * @param b the blue components
+ * @param g the green components
+ * @param r the red components
+ */
+__attribute__((target("ssse3")))
+static inline void deinterleaveBGR(const __m128i s0,
+								   const __m128i s1,
+								   const __m128i s2,
+								   __m128i & b,
+								   __m128i & g,
+								   __m128i & r)
+{
+	// Shuffle masks gathering B, G and R components of 16 pixels from
+	// 3 consecutive 16 bytes blocks (-1 clears the destination byte)
+	const __m128i b0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+	const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+	const __m128i r0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+	b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(s0, b0),
+								  _mm_shuffle_epi8(s1, b1)),
+					 _mm_shuffle_epi8(s2, b2));
+	g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(s0, g0),
+								  _mm_shuffle_epi8(s1, g1)),
+					 _mm_shuffle_epi8(s2, g2));
+	r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(s0, r0),
+								  _mm_shuffle_epi8(s1, r1)),
+					 _mm_shuffle_epi8(s2, r2));
+}
+
+/*
+ * Selects bytes of 16 BGR pixels stored in 3 consecutive 16 bytes blocks
+ * according to a per pixel mask
+ * @param mask the selection mask : one byte per pixel (0xFF selects
+ * the source pixel, 0 keeps the destination pixel)
+ * @param s the source blocks
+ * @param d the destination blocks
+ */
+__attribute__((target("ssse3")))
+static inline void selectBGR(const __m128i mask,
+							 const __m128i s[3],
+							 __m128i d[3])
+{
+	// Shuffle masks expanding each pixel mask byte to its 3 components
+	const __m128i e0 = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+	const __m128i e1 = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+	const __m128i e2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+	const __m128i m[3] = {_mm_shuffle_epi8(mask, e0),
+						  _mm_shuffle_epi8(mask, e1),
+						  _mm_shuffle_epi8(mask, e2)};
+
+	for (int k = 0; k < 3; k++)
+	{
+		d[k] = _mm_or_si128(_mm_and_si128(m[k], s[k]),
+							_mm_andnot_si128(m[k], d[k]));
+	}
+}
+
+/*
+ * Squared norms of 16 BGR pixels as 32 bits integers
+ * @param s the 3 blocks of 16 pixels
+ * @param norms the squared norms of pixels 0-3, 4-7, 8-11 and 12-15
+ */
+__attribute__((target("ssse3")))
+static inline void squaredNorms(const __m128i s[3], __m128i norms[4])
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i b, g, r;
+	deinterleaveBGR(s[0], s[1], s[2], b, g, r);
+
+	const __m128i b16[2] = {_mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero)};
+	const __m128i g16[2] = {_mm_unpacklo_epi8(g, zero), _mm_unpackhi_epi8(g, zero)};
+	const __m128i r16[2] = {_mm_unpacklo_epi8(r, zero), _mm_unpackhi_epi8(r, zero)};
+
+	for (int h = 0; h < 2; h++)
+	{
+		// b * b + g * g and r * r + 0 * 0 with multiply-adds
+		const __m128i bgLow = _mm_unpacklo_epi16(b16[h], g16[h]);
+		const __m128i bgHigh = _mm_unpackhi_epi16(b16[h], g16[h]);
+		const __m128i rLow = _mm_unpacklo_epi16(r16[h], zero);
+		const __m128i rHigh = _mm_unpackhi_epi16(r16[h], zero);
+		norms[2 * h] = _mm_add_epi32(_mm_madd_epi16(bgLow, bgLow),
+									 _mm_madd_epi16(rLow, rLow));
+		norms[2 * h + 1] = _mm_add_epi32(_mm_madd_epi16(bgHigh, bgHigh),
+										 _mm_madd_epi16(rHigh, rHigh));
+	}
+}
+
+/*
+ * SSSE3 maximum of B, G and R components on a row : 16 pixels are
+ * deinterleaved with byte shuffles per iteration, remaining pixels
+ * are processed by maxChannelsRow
+ * @param src the source BGR row
+ * @param dst the destination gray row
+ * @param width the number of pixels in the row
+ */
+__attribute__((target("ssse3")))
+void CvColorKernels::maxChannelsRowSSSE3(const uchar * src, uchar * dst,
+										 const int width)
+{
+	int x = 0;
+	for (; x <= width - 16; x += 16, src += 48)
+	{
+		__m128i b, g, r;
+		deinterleaveBGR(_mm_loadu_si128((const __m128i *) src),
+						_mm_loadu_si128((const __m128i *) (src + 16)),
+						_mm_loadu_si128((const __m128i *) (src + 32)),
+						b, g, r);
+
+		_mm_storeu_si128((__m128i *) (dst + x),
+						 _mm_max_epu8(_mm_max_epu8(b, g), r));
+	}
+
+	// remaining pixels
+	maxChannelsRow(src, dst + x, width - x);
+}
+
+/*
+ * AVX2 colormap application on a row : source values and colors
+ * of 8 pixels are gathered as 32 bits words then colors are packed
+ * back to 24 bits with byte shuffles, remaining pixels are
+ * processed by paletteRowScalar
+ * @param src the first source value of the row
+ * @param stride the distance between two source values
+ * @param table the packed BGR colormap
+ * @param dst the destination BGR row
+ * @param width the number of pixels in the row
+ */
+__attribute__((target("avx2")))
+void CvColorKernels::paletteRowAVX2(const uchar * src,
+									const int stride,
+									const uchar * table,
+									uchar * dst,
+									const int width)
+{
+	// byte offsets of 8 consecutive source values
+	const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+											   _mm256_set1_epi32(stride));
+	const __m256i lowByte = _mm256_set1_epi32(0xFF);
+	const __m256i three = _mm256_set1_epi32(3);
+	// keeps the 3 first bytes of each 32 bits color and packs them into
+	// the 12 lower bytes of each 128 bits lane
+	const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+										  0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+	// 32 bits gathers read up to 3 bytes past the 8th source value and
+	// 16 bytes stores write up to 4 bytes past the 8th color : keep enough
+	// pixels for the scalar tail so both stay within the row
+	int x = 0;
+	for (; x <= width - 11; x += 8, src += 8 * stride, dst += 24)
+	{
+		const __m256i indices =
+			_mm256_and_si256(_mm256_i32gather_epi32((const int *) src, offsets, 1),
+							 lowByte);
+		__m256i colors =
+			_mm256_i32gather_epi32((const int *) table,
+								   _mm256_mullo_epi32(indices, three), 1);
+		colors = _mm256_shuffle_epi8(colors, pack);
+
+		_mm_storeu_si128((__m128i *) dst, _mm256_castsi256_si128(colors));
+		_mm_storeu_si128((__m128i *) (dst + 12),
+						 _mm256_extracti128_si256(colors, 1));
+	}
+
+	// remaining pixels
+	paletteRowScalar(src, stride, table, dst, width - x);
+}
+
+/*
+ * SSSE3 norm maximum of N BGR rows : 16 pixels of each source are
+ * deinterleaved per iteration, their squared norms are computed
+ * with 16 bits multiply-adds and compared as 32 bits integers,
+ * then comparison masks are expanded back to interleaved bytes to
+ * select pixels. Remaining pixels are processed by normMaxRowScalar
+ * @param srcs the source BGR rows
+ * @param nbSources the number of source rows
+ * @param dst the destination BGR row
+ * @param width the number of pixels in rows
+ */
+__attribute__((target("ssse3")))
+void CvColorKernels::normMaxRowSSSE3(const uchar * const srcs[],
+									 const int nbSources,
+									 uchar * dst,
+									 const int width)
+{
+	int x = 0;
+	for (; x <= width - 16; x += 16)
+	{
+		__m128i best[3];
+		__m128i bestNorms[4];
+		for (int k = 0; k < 3; k++)
+		{
+			best[k] = _mm_loadu_si128((const __m128i *) (srcs[0] + 3 * x + 16 * k));
+		}
+		squaredNorms(best, bestNorms);
+
+		for (int i = 1; i < nbSources; i++)
+		{
+			__m128i pixels[3];
+			__m128i norms[4];
+			__m128i greater[4];
+			for (int k = 0; k < 3; k++)
+			{
+				pixels[k] = _mm_loadu_si128((const __m128i *) (srcs[i] + 3 * x + 16 * k));
+			}
+			squaredNorms(pixels, norms);
+
+			for (int k = 0; k < 4; k++)
+			{
+				greater[k] = _mm_cmpgt_epi32(norms[k], bestNorms[k]);
+				bestNorms[k] = _mm_or_si128(_mm_and_si128(greater[k], norms[k]),
+											_mm_andnot_si128(greater[k], bestNorms[k]));
+			}
+
+			// 32 bits masks to one byte per pixel
+			const __m128i mask =
+				_mm_packs_epi16(_mm_packs_epi32(greater[0], greater[1]),
+								_mm_packs_epi32(greater[2], greater[3]));
+			selectBGR(mask, pixels, best);
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			_mm_storeu_si128((__m128i *) (dst + 3 * x + 16 * k), best[k]);
+		}
+	}
+
+	// remaining pixels
+	normMaxRowScalar(srcs, nbSources, dst, x, width);
+}
+
+/*
+ * AVX2 norm maximum of N BGR rows : same as normMaxRowSSSE3 but
+ * squared norms of 16 pixels are computed and compared in 256 bits
+ * registers
+ * @param srcs the source BGR rows
+ * @param nbSources the number of source rows
+ * @param dst the destination BGR row
+ * @param width the number of pixels in rows
+ */
+__attribute__((target("avx2")))
+void CvColorKernels::normMaxRowAVX2(const uchar * const srcs[],
+									const int nbSources,
+									uchar * dst,
+									const int width)
+{
+	const __m256i zero = _mm256_setzero_si256();
+
+	int x = 0;
+	for (; x <= width - 16; x += 16)
+	{
+		__m128i best[3];
+		__m256i bestNorms[2];
+
+		for (int i = 0; i < nbSources; i++)
+		{
+			__m128i pixels[3];
+			for (int k = 0; k < 3; k++)
+			{
+				pixels[k] = _mm_loadu_si128((const __m128i *) (srcs[i] + 3 * x + 16 * k));
+			}
+
+			__m128i b, g, r;
+			deinterleaveBGR(pixels[0], pixels[1], pixels[2], b, g, r);
+			const __m256i b16 = _mm256_cvtepu8_epi16(b);
+			const __m256i g16 = _mm256_cvtepu8_epi16(g);
+			const __m256i r16 = _mm256_cvtepu8_epi16(r);
+
+			// b * b + g * g and r * r + 0 * 0 with multiply-adds
+			// (in each 128 bits lane : pixels 0-3 in low, 4-7 in high)
+			const __m256i bgLow = _mm256_unpacklo_epi16(b16, g16);
+			const __m256i bgHigh = _mm256_unpackhi_epi16(b16, g16);
+			const __m256i rLow = _mm256_unpacklo_epi16(r16, zero);
+			const __m256i rHigh = _mm256_unpackhi_epi16(r16, zero);
+			const __m256i norms[2] =
+			{
+				_mm256_add_epi32(_mm256_madd_epi16(bgLow, bgLow),
+								 _mm256_madd_epi16(rLow, rLow)),
+				_mm256_add_epi32(_mm256_madd_epi16(bgHigh, bgHigh),
+								 _mm256_madd_epi16(rHigh, rHigh))
+			};
+
+			if (i == 0)
+			{
+				best[0] = pixels[0];
+				best[1] = pixels[1];
+				best[2] = pixels[2];
+				bestNorms[0] = norms[0];
+				bestNorms[1] = norms[1];
+				continue;
+			}
+
+			const __m256i greaterLow = _mm256_cmpgt_epi32(norms[0], bestNorms[0]);
+			const __m256i greaterHigh = _mm256_cmpgt_epi32(norms[1], bestNorms[1]);
+			bestNorms[0] = _mm256_max_epi32(norms[0], bestNorms[0]);
+			bestNorms[1] = _mm256_max_epi32(norms[1], bestNorms[1]);
+
+			// 32 bits masks back to pixels order (packs undo unpacks in
+			// each lane) then to one byte per pixel
+			const __m256i greater16 = _mm256_packs_epi32(greaterLow, greaterHigh);
+			const __m256i greater8 = _mm256_packs_epi16(greater16, greater16);
+			const __m128i mask =
+				_mm256_castsi256_si128(_mm256_permute4x64_epi64(greater8, 0x08));
+			selectBGR(mask, pixels, best);
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			_mm_storeu_si128((__m128i *) (dst + 3 * x + 16 * k), best[k]);
+		}
+	}
+
+	// remaining pixels
+	normMaxRowScalar(srcs, nbSources, dst, x, width);
+}
+#else
+/*
+ * AVX2 colormap application on a row (not available on this
+ * architecture : falls back to paletteRowScalar)
+ * @param src the first source value of the row
+ * @param stride the distance between two source values
+ * @param table the packed BGR colormap
+ * @param dst the destination BGR row
+ * @param width the number of pixels in the row
+ */
+void CvColorKernels::paletteRowAVX2(const uchar * src,
+									const int stride,
+									const uchar * table,
+									uchar * dst,
+									const int width)
+{
+	paletteRowScalar(src, stride, table, dst, width);
+}
+
+/*
+ * SSSE3 maximum of B, G and R components on a row (not available on this
+ * architecture : falls back to maxChannelsRow)
+ * @param src the source BGR row
+ * @param dst the destination gray row
+ * @param width the number of pixels in the row
+ */
+void CvColorKernels::maxChannelsRowSSSE3(const uchar * src, uchar * dst,
+										 const int width)
+{
+	maxChannelsRow(src, dst, width);
+}
+
+/*
+ * SSSE3 norm maximum of N BGR rows (not available on this
+ * architecture : falls back to normMaxRowScalar)
+ * @param srcs the source BGR rows
+ * @param nbSources the number of source rows
+ * @param dst the destination BGR row
+ * @param width the number of pixels in rows
+ */
+void CvColorKernels::normMaxRowSSSE3(const uchar * const srcs[],
+									 const int nbSources,
+									 uchar * dst,
+									 const int width)
+{
+	normMaxRowScalar(srcs, nbSources, dst, 0, width);
+}
+
+/*
+ * AVX2 norm maximum of N BGR rows (not available on this
+ * architecture : falls back to normMaxRowScalar)
+ * @param srcs the source BGR rows
+ * @param nbSources the number of source rows
+ * @param dst the destination BGR row
+ * @param width the number of pixels in rows
+ */
+void CvColorKernels::normMaxRowAVX2(const uchar * const srcs[],
+									const int nbSources,
+									uchar * dst,
+									const int width)
+{
+	normMaxRowScalar(srcs, nbSources, dst, 0, width);
+}
+#endif
@@ -0,0 +1,418 @@
+/*
+ * CvColorKernels.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVCOLORKERNELS_H_
+#define CVCOLORKERNELS_H_
+
+#include <vector>
+using namespace std;
+
+#include <opencv2/core/core.hpp>
+using namespace cv;
+
+#include "Palette.h"
+
+/**
+ * Fused color decomposition kernels.
+ * Each kernel reads the interleaved BGR source image only once and directly
+ * produces the requested image, instead of splitting the source into
+ * channels, applying look up tables on each of them and merging the
+ * results back.
+ */
+class CvColorKernels
+{
+	public:
+		/**
+		 * Components computed by #components and shown in #mosaic tiles
+		 * (in tiles order : rows of #MOSAIC_COLUMNS tiles)
+		 */
+		typedef enum
+		{
+			RED_COMPONENT = 0,		//!< R of RGB
+			GREEN_COMPONENT,		//!< G of RGB
+			BLUE_COMPONENT,			//!< B of RGB
+			HUE_COMPONENT,			//!< H of HSV (full range)
+			SATURATION_COMPONENT,	//!< S of HSV
+			VALUE_COMPONENT,		//!< V of HSV
+			Y_COMPONENT,			//!< Y of YCrCb
+			CR_COMPONENT,			//!< Cr of YCrCb
+			CB_COMPONENT,			//!< Cb of YCrCb
+			X_COMPONENT,			//!< X of XYZ
+			XYZ_Y_COMPONENT,		//!< Y of XYZ
+			Z_COMPONENT,			//!< Z of XYZ
+			NbComponents			//!< Number of components
+		} Component;
+
+		/**
+		 * Number of tiles in a #mosaic row
+		 */
+		static const int MOSAIC_COLUMNS = 3;
+
+		/**
+		 * Planar outputs of a color conversion kernel (#hsv or #ycrcb).
+		 * Only non NULL outputs are computed.
+		 */
+		typedef struct
+		{
+			/**
+			 * Gray planes of the converted image (or NULL)
+			 */
+			Mat * planes[3];
+
+			/**
+			 * Palettes to apply on planes (or NULL)
+			 */
+			const Palette * palettes[3];
+
+			/**
+			 * Colored planes (or NULL), only computed when corresponding
+			 * palette is not NULL
+			 */
+			Mat * colored[3];
+
+			/**
+			 * Index of the plane used to modulate first colored plane
+			 * (e.g. saturation or value modulating colored hue) or -1
+			 */
+			int mixPlane;
+
+			/**
+			 * First colored plane modulated by mixPlane (or NULL)
+			 */
+			Mat * mixed;
+		} PlanarOutputs;
+
+		/**
+		 * Computes the per pixel maximum of B, G and R components of a BGR
+		 * image into a single channel image
+		 * @param src the source BGR image (CV_8UC3)
+		 * @param dst the destination gray image (CV_8UC1)
+		 */
+		static void maxChannels(const Mat & src, Mat & dst);
+
+		/**
+		 * Computes the colored maximum of B, G and R components : each
+		 * component is colored with its own palette and the destination
+		 * pixel receives the colored component with the largest norm.
+		 * @param src the source BGR image (CV_8UC3)
+		 * @param palettes the palettes to apply on B, G and R components
+		 * @param dst the destination BGR image (CV_8UC3)
+		 */
+		static void normMax(const Mat & src,
+							const Palette * const palettes[3],
+							Mat & dst);
+
+		/**
+		 * Computes the maximum of N images by comparing pixels integer
+		 * squared norms rather than a per channel max like the OpenCV max
+		 * function : each destination pixel receives the source pixel
+		 * with the largest norm (the first one in sources order in case
+		 * of ties).
+		 * @param srcs the source images (all of the same size and type)
+		 * @param dst the destination image
+		 * @note norms are only compared on CV_8UC3 images, ordinary max is
+		 * performed on other types
+		 */
+		static void normMax(const vector<Mat> & srcs, Mat & dst);
+
+		/**
+		 * Norm maximum of N BGR rows (see #normMax). Uses AVX2 or SSSE3
+		 * instructions when available.
+		 * @param srcs the source BGR rows
+		 * @param nbSources the number of source rows
+		 * @param dst the destination BGR row
+		 * @param width the number of pixels in rows
+		 */
+		static void normMaxRow(const uchar * const srcs[],
+							   const int nbSources,
+							   uchar * dst,
+							   const int width);
+
+		/**
+		 * Applies a packed BGR colormap on one channel of a row of pixels
+		 * and writes interleaved BGR colors. Uses AVX2 gathers when
+		 * available.
+		 * @param src the first source value of the row
+		 * @param stride the distance between two source values (i.e. the
+		 * number of channels of the source image)
+		 * @param table the packed BGR colormap : 256 BGR triplets followed
+		 * by (at least) one padding byte
+		 * @param dst the destination BGR row
+		 * @param width the number of pixels in the row
+		 */
+		static void paletteRow(const uchar * src,
+							   const int stride,
+							   const uchar * table,
+							   uchar * dst,
+							   const int width);
+
+		/**
+		 * Fixed point BGR to HSV (full range hue) conversion into planar
+		 * outputs in a single pass : max and min of components are
+		 * computed once per pixel, hue palette and hue modulation by
+		 * saturation or value are applied in the same pass.
+		 * @param src the source BGR image (CV_8UC3)
+		 * @param outputs the outputs to compute
+		 */
+		static void hsv(const Mat & src, const PlanarOutputs & outputs);
+
+		/**
+		 * Fixed point BGR to YCrCb conversion into planar outputs in a
+		 * single pass : luma is computed once per pixel and shared by
+		 * both chroma components, Cr and Cb palettes are applied in the
+		 * same pass.
+		 * @param src the source BGR image (CV_8UC3)
+		 * @param outputs the outputs to compute
+		 */
+		static void ycrcb(const Mat & src, const PlanarOutputs & outputs);
+
+		/**
+		 * Allocates planar outputs (does nothing on outputs already
+		 * allocated with the right size and type, so outputs can be
+		 * allocated once before running kernels on bands of rows)
+		 * @param src the source image
+		 * @param outputs the outputs to allocate
+		 */
+		static void createOutputs(const Mat & src,
+								  const PlanarOutputs & outputs);
+
+		/**
+		 * Computes all components of a BGR color
+		 * @param b the blue value
+		 * @param g the green value
+		 * @param r the red value
+		 * @param values the components values in #Component order
+		 */
+		static void components(const int b, const int g, const int r,
+							   uchar values[NbComponents]);
+
+		/**
+		 * Builds a mosaic of all components of a BGR image in a single pass
+		 * over the source : source is box averaged by factor x factor
+		 * blocks, all components of the averaged colors are computed and
+		 * written in their own tile of the destination (#MOSAIC_COLUMNS
+		 * tiles per row), so the cost depends on the destination size.
+		 * @param src the source BGR image (CV_8UC3)
+		 * @param factor the downscale factor of tiles
+		 * @param palettes the palettes to apply on each component, or NULL
+		 * to show a component as gray level
+		 * @param dst the destination BGR mosaic (CV_8UC3) of
+		 * #MOSAIC_COLUMNS x (NbComponents / #MOSAIC_COLUMNS) tiles
+		 * @param tileRows the range of rows of tiles to compute (all rows
+		 * by default) so bands of tiles can be computed concurrently on a
+		 * destination allocated beforehand (see #mosaicSize)
+		 */
+		static void mosaic(const Mat & src,
+						   const int factor,
+						   const Palette * const palettes[NbComponents],
+						   Mat & dst,
+						   const Range & tileRows = Range::all());
+
+		/**
+		 * Size of the mosaic built by #mosaic
+		 * @param srcSize the source image size
+		 * @param factor the downscale factor of tiles
+		 * @return the size of the mosaic image (or an empty size if
+		 * factor is too large)
+		 */
+		static Size mosaicSize(const Size & srcSize, const int factor);
+
+		/**
+		 * Float precision for XYZ conversion
+		 * @see #xyzComponent
+		 */
+		static const int XYZ_FLOAT = 0;
+
+		/**
+		 * Minimum number of fractional bits for fixed point XYZ conversion
+		 * (results within 1 LSB of double precision conversion)
+		 */
+		static const int XYZ_MIN_BITS = 8;
+
+		/**
+		 * Maximum number of fractional bits for fixed point XYZ conversion
+		 * (sums of products still fit into 32 bits integers)
+		 */
+		static const int XYZ_MAX_BITS = 22;
+
+		/**
+		 * Computes a single X, Y or Z component of a BGR image directly
+		 * into a 8 bits image in a single pass (no intermediate
+		 * XYZ image, no split, no scale conversion)
+		 * @param src the source BGR image (CV_8UC3)
+		 * @param component the component to compute : 0 for X, 1 for Y
+		 * and 2 for Z
+		 * @param precision number of fractional bits used for fixed point
+		 * computation within [XYZ_MIN_BITS..XYZ_MAX_BITS] or
+		 * XYZ_FLOAT for single precision floating point computation
+		 * @param dst the destination image (CV_8UC1)
+		 */
+		static void xyzComponent(const Mat & src,
+								 const int component,
+								 const int precision,
+								 Mat & dst);
+
+	protected:
+		/**
+		 * Fixed point shift of HSV division tables
+		 */
+		static const int HSV_SHIFT = 12;
+
+		/**
+		 * Fixed point shift of YCrCb coefficients
+		 */
+		static const int YCRCB_SHIFT = 14;
+
+		/**
+		 * Saturation division table : (255 << HSV_SHIFT) / v
+		 */
+		static int saturationDivisions[256];
+
+		/**
+		 * Full range hue division table : (256 << HSV_SHIFT) / (6 * delta)
+		 */
+		static int hueDivisions[256];
+
+		/**
+		 * Indicates HSV division tables have been filled
+		 */
+		static const bool hsvTablesReady;
+
+		/**
+		 * Fills HSV division tables
+		 * @return true
+		 */
+		static bool initHSVTables();
+
+		/**
+		 * Writes a value into the gray and colored rows of a plane
+		 * @param value the value to write
+		 * @param x the pixel index in the row
+		 * @param plane the gray plane row (or NULL)
+		 * @param table the packed palette (or NULL)
+		 * @param colored the colored plane row (or NULL)
+		 */
+		static inline void writePlane(const int value,
+									  const int x,
+									  uchar * plane,
+									  const uchar * table,
+									  uchar * colored);
+
+		/**
+		 * BGR to XYZ conversion coefficients (D65 white point) in BGR
+		 * order for each of the X, Y and Z components
+		 */
+		static const float xyzCoefficients[3][3];
+
+		/**
+		 * Indicates if SSSE3 instructions can be used on this processor
+		 */
+		static const bool useSSSE3;
+
+		/**
+		 * Indicates if AVX2 instructions can be used on this processor
+		 */
+		static const bool useAVX2;
+
+		/**
+		 * Scalar colormap application on a row
+		 * @param src the first source value of the row
+		 * @param stride the distance between two source values
+		 * @param table the packed BGR colormap
+		 * @param dst the destination BGR row
+		 * @param width the number of pixels in the row
+		 */
+		static void paletteRowScalar(const uchar * src,
+									 const int stride,
+									 const uchar * table,
+									 uchar * dst,
+									 const int width);
+
+		/**
+		 * AVX2 colormap application on a row : source values and colors
+		 * of 8 pixels are gathered as 32 bits words then colors are packed
+		 * back to 24 bits with byte shuffles, remaining pixels are
+		 * processed by #paletteRowScalar
+		 * @param src the first source value of the row
+		 * @param stride the distance between two source values
+		 * @param table the packed BGR colormap
+		 * @param dst the destination BGR row
+		 * @param width the number of pixels in the row
+		 */
+		static void paletteRowAVX2(const uchar * src,
+								   const int stride,
+								   const uchar * table,
+								   uchar * dst,
+								   const int width);
+
+		/**
+		 * Scalar maximum of B, G and R components on a row
+		 * @param src the source BGR row
+		 * @param dst the destination gray row
+		 * @param width the number of pixels in the row
+		 */
+		static void maxChannelsRow(const uchar * src, uchar * dst,
+								   const int width);
+
+		/**
+		 * SSSE3 maximum of B, G and R components on a row : 16 pixels are
+		 * deinterleaved with byte shuffles per iteration, remaining pixels
+		 * are processed by #maxChannelsRow
+		 * @param src the source BGR row
+		 * @param dst the destination gray row
+		 * @param width the number of pixels in the row
+		 */
+		static void maxChannelsRowSSSE3(const uchar * src, uchar * dst,
+										const int width);
+
+		/**
+		 * Scalar norm maximum of N BGR rows from a given pixel
+		 * @param srcs the source BGR rows
+		 * @param nbSources the number of source rows
+		 * @param dst the destination BGR row
+		 * @param first the first pixel to process
+		 * @param width the number of pixels in rows
+		 */
+		static void normMaxRowScalar(const uchar * const srcs[],
+									 const int nbSources,
+									 uchar * dst,
+									 const int first,
+									 const int width);
+
+		/**
+		 * SSSE3 norm maximum of N BGR rows : 16 pixels of each source are
+		 * deinterleaved per iteration, their squared norms are computed
+		 * with 16 bits multiply-adds and compared as 32 bits integers,
+		 * then comparison masks are expanded back to interleaved bytes to
+		 * select pixels. Remaining pixels are processed by
+		 * #normMaxRowScalar
+		 * @param srcs the source BGR rows
+		 * @param nbSources the number of source rows
+		 * @param dst the destination BGR row
+		 * @param width the number of pixels in rows
+		 */
+		static void normMaxRowSSSE3(const uchar * const srcs[],
+									const int nbSources,
+									uchar * dst,
+									const int width);
+
+		/**
+		 * AVX2 norm maximum of N BGR rows : same as #normMaxRowSSSE3 but
+		 * squared norms of 16 pixels are computed and compared in 256 bits
+		 * registers
+		 * @param srcs the source BGR rows
+		 * @param nbSources the number of source rows
+		 * @param dst the destination BGR row
+		 * @param width the number of pixels in rows
+		 */
+		static void normMaxRowAVX2(const uchar * const srcs[],
+								   const int nbSources,
+								   uchar * dst,
+								   const int width);
+};
+
+#endif /* CVCOLORKERNELS_H_ */
@@ -10,44 +10,74 @@ using namespace std;
 
 #include <opencv2/imgproc/imgproc.hpp> // for cvtColor
 
-#include "mapRed.h"
-#include "mapGreen.h"
-#include "mapBlue.h"
-#include "mapHSV.h"
-#include "mapCb.h"
-#include "mapCr.h"
-
+#include "CvColorKernels.h"
 #include "CvColorSpaces.h"
 
+/*
+ * Default idle time in ms before releasing unused stages
+ */
+const int CvColorSpaces::defaultIdleTime = 5000;
+
+/*
+ * Default number of fractional bits for XYZ computation
+ */
+const int CvColorSpaces::defaultXYZPrecision = 16;
+
+/*
+ * Downscale factor of mosaic tiles
+ */
+const int CvColorSpaces::mosaicFactor = 4;
+
+/*
+ * Names of display modes (used as keys in latencies JSON dumps)
+ */
+const char * const CvColorSpaces::displayNames[NbSelected] =
+{
+	"input",
+	"gray",
+	"red",
+	"green",
+	"blue",
+	"max_bgr",
+	"xyz_x",
+	"xyz_y",
+	"xyz_z",
+	"hue",
+	"saturation",
+	"value",
+	"y",
+	"cr",
+	"cb",
+	"mosaic"
+};
+
 /*
  * Color spaces constructor
  * @param sourceImage input image
+ * @param nbThreads number of threads (i.e. bands of rows) used to
+ * compute images, 0 uses all hardware threads
+ * @throw CvProcessorException if built-in palettes can not be
+ * created
  */
-CvColorSpaces::CvColorSpaces(Mat * sourceImage) :
+CvColorSpaces::CvColorSpaces(Mat * sourceImage, const size_t nbThreads)
+	throw (CvProcessorException) :
 	CvProcessor(sourceImage),
-	inFrameGray(sourceImage->size(), CV_8UC1),
-	maxBGChannels(sourceImage->size(), CV_8UC1),
-	maxBGRChannels(sourceImage->size(), CV_8UC1),
-	maxBGChannelsColor(sourceImage->size(), CV_8UC3),
-	maxBGRChannelsColor(sourceImage->size(), CV_8UC3),
-	inFrameXYZ(sourceImage->size(), CV_64FC3),
-	inFrameHSV(sourceImage->size(), CV_8UC3),
-	hueColorImage(sourceImage->size(), CV_8UC3),
-	hueMixImage(sourceImage->size(), CV_8UC3),
-	hueMixedColorImage(sourceImage->size(), CV_8UC3),
+	bgrChannels(3),
+	xyzPrecision(defaultXYZPrecision),
+	hsvChannels(3),
 	hueDisplay(HUECOLOR),
-	inFrameYCrCb(sourceImage->size(), CV_8UC3),
-	crColoredImage(sourceImage->size(), CV_8UC3),
-	cbColoredImage(sourceImage->size(), CV_8UC3),
-	redMap(mapRed),
-	greenMap(mapGreen),
-	blueMap(mapBlue),
-	hMap(mapHSV),
-	cbMap(mapCb),
-	crMap(mapCr),
+	yCrCbChannels(3),
+	redMap(Palette::get("red")),
+	greenMap(Palette::get("green")),
+	blueMap(Palette::get("blue")),
+	hMap(Palette::get("hsv")),
+	cbMap(Palette::get("cb")),
+	crMap(Palette::get("cr")),
 	imageDisplayIndex(INPUT),
 	displayImageChanged(false),
-	nbFrames(0)
+	activeStages(0),
+	idleTime(defaultIdleTime),
+	bandExecutor(nbThreads)
 {
 	setup(sourceImage, false);
 
@@ -68,6 +98,8 @@ CvColorSpaces::~CvColorSpaces()
  * @param fullSetup full setup is needed when source image is changed
  * @pre sourceimage is not NULL
  * @note this method should be reimplemented in sub classes
+ * @note stages images are not allocated here but when they are first
+ * required by update
  */
 void CvColorSpaces::setup(Mat * sourceImage, bool fullSetup)
 {
@@ -80,27 +112,13 @@ void CvColorSpaces::setup(Mat * sourceImage, bool fullSetup)
 	// Full setup starting point
 	if (fullSetup) // only when sourceImage changes
 	{
-		inFrameGray.create(sourceImage->size(), CV_8UC1);
-		maxBGChannels.create(sourceImage->size(), CV_8UC1);
-		maxBGRChannels.create(sourceImage->size(), CV_8UC1);
-		maxBGChannelsColor.create(sourceImage->size(), CV_8UC3);
-		maxBGRChannelsColor.create(sourceImage->size(), CV_8UC3);
-		inFrameXYZ.create(sourceImage->size(), CV_64FC3),
-		inFrameHSV.create(sourceImage->size(), CV_8UC3);
-		hueColorImage.create(sourceImage->size(), CV_8UC3);
-		hueMixImage.create(sourceImage->size(), CV_8UC3);
-		hueMixedColorImage.create(sourceImage->size(), CV_8UC3);
-		inFrameYCrCb.create(sourceImage->size(), CV_8UC3);
-		crColoredImage.create(sourceImage->size(), CV_8UC3);
-		cbColoredImage.create(sourceImage->size(), CV_8UC3);
-		processTime = 0;
-		nbFrames = 0;
+		resetProcessTime();
 	}
 	else // only at construction
 	{
-		bgrMap[0] = &blueMap;
-		bgrMap[1] = &greenMap;
-		bgrMap[2] = &redMap;
+		bgrMap[0] = blueMap;
+		bgrMap[1] = greenMap;
+		bgrMap[2] = redMap;
 
 		for (size_t i = 0; i < (size_t) NbShows; i++)
 		{
@@ -109,15 +127,9 @@ void CvColorSpaces::setup(Mat * sourceImage, bool fullSetup)
 	}
 
 	// Partial setup starting point (in both cases)
-	for (int i=0; i < 3; i++)
+	for (int i = 0; i < (int) NbStages; i++)
 	{
-		bgrChannels.push_back(Mat(sourceImage->size(), CV_8UC1));
-		bgrColoredChannels[i].create(sourceImage->size(), CV_8UC3);
-		xyzGrayChannels[i].create(sourceImage->size(), CV_64FC1);
-		xyzDisplayChannels[i].create(sourceImage->size(), CV_8UC1);
-		hsvChannels.push_back(Mat(sourceImage->size(), CV_8UC1));
-		hueMixChannels[i].create(sourceImage->size(), CV_8UC1);
-		yCrCbChannels.push_back(Mat(sourceImage->size(), CV_8UC1));
+		stageLastUse[i] = 0;
 	}
 }
 
@@ -129,245 +141,333 @@ void CvColorSpaces::cleanup()
 {
 //	clog << "CvColorSpaces::cleanup()" << endl;
 
-	cbColoredImage.release();
-	crColoredImage.release();
-	for (size_t i = 0; i < yCrCbChannels.size(); i++)
+	for (int i = 0; i < (int) NbStages; i++)
 	{
-		yCrCbChannels[i].release();
+		releaseStage((Stage) i);
 	}
-	yCrCbChannels.clear();
-	inFrameYCrCb.release();
 
-	hueMixedColorImage.release();
-	hueMixImage.release();
-	for (size_t i = 0; i < 3; i++)
-	{
-		hueMixChannels[i].release();
-	}
-	hueColorImage.release();
-	for (size_t i = 0; i < hsvChannels.size(); i++)
+	displayImage.release();
+
+	CvProcessor::cleanup();
+}
+
+/*
+ * Gets the stages required by the current display mode
+ * @return the mask of required stages
+ */
+unsigned int CvColorSpaces::dependencies() const
+{
+	return dependencies(getDisplaySettings());
+}
+
+/*
+ * Gets the stages required by a display mode
+ * @param settings the display settings
+ * @return the mask of required stages
+ */
+unsigned int CvColorSpaces::dependencies(const DisplaySettings & settings)
+{
+	switch (settings.index)
 	{
-		hsvChannels[i].release();
+		case INPUT:
+			return 0;
+		case GRAY:
+			return stageMask(GRAY_STAGE);
+		case RED:
+			return stageMask(settings.showColor[RINDEX] ? BGR_COLOR_STAGE : BGR_STAGE);
+		case GREEN:
+			return stageMask(settings.showColor[GINDEX] ? BGR_COLOR_STAGE : BGR_STAGE);
+		case BLUE:
+			return stageMask(settings.showColor[BINDEX] ? BGR_COLOR_STAGE : BGR_STAGE);
+		case MAX_BGR:
+			return stageMask(settings.showColor[MAXINDEX] ? MAX_COLOR_STAGE : MAX_STAGE);
+		case XYZ_X:
+		case XYZ_Y:
+		case XYZ_Z:
+			return stageMask(XYZ_STAGE);
+		case HUE:
+			switch (settings.hue)
+			{
+				case HUECOLOR:
+					return stageMask(HSV_STAGE) | stageMask(HUE_COLOR_STAGE);
+				case HUESATURATE:
+				case HUEVALUE:
+					return stageMask(HSV_STAGE) | stageMask(HUE_COLOR_STAGE) |
+						stageMask(HUE_MIX_STAGE);
+				case HUEGRAY:
+				case NBHUES:
+				default:
+					return stageMask(HSV_STAGE);
+			}
+		case SATURATION:
+		case VALUE:
+			return stageMask(HSV_STAGE);
+		case Y:
+			return stageMask(YCRCB_STAGE);
+		case Cr:
+			return stageMask(YCRCB_STAGE) |
+				(settings.showColor[CrINDEX] ? stageMask(CR_COLOR_STAGE) : 0);
+		case Cb:
+			return stageMask(YCRCB_STAGE) |
+				(settings.showColor[CbINDEX] ? stageMask(CB_COLOR_STAGE) : 0);
+		case MOSAIC:
+			return stageMask(MOSAIC_STAGE);
+		case NbSelected:
+		default:
+			return 0;
 	}
-	hsvChannels.clear();
-	inFrameHSV.release();
+}
 
-	for (size_t i = 0; i < bgrChannels.size(); i++)
+/*
+ * Snapshot of current display settings
+ * @return a copy of the current display settings
+ */
+CvColorSpaces::DisplaySettings CvColorSpaces::getDisplaySettings() const
+{
+	DisplaySettings settings;
+	settings.index = imageDisplayIndex;
+	settings.hue = hueDisplay;
+	for (size_t i = 0; i < (size_t) NbShows; i++)
 	{
-		bgrChannels[i].release();
-		bgrColoredChannels[i].release();
-		xyzGrayChannels[i].release();
-		xyzDisplayChannels[i].release();
+		settings.showColor[i] = showColorChannel[i];
 	}
-	bgrChannels.clear();
-
-	inFrameXYZ.release();
 
-	maxBGRChannelsColor.release();
-
-	maxBGChannelsColor.release();
-
-	maxBGRChannels.release();
-
-	maxBGChannels.release();
-
-	inFrameGray.release();
-
-	displayImage.release();
-
-	CvProcessor::cleanup();
+	return settings;
 }
 
-
 /*
  * Update compute selected image for display according to
  * selected parameters such as imageDisplayIndex, showColorChannel,
- * and eventually hueDisplay
- * @return true if display image has changed, false otherwise
+ * and eventually hueDisplay. Only the stages required by the selected
+ * display are computed (see dependencies), their images are allocated
+ * on first use and released after idleTime when no longer required.
+ * Kernels run on bands of rows of the source image (see bandExecutor) :
+ * images are allocated before running kernels and each band writes
+ * into its own rows of these images.
+ * @note process time is measured with tick count rather than clock()
+ * since clock() sums up time spent by all threads. It is recorded in the
+ * latencies of the current display mode.
  */
 void CvColorSpaces::update()
 {
-	clock_t start, end;
-	start = clock();
+	const int64 now = getTickCount();
+	// display settings may be changed by GUI during update
+	const DisplaySettings settings = getDisplaySettings();
+	const unsigned int required = dependencies(settings);
+	const Mat & source = *sourceImage;
+	const int rows = source.rows;
+	for (int i = 0; i < (int) NbStages; i++)
+	{
+		if (required & stageMask((Stage) i))
+		{
+			stageLastUse[i] = now;
+		}
+	}
+	activeStages |= required;
+
 	// ------------------------------------------------------------------------
 	// Compute needed images
 	// ------------------------------------------------------------------------
-	switch (imageDisplayIndex)
-	{
-		case INPUT:
-			// Ain't got nothin to do here : input image doesn't need to be processed
-			break;
-
-		// --------------------------------------------------------------------
-		// Gray level conversion
-		// --------------------------------------------------------------------
-		case GRAY:
-			// Converts to gray
-			// sourceImage -> inFramegray
-			// TODO à compléter ...
 
-            cvtColor(*sourceImage,inFrameGray,CV_BGR2GRAY);
-
-			break;
-
-		// --------------------------------------------------------------------
-		// RGB Decomposition
-		// --------------------------------------------------------------------
-		case RED:
-		case GREEN:
-		case BLUE:
-		case MAX_BGR:
-			// Split BGR channels : sourceImage -> bgrChannels
-			// TODO à compléter ...
+	// --------------------------------------------------------------------
+	// Gray level conversion : sourceImage -> inFrameGray
+	// --------------------------------------------------------------------
+	if (required & stageMask(GRAY_STAGE))
+	{
+		inFrameGray.create(source.size(), CV_8UC1);
+		bandExecutor.run(rows, [&](const Range & band)
+		{
+			Mat grayBand = inFrameGray.rowRange(band);
+			cvtColor(source.rowRange(band), grayBand, CV_BGR2GRAY);
+		});
+	}
 
-            split(*sourceImage,bgrChannels);
+	// --------------------------------------------------------------------
+	// RGB Decomposition : only the selected component is computed,
+	// directly from the interleaved source image
+	// --------------------------------------------------------------------
+	if (required & (stageMask(BGR_STAGE) | stageMask(BGR_COLOR_STAGE)))
+	{
+		const int channel = (settings.index == RED ? RINDEX :
+							 (settings.index == GREEN ? GINDEX : BINDEX));
 
-			// Build colored image from channels : red channel leads to a
+		if (required & stageMask(BGR_COLOR_STAGE))
+		{
+			// Build colored image from channel : red channel leads to a
 			// red colored image, and so on ...
-			// by applying bgrMap[x] on bgrChannels[x] to produce
-			// bgrColoredChannels[x]
-			// bgrChannels[i] -> bgrColoredChannels[i]
-			for (size_t i = 0; i < bgrChannels.size(); i++)
+			// sourceImage[channel] -> bgrColoredChannels[channel]
+			const Palette * palette = bgrMap[channel];
+			Mat & colored = bgrColoredChannels[channel];
+			colored.create(source.size(), CV_8UC3);
+			bandExecutor.run(rows, [&](const Range & band)
 			{
-				// TODO à compléter ...
-
-                bgrMap[i]->applyPalette(bgrChannels[i],bgrColoredChannels[i]);
-
-			}
-
-			if (!showColorChannel[MAXINDEX])
+				Mat coloredBand = colored.rowRange(band);
+				palette->applyPalette(source.rowRange(band), channel,
+									  coloredBand);
+			});
+		}
+		else
+		{
+			// sourceImage[channel] -> bgrChannels[channel]
+			Mat & gray = bgrChannels[channel];
+			gray.create(source.size(), CV_8UC1);
+			bandExecutor.run(rows, [&](const Range & band)
 			{
-				// Compute maximum of BGR channels
-				// bgrChannels[0 & 1] -> maxBGChannels
-				// bgrChannels[2] & maxBGChannels -> maxBGRChannels
-				// TODO à compléter ...
+				Mat grayBand = gray.rowRange(band);
+				extractChannel(source.rowRange(band), grayBand, channel);
+			});
+		}
 
-                max(bgrChannels[0], bgrChannels[1], maxBGChannels);
-                max(bgrChannels[2], maxBGChannels, maxBGRChannels);
-			}
-			else
-			{
-				// Compute colored maximum of BGR channels
-				// bgrColoredChannels[0 & 1] -> maxBGChannelsColor
-				// bgrColoredChannels[2] & maxBGChannelsColor -> maxBGRChannelsColor
-				// TODO à compléter ...
-                normMax(bgrColoredChannels[0], bgrColoredChannels[1], maxBGChannelsColor);
-                normMax(bgrColoredChannels[2], maxBGRChannelsColor, maxBGRChannelsColor);
+		/*
+		 * TODO What are the characteristics of blue component vs
+		 * green or red ? Answer below:
+		 * Red
+		 */
+	}
 
+	if (required & stageMask(MAX_STAGE))
+	{
+		// Compute maximum of BGR channels in a single pass
+		// sourceImage -> maxBGRChannels
+		maxBGRChannels.create(source.size(), CV_8UC1);
+		bandExecutor.run(rows, [&](const Range & band)
+		{
+			Mat maxBand = maxBGRChannels.rowRange(band);
+			CvColorKernels::maxChannels(source.rowRange(band), maxBand);
+		});
+	}
 
-			}
+	if (required & stageMask(MAX_COLOR_STAGE))
+	{
+		// Compute colored maximum of BGR channels in a single pass
+		// sourceImage, bgrMap -> maxBGRChannelsColor
+		maxBGRChannelsColor.create(source.size(), CV_8UC3);
+		bandExecutor.run(rows, [&](const Range & band)
+		{
+			Mat maxBand = maxBGRChannelsColor.rowRange(band);
+			CvColorKernels::normMax(source.rowRange(band), bgrMap, maxBand);
+		});
+	}
 
-			/*
-			 * TODO What are the characteristics of blue component vs
-			 * green or red ? Answer below:
-             * Red
-             */
+	// --------------------------------------------------------------------
+	// XYZ conversion
+	// --------------------------------------------------------------------
+	if (required & stageMask(XYZ_STAGE))
+	{
+		const int channel = settings.index - XYZ_X;
+
+		// Converts selected XYZ component directly to display channel
+		// in a single pass : sourceImage -> xyzDisplayChannels[...]
+		// precision may be changed by UI : all bands use the same one
+		const int precision = xyzPrecision;
+		Mat & xyz = xyzDisplayChannels[channel];
+		xyz.create(source.size(), CV_8UC1);
+		bandExecutor.run(rows, [&](const Range & band)
+		{
+			Mat xyzBand = xyz.rowRange(band);
+			CvColorKernels::xyzComponent(source.rowRange(band), channel,
+										 precision, xyzBand);
+		});
 
-			break;
+		/*
+		 * TODO What component X, Y or Z looks more like luminance to you ?
+		 * Answer below:
+		 * Y
+		 */
+	}
 
-		// --------------------------------------------------------------------
-		// XYZ conversion
-		// --------------------------------------------------------------------
-		case XYZ_X:
-		case XYZ_Y:
-		case XYZ_Z:
-			// Converts to XYZ : sourceImage -> inFrameXYZ
-			// TODO à compléter ...
-            cvtColor(*sourceImage,inFrameXYZ,CV_BGR2XYZ);
+	// --------------------------------------------------------------------
+	// HSV conversion : fixed point conversion producing directly the
+	// required planes, colored hue and hue mixed with saturation or value
+	// in a single pass (no interleaved HSV image, no split)
+	// --------------------------------------------------------------------
+	if (required & stageMask(HSV_STAGE))
+	{
+		CvColorKernels::PlanarOutputs outputs = {{NULL, NULL, NULL},
+												 {NULL, NULL, NULL},
+												 {NULL, NULL, NULL},
+												 -1,
+												 NULL};
+		switch (settings.index)
+		{
+			case HUE:
+				if (settings.hue == HUEGRAY)
+				{
+					// sourceImage -> hsvChannels[0]
+					outputs.planes[0] = &hsvChannels[0];
+				}
+				break;
+			case SATURATION:
+				// sourceImage -> hsvChannels[1]
+				outputs.planes[1] = &hsvChannels[1];
+				break;
+			case VALUE:
+				// sourceImage -> hsvChannels[2]
+				outputs.planes[2] = &hsvChannels[2];
+				break;
+			default:
+				break;
+		}
 
-			// Splits inFrameXYZ to channels xyzGrayChannels
-			// TODO à compléter ...
-            split(inFrameXYZ,xyzGrayChannels);
+		if (required & stageMask(HUE_COLOR_STAGE))
+		{
+			// Build colored Hue image : hMap, hue -> hueColorImage
+			outputs.palettes[0] = hMap;
+			outputs.colored[0] = &hueColorImage;
+		}
 
-			// Converts floating point channels to display channels
-			// xyzGrayChannels[...] -> xyzDisplayChannels[...]
-			for( size_t i=0; i < 3; i++)
-			{
-				// TODO à compléter ...
-                convertScaleAbs(xyzGrayChannels[i],xyzDisplayChannels[i]);
-			}
+		if (required & stageMask(HUE_MIX_STAGE))
+		{
+			// Build colored Hue image \times Saturation or Value
+			// hueColorImage x (saturation or value) / 255 -> hueMixedColorImage
+			outputs.mixPlane = (int) settings.hue;
+			outputs.mixed = &hueMixedColorImage;
+		}
 
-			/*
-			 * TODO What component X, Y or Z looks more like luminance to you ?
-			 * Answer below:
-             * Y
-			 */
+		runPlanarKernel(CvColorKernels::hsv, outputs);
 
+		// evt show min/max of H component : should be [0...255]
+		// showMinMaxLoc(hsvChannels[0]);
+	}
 
-			break;
-		// --------------------------------------------------------------------
-		// HSV conversion
-		// --------------------------------------------------------------------
-		case HUE:
-		case SATURATION:
-		case VALUE:
-			// Converts to HSV : sourceImage -> inFrameHSV
-			// TODO à compléter ...
-
-            cvtColor(*sourceImage,inFrameHSV,CV_BGR2HSV);
-			// Split HSV channels : inFrameHSV -> hsvChannels
-			// TODO à compléter ...
-            split(inFrameHSV,hsvChannels);
-
-			// evt show min/max of H component : should be [0...179]°
-			// showMinMaxLoc(hsvChannels[0]);
-
-			// Normalize hue from 0 to 255 because hsv colormap (hMap)
-			// applied below expects value within 0 to 255 range
-			// hsvChannels[0] -> hsvChannels[0]
-			// TODO à compléter ...
-            hsvChannels[0] *= 255/179;
-            hsvChannels[1] *= 255/179;
-            hsvChannels[2] *= 255/179;
-
-			// Build colored Hue image : hsvChannels[0] -> hueColorImage
-			// TODO à compléter ...
-            hMap.applyPalette(hsvChannels[0],hueColorImage);
-
-			// Build Mixed Hue Color and (Saturation or Value) image
-			if ((hueDisplay > HUECOLOR) && (hueDisplay < HUEGRAY))
-			{
-				// Creates a 3 channel image from saturation or value channel
-				// depending on huDisplay value
-				// hsvChannels -> hueMixChannels
-                // TODO à compléter ...
-                hueMixChannels[0] = hsvChannels[hueDisplay];
-                hueMixChannels[1] = hsvChannels[hueDisplay];
-                hueMixChannels[2] = hsvChannels[hueDisplay];
-
-				// merge mix channels into color image
-				// hueMixChannels --> hueMixImage
-				// TODO à compléter ...
-                cv::merge(hueMixChannels, 3, hueMixImage);
-
-				// Build colored Hue image \times Saturation or Value
-				// hueColorImage x hueMixImage -> hueMixedColorImage
-				// TODO à compléter ...
-                hueMixedColorImage = hueColorImage.mul(hueMixImage);
-			}
-			break;
+	// --------------------------------------------------------------------
+	// YCbCr conversion : fixed point conversion producing directly the
+	// required planes and colored chroma in a single pass
+	// --------------------------------------------------------------------
+	if (required & stageMask(YCRCB_STAGE))
+	{
+		CvColorKernels::PlanarOutputs outputs = {{NULL, NULL, NULL},
+												 {NULL, NULL, NULL},
+												 {NULL, NULL, NULL},
+												 -1,
+												 NULL};
+
+		// Selected gray component : sourceImage -> yCrCbChannels
+		const int channel = settings.index - Y;
+		if ((channel == 0) ||
+			(channel == 1 && !(required & stageMask(CR_COLOR_STAGE))) ||
+			(channel == 2 && !(required & stageMask(CB_COLOR_STAGE))))
+		{
+			outputs.planes[channel] = &yCrCbChannels[channel];
+		}
 
-		// --------------------------------------------------------------------
-		// YCbCr conversion
-		// --------------------------------------------------------------------
-		case Y:
-		case Cr:
-		case Cb:
-			// Converts to YCrCb : sourceImage -> inFrameYCrCb
-			// TODO à compléter ...
+		// Apply palette on cr & cb components
+		if (required & stageMask(CR_COLOR_STAGE))
+		{
+			// crmap, cr -> crColoredImage
+			outputs.palettes[1] = crMap;
+			outputs.colored[1] = &crColoredImage;
+		}
 
-			// Split YCrCb channels : inFrameYCrCb -> yCrCbChannels
-			// TODO à compléter ...
+		if (required & stageMask(CB_COLOR_STAGE))
+		{
+			// cbmap, cb -> cbColoredImage
+			outputs.palettes[2] = cbMap;
+			outputs.colored[2] = &cbColoredImage;
+		}
+
+		runPlanarKernel(CvColorKernels::ycrcb, outputs);
 
-			// Apply palette on cr & cb components
-			// crmap, yCrCbChannels[1] -> crColoredImage
-			// TODO à compléter ...
-			// cbmap, yCrCbChannels[2] -> cbColoredImage
-			// TODO à compléter ...
-			break;
-		default:
-			cerr << "unknown image display index" << imageDisplayIndex << endl;
-			break;
 		/*
 		 * TODO How does the Y component compares to the gray component ?
 		 * Answer below :
@@ -380,13 +480,48 @@ void CvColorSpaces::update()
 		 */
 	}
 
+	// --------------------------------------------------------------------
+	// Mosaic of all components in a single pass
+	// --------------------------------------------------------------------
+	if (required & stageMask(MOSAIC_STAGE))
+	{
+		// colored or gray components according to showColorChannel
+		const Palette * palettes[CvColorKernels::NbComponents] = {NULL};
+		palettes[CvColorKernels::RED_COMPONENT] =
+			settings.showColor[RINDEX] ? redMap : NULL;
+		palettes[CvColorKernels::GREEN_COMPONENT] =
+			settings.showColor[GINDEX] ? greenMap : NULL;
+		palettes[CvColorKernels::BLUE_COMPONENT] =
+			settings.showColor[BINDEX] ? blueMap : NULL;
+		palettes[CvColorKernels::HUE_COMPONENT] =
+			(settings.showColor[HINDEX] && settings.hue != HUEGRAY) ? hMap : NULL;
+		palettes[CvColorKernels::CR_COMPONENT] =
+			settings.showColor[CrINDEX] ? crMap : NULL;
+		palettes[CvColorKernels::CB_COMPONENT] =
+			settings.showColor[CbINDEX] ? cbMap : NULL;
+
+		// sourceImage -> mosaicImage : bands of rows of tiles
+		const Size mosaicSize =
+			CvColorKernels::mosaicSize(source.size(), mosaicFactor);
+		if (mosaicSize.area() > 0)
+		{
+			mosaicImage.create(mosaicSize, CV_8UC3);
+			bandExecutor.run(source.rows / mosaicFactor,
+							 [&](const Range & tileRows)
+			{
+				CvColorKernels::mosaic(source, mosaicFactor, palettes,
+									   mosaicImage, tileRows);
+			});
+		}
+	}
+
 	// ------------------------------------------------------------------------
 	// select image to display ...
 	// ------------------------------------------------------------------------
 
 	uchar * previousImageData = displayImage.data;
 
-	switch (imageDisplayIndex)
+	switch (settings.index)
 	{
 		case INPUT:
 			displayImage = *sourceImage;
@@ -395,7 +530,7 @@ void CvColorSpaces::update()
 			displayImage = inFrameGray;
 			break;
 		case RED:
-			if (showColorChannel[RINDEX])
+			if (settings.showColor[RINDEX])
 			{
 				displayImage = bgrColoredChannels[RINDEX];
 			}
@@ -405,7 +540,7 @@ void CvColorSpaces::update()
 			}
 			break;
 		case GREEN:
-			if (showColorChannel[GINDEX])
+			if (settings.showColor[GINDEX])
 			{
 				displayImage = bgrColoredChannels[GINDEX];
 			}
@@ -415,7 +550,7 @@ void CvColorSpaces::update()
 			}
 			break;
 		case BLUE:
-			if (showColorChannel[BINDEX])
+			if (settings.showColor[BINDEX])
 			{
 				displayImage = bgrColoredChannels[BINDEX];
 			}
@@ -425,7 +560,7 @@ void CvColorSpaces::update()
 			}
 			break;
 		case MAX_BGR:
-			if (showColorChannel[MAXINDEX])
+			if (settings.showColor[MAXINDEX])
 			{
 				displayImage = maxBGRChannelsColor;
 			}
@@ -444,7 +579,7 @@ void CvColorSpaces::update()
 			displayImage = xyzDisplayChannels[2];
 			break;
 		case HUE:
-			switch (hueDisplay)
+			switch (settings.hue)
 			{
 				case HUECOLOR:
 					displayImage = hueColorImage;
@@ -458,7 +593,7 @@ void CvColorSpaces::update()
 					break;
 				case NBHUES:
 				default:
-					cerr << "unknown Hue display mode "<< hueDisplay
+					cerr << "unknown Hue display mode "<< settings.hue
 						 << endl;
 					break;
 			}
@@ -473,7 +608,7 @@ void CvColorSpaces::update()
 			displayImage = yCrCbChannels[0];
 			break;
 		case Cr:
-			if (showColorChannel[CrINDEX])
+			if (settings.showColor[CrINDEX])
 			{
 				displayImage = crColoredImage;
 			}
@@ -483,7 +618,7 @@ void CvColorSpaces::update()
 			}
 			break;
 		case Cb:
-			if (showColorChannel[CbINDEX])
+			if (settings.showColor[CbINDEX])
 			{
 				displayImage = cbColoredImage;
 			}
@@ -492,8 +627,11 @@ void CvColorSpaces::update()
 				displayImage = yCrCbChannels[2];
 			}
 			break;
+		case MOSAIC:
+			displayImage = mosaicImage;
+			break;
 		default:
-			cerr << "unknown display image index " << imageDisplayIndex << endl;
+			cerr << "unknown display image index " << settings.index << endl;
 			displayImage = *sourceImage;
 			break;
 	}
@@ -506,9 +644,58 @@ void CvColorSpaces::update()
 	{
 		displayImageChanged = false;
 	}
-	end = clock();
-	processTime += (end - start);
-	nbFrames++;
+
+	releaseIdleStages(required, now);
+
+	// last update time in microseconds, also recorded in the current
+	// display mode latencies
+	processTime = (clock_t) (((double) (getTickCount() - now) * 1e6) /
+							 getTickFrequency());
+	latencies[settings.index].record((int64) processTime);
+}
+
+/*
+ * Runs a planar conversion kernel on bands of rows of the source
+ * image
+ * @param kernel the kernel to run (CvColorKernels::hsv or
+ * CvColorKernels::ycrcb)
+ * @param outputs the kernel outputs on the whole image
+ */
+void CvColorSpaces::runPlanarKernel(void (*kernel)(const Mat &,
+										const CvColorKernels::PlanarOutputs &),
+									const CvColorKernels::PlanarOutputs & outputs)
+{
+	const Mat & source = *sourceImage;
+	CvColorKernels::createOutputs(source, outputs);
+
+	bandExecutor.run(source.rows, [&](const Range & band)
+	{
+		// Same outputs restricted to the rows of this band
+		Mat planes[3];
+		Mat colored[3];
+		Mat mixed;
+		CvColorKernels::PlanarOutputs bandOutputs = outputs;
+		for (int c = 0; c < 3; c++)
+		{
+			if (outputs.planes[c] != NULL)
+			{
+				planes[c] = outputs.planes[c]->rowRange(band);
+				bandOutputs.planes[c] = &planes[c];
+			}
+			if (outputs.colored[c] != NULL)
+			{
+				colored[c] = outputs.colored[c]->rowRange(band);
+				bandOutputs.colored[c] = &colored[c];
+			}
+		}
+		if (outputs.mixed != NULL)
+		{
+			mixed = outputs.mixed->rowRange(band);
+			bandOutputs.mixed = &mixed;
+		}
+
+		kernel(source.rowRange(band), bandOutputs);
+	});
 }
 
 /*
@@ -542,6 +729,7 @@ CvColorSpaces::Display CvColorSpaces::getDisplayImageIndex()
  * 	- Y selects YCrCb Y component image for display
  * 	- Cr selects YCrCb Cr component image for display
  * 	- Cb selects YCrCb Cb component image for display
+ * 	- MOSAIC selects mosaic of all components for display
  * @param select the index to select display image
  */
 void CvColorSpaces::setDisplayImageIndex(const Display index)
@@ -549,8 +737,6 @@ void CvColorSpaces::setDisplayImageIndex(const Display index)
 	if (index < NbSelected)
 	{
 		imageDisplayIndex = index;
-		processTime = 0;
-		nbFrames = 0;
 	}
 	else
 	{
@@ -594,8 +780,6 @@ void CvColorSpaces::setColorChannel(const ShowColor c, const bool value)
 	if ( c < NbShows)
 	{
 		showColorChannel[c] = value;
-		processTime = 0;
-		nbFrames = 0;
 	}
 	else
 	{
@@ -626,8 +810,6 @@ void CvColorSpaces::setHueDisplayMode(const HueDisplay mode)
 	if (mode < NBHUES)
 	{
 		hueDisplay = mode;
-		processTime = 0;
-		nbFrames = 0;
 	}
 	else
 	{
@@ -637,86 +819,261 @@ void CvColorSpaces::setHueDisplayMode(const HueDisplay mode)
 }
 
 /*
- * Return processor MEAN processing time of step index [default
- * implementation returning only processTime, should be reimplemented
- * in subclasses]
- * @param index not used here
- * @return the MEAN processing time between two frames.
+ * Return processor MEAN processing time of step index
+ * @param index 0 for the whole update, i > 0 for the time spent by
+ * the (i-1)th band of rows (see getNbThreads)
+ * @return the MEAN processing time between two frames (in
+ * microseconds like CvProcessor::processTime). Update time is the
+ * mean of the current display mode latencies (see getLatencies).
  */
-double CvColorSpaces::getProcessTime(const size_t) const
+double CvColorSpaces::getProcessTime(const size_t index) const
 {
-	return (double) processTime / (double) MAX(1, nbFrames);
+	if (index > 0)
+	{
+		return bandExecutor.getBandTime(index - 1) * 1000.0;
+	}
+
+	return latencies[imageDisplayIndex].getMean();
 }
 
+/*
+ * Get the latencies of a display mode
+ * @param mode the display mode
+ * @return the latencies histogram of updates in this display mode
+ */
+const CvLatencyHistogram & CvColorSpaces::getLatencies(const Display mode) const
+{
+	return latencies[mode < NbSelected ? mode : INPUT];
+}
 
 /*
- * Show Min and Max values and locations for a matrix
- * @param m the matrix to consider
+ * Writes latencies of all display modes as a JSON object :
+ * {"unit": "us", "threads": ..., "modes": {"input": {...}, ...}}
+ * where each mode is written by CvLatencyHistogram::toJSON
+ * @param out the output stream to write to
  */
-void CvColorSpaces::showMinMaxLoc(const Mat & m)
+void CvColorSpaces::latenciesToJSON(ostream & out) const
 {
-	// search for min & max value locations
-	double minVal, maxVal;
-	Point minLoc;
-	Point maxLoc;
-	minMaxLoc(m,&minVal, &maxVal, &minLoc, &maxLoc);
-	clog << "sat values : min = " << minVal << " at (" << minLoc.x
-		 << ", " << minLoc.y << ") max = " << maxVal << " at ("
-		 << maxLoc.x << ", " << maxLoc.y << ")" << endl;
+	out << "{\"unit\": \"us\", \"threads\": " << getNbThreads()
+		<< ", \"modes\": {";
+	for (int i = 0; i < (int) NbSelected; i++)
+	{
+		out << (i > 0 ? ", " : "") << "\"" << displayNames[i] << "\": ";
+		latencies[i].toJSON(out);
+	}
+	out << "}}" << endl;
 }
 
 /*
- * Compute Maximum of color images by computing a channel wide norm
- * to find which is the greatest rather than mixing channels
- * @param src1 the first color (or gray) image
- * @param src2 the second color (or gray) image
- * @param dst the color (or gray) destination
+ * Reset processing times and latencies of all display modes
  */
-void CvColorSpaces::normMax(const Mat& src1, const Mat& src2, Mat& dst)
+void CvColorSpaces::resetProcessTime()
 {
-	// first check if src1, src2 && dst have the same sizes and type
-	if ( (src1.rows == src2.rows) &&
-		 (src1.rows == dst.rows) &&
-		 (src1.cols == src2.cols) &&
-		 (src1.cols == dst.cols) &&
-		 (src1.type() == src2.type()) &&
-		 (src1.type() == dst.type()) )
-	{
-		if (src1.type() == CV_8UC3)
-		{
-			// Compute max by pixel norm rather than mixing pixels
-			Mat_<Vec3b>::const_iterator src1It = src1.begin<Vec3b>();
-			Mat_<Vec3b>::const_iterator src1ItEnd = src1.end<Vec3b>();
-			Mat_<Vec3b>::const_iterator src2It = src2.begin<Vec3b>();
-			Mat_<Vec3b>::const_iterator src2ItEnd = src2.end<Vec3b>();
-			Mat_<Vec3b>::iterator dstIt = dst.begin<Vec3b>();
-			Mat_<Vec3b>::iterator dstItEnd = dst.end<Vec3b>();
-			for (; src1It != src1ItEnd &&
-				   src2It != src2ItEnd &&
-				   dstIt != dstItEnd ;
-				   ++src1It, ++src2It, ++dstIt)
-			{
-                Vec3b p1 = *src1It;
-                Vec3b p2 = *src2It;
-                if(p1.ddot(p1)>p2.ddot(p2)){
-                    *dstIt = p1;
-                }
-                else {
-                    *dstIt = p2;
-                }
-			}
-		}
-		else
-		{
-			// compute max the regular way with max function
-			max(src1, src2, dst);
-		}
+	processTime = 0;
+	for (int i = 0; i < (int) NbSelected; i++)
+	{
+		latencies[i].reset();
+	}
+	bandExecutor.resetTimes();
+}
+
+/*
+ * Get the number of threads used to compute images
+ * @return the number of threads (i.e. bands of rows)
+ */
+size_t CvColorSpaces::getNbThreads() const
+{
+	return bandExecutor.getNbThreads();
+}
+
+/*
+ * Sets the number of threads used to compute images
+ * @param nbThreads the new number of threads (i.e. bands of rows),
+ * 0 uses all hardware threads
+ */
+void CvColorSpaces::setNbThreads(const size_t nbThreads)
+{
+	bandExecutor.setNbThreads(nbThreads);
+	resetProcessTime();
+}
+
+
+/*
+ * Get the precision used to compute XYZ channels
+ * @return the number of fractional bits used in fixed point
+ * computation or CvColorKernels::XYZ_FLOAT when XYZ channels are
+ * computed with floating point values
+ */
+int CvColorSpaces::getXYZPrecision() const
+{
+	return xyzPrecision;
+}
+
+/*
+ * Sets the precision used to compute XYZ channels
+ * @param precision the number of fractional bits used in fixed
+ * point computation (clamped to [CvColorKernels::XYZ_MIN_BITS ..
+ * CvColorKernels::XYZ_MAX_BITS]) or CvColorKernels::XYZ_FLOAT to
+ * use floating point computation
+ */
+void CvColorSpaces::setXYZPrecision(const int precision)
+{
+	if (precision == CvColorKernels::XYZ_FLOAT)
+	{
+		xyzPrecision = precision;
 	}
 	else
 	{
-		// Do nothing
-		cerr << "CvColorSpaces::normMax : incompatible images" << endl;
+		xyzPrecision = MIN(MAX(precision, (int) CvColorKernels::XYZ_MIN_BITS),
+						   (int) CvColorKernels::XYZ_MAX_BITS);
 	}
 }
 
+/*
+ * Get the time after which images of unused stages are released
+ * @return the idle time in ms (negative when unused stages are
+ * never released)
+ */
+int CvColorSpaces::getIdleTime() const
+{
+	return idleTime;
+}
+
+/*
+ * Sets the time after which images of unused stages are released
+ * @param ms the new idle time in ms : 0 releases unused stages
+ * as soon as display mode changes, negative values never release
+ * them
+ */
+void CvColorSpaces::setIdleTime(const int ms)
+{
+	idleTime = ms;
+}
+
+/*
+ * Mask of a single stage
+ * @param stage the stage
+ * @return the bit mask corresponding to this stage
+ */
+unsigned int CvColorSpaces::stageMask(const Stage stage)
+{
+	return 1u << (unsigned int) stage;
+}
+
+/*
+ * Release images used by a stage
+ * @param stage the stage to release
+ */
+void CvColorSpaces::releaseStage(const Stage stage)
+{
+	switch (stage)
+	{
+		case GRAY_STAGE:
+			inFrameGray.release();
+			break;
+		case BGR_STAGE:
+			for (size_t i = 0; i < bgrChannels.size(); i++)
+			{
+				bgrChannels[i].release();
+			}
+			break;
+		case BGR_COLOR_STAGE:
+			for (size_t i = 0; i < 3; i++)
+			{
+				bgrColoredChannels[i].release();
+			}
+			break;
+		case MAX_STAGE:
+			maxBGRChannels.release();
+			break;
+		case MAX_COLOR_STAGE:
+			maxBGRChannelsColor.release();
+			break;
+		case XYZ_STAGE:
+			for (size_t i = 0; i < 3; i++)
+			{
+				xyzDisplayChannels[i].release();
+			}
+			break;
+		case HSV_STAGE:
+			for (size_t i = 0; i < hsvChannels.size(); i++)
+			{
+				hsvChannels[i].release();
+			}
+			break;
+		case HUE_COLOR_STAGE:
+			hueColorImage.release();
+			break;
+		case HUE_MIX_STAGE:
+			hueMixedColorImage.release();
+			break;
+		case YCRCB_STAGE:
+			for (size_t i = 0; i < yCrCbChannels.size(); i++)
+			{
+				yCrCbChannels[i].release();
+			}
+			break;
+		case CR_COLOR_STAGE:
+			crColoredImage.release();
+			break;
+		case CB_COLOR_STAGE:
+			cbColoredImage.release();
+			break;
+		case MOSAIC_STAGE:
+			mosaicImage.release();
+			break;
+		case NbStages:
+		default:
+			break;
+	}
+
+	activeStages &= ~stageMask(stage);
+}
+
+/*
+ * Release images of stages which have not been required for more
+ * than idleTime
+ * @param required the stages required by the current update
+ * @param now the current tick count
+ */
+void CvColorSpaces::releaseIdleStages(const unsigned int required,
+									  const int64 now)
+{
+	if (idleTime < 0)
+	{
+		return;
+	}
+
+	const unsigned int unused = activeStages & ~required;
+	if (unused == 0)
+	{
+		return;
+	}
+
+	const double idleTicks = (double) idleTime * getTickFrequency() / 1000.0;
+
+	for (int i = 0; i < (int) NbStages; i++)
+	{
+		if ((unused & stageMask((Stage) i)) &&
+			((double) (now - stageLastUse[i]) >= idleTicks))
+		{
+			releaseStage((Stage) i);
+		}
+	}
+}
 
+/*
+ * Show Min and Max values and locations for a matrix
+ * @param m the matrix to consider
+ */
+void CvColorSpaces::showMinMaxLoc(const Mat & m)
+{
+	// search for min & max value locations
+	double minVal, maxVal;
+	Point minLoc;
+	Point maxLoc;
+	minMaxLoc(m,&minVal, &maxVal, &minLoc, &maxLoc);
+	clog << "sat values : min = " << minVal << " at (" << minLoc.x
+		 << ", " << minLoc.y << ") max = " << maxVal << " at ("
+		 << maxLoc.x << ", " << maxLoc.y << ")" << endl;
+}
@@ -12,6 +12,9 @@
 using namespace std;
 
 #include "CvProcessor.h"
+#include "CvBandExecutor.h"
+#include "CvColorKernels.h"
+#include "CvLatencyHistogram.h"
 #include "Palette.h"
 
 /**
@@ -56,6 +59,7 @@ class CvColorSpaces : public virtual CvProcessor
 			Y,			//!< Lightness component from YCrCb is selected for display
 			Cr,			//!< Green/Magenta Cr component from YCrCb is selected for display
 			Cb,			//!< Yellow/Blue Cb component from YCrCb is selected for display
+			MOSAIC,		//!< Mosaic of all components is selected for display
 			NbSelected
 		} Display;
 
@@ -71,6 +75,44 @@ class CvColorSpaces : public virtual CvProcessor
 			NBHUES			//!< Number of Hue display modes
 		} HueDisplay;
 
+		/**
+		 * Intermediate images (stages) that may be required to build the
+		 * display image. Each display mode declares the stages it depends
+		 * on (see #dependencies) so that only these stages are computed and
+		 * allocated.
+		 */
+		typedef enum
+		{
+			GRAY_STAGE = 0,		//!< gray converted image
+			BGR_STAGE,			//!< selected BGR component
+			BGR_COLOR_STAGE,	//!< selected BGR component colored
+			MAX_STAGE,			//!< maximum of BGR components
+			MAX_COLOR_STAGE,	//!< colored maximum of BGR components
+			XYZ_STAGE,			//!< XYZ conversion and selected component
+			HSV_STAGE,			//!< HSV selected component
+			HUE_COLOR_STAGE,	//!< colored hue image
+			HUE_MIX_STAGE,		//!< colored hue mixed with saturation or value
+			YCRCB_STAGE,		//!< YCrCb selected component
+			CR_COLOR_STAGE,		//!< colored Cr image
+			CB_COLOR_STAGE,		//!< colored Cb image
+			MOSAIC_STAGE,		//!< mosaic of all components
+			NbStages			//!< Number of stages
+		} Stage;
+
+		/**
+		 * Display settings used during one update. The GUI may change
+		 * display settings while update runs in another thread, so update
+		 * takes a single snapshot of these settings (see
+		 * #getDisplaySettings) and uses it for stages and display image
+		 * selection.
+		 */
+		typedef struct
+		{
+			Display index;				//!< selected image to display
+			HueDisplay hue;				//!< hue display mode
+			bool showColor[NbShows];	//!< color display of channels
+		} DisplaySettings;
+
 	protected :
 
 		/**
@@ -94,44 +136,26 @@ class CvColorSpaces : public virtual CvProcessor
 		Mat bgrColoredChannels[3];
 
 		/**
-		 * Maximum of B & G channels
-		 */
-		Mat maxBGChannels;
-
-		/**
-		 * Maximum of maxBGChannels and R channel
+		 * Maximum of B, G and R channels
 		 */
 		Mat maxBGRChannels;
 
 		/**
-		 * Colored maximum of B & G channels
-		 */
-		Mat maxBGChannelsColor;
-
-		/**
-		 * Colored Maximum of maxBGChannels and R channel
+		 * Colored Maximum of B, G and R channels
 		 */
 		Mat maxBGRChannelsColor;
 
-		/**
-		 * XYZ floating point converted image
-		 */
-		Mat inFrameXYZ;
-
-		/**
-		 * XYZ floating point channels
-		 */
-		Mat xyzGrayChannels[3];
-
 		/**
 		 * XYZ channels normalized to 0..255
 		 */
 		Mat xyzDisplayChannels[3];
 
 		/**
-		 * HSV converted image
+		 * Precision used to compute XYZ channels : number of fractional
+		 * bits for fixed point computation or CvColorKernels::XYZ_FLOAT
+		 * for single precision floating point computation
 		 */
-		Mat inFrameHSV;
+		int xyzPrecision;
 
 		/**
 		 * HSV individual channels
@@ -144,17 +168,7 @@ class CvColorSpaces : public virtual CvProcessor
 		Mat hueColorImage;
 
 		/**
-		 * Hue Mix channels to build hue colored display image
-		 */
-		Mat hueMixChannels[3];
-
-		/**
-		 * Hue image built from hueMixChannels
-		 */
-		Mat hueMixImage;
-
-		/**
-		 * Hue colored mixed image normalized from hueMixImage
+		 * Hue colored image mixed with saturation or value
 		 */
 		Mat hueMixedColorImage;
 
@@ -163,11 +177,6 @@ class CvColorSpaces : public virtual CvProcessor
 		 */
 		HueDisplay hueDisplay;
 
-		/**
-		 * YCbCr converted image
-		 */
-		Mat inFrameYCrCb;
-
 		/**
 		 * YCbCr channels
 		 */
@@ -183,20 +192,26 @@ class CvColorSpaces : public virtual CvProcessor
 		 */
 		Mat cbColoredImage;
 
+		/**
+		 * Mosaic of all components (downscaled by #mosaicFactor)
+		 */
+		Mat mosaicImage;
+
 		/**
 		 * Palette to build colored red component image
+		 * @note palettes are shared by all processors (see Palette#get)
 		 */
-		Palette redMap;
+		const Palette * redMap;
 
 		/**
 		 * Palette to build colored green component image
 		 */
-		Palette greenMap;
+		const Palette * greenMap;
 
 		/**
 		 * Palette to build colored blue component image
 		 */
-		Palette blueMap;
+		const Palette * blueMap;
 
 		/**
 		 * Pointers to RGB palettes
@@ -205,22 +220,22 @@ class CvColorSpaces : public virtual CvProcessor
 		 *	- greenMap
 		 *	- redMap
 		 */
-		Palette * bgrMap[3];
+		const Palette * bgrMap[3];
 
 		/**
 		 * Palette for hue component
 		 */
-		Palette hMap;
+		const Palette * hMap;
 
 		/**
 		 * Palette for Cb component
 		 */
-		Palette cbMap;
+		const Palette * cbMap;
 
 		/**
 		 * Palette for Cr component
 		 */
-		Palette crMap;
+		const Palette * crMap;
 
 		/**
 		 * Booleans to choose to display channels as grayscale
@@ -239,17 +254,68 @@ class CvColorSpaces : public virtual CvProcessor
 		bool displayImageChanged;
 
 		/**
-		 * Number of frames used to compute mean processTime
-		 * @see CvProcessor::processTime
+		 * Latencies of updates (in microseconds) for each display mode,
+		 * kept over a rolling window of frames (not reset when display
+		 * mode changes)
+		 */
+		CvLatencyHistogram latencies[NbSelected];
+
+		/**
+		 * Mask of stages whose images are currently allocated
+		 * @see #stageMask
+		 */
+		unsigned int activeStages;
+
+		/**
+		 * Tick count (see cv::getTickCount) of the last update in which
+		 * each stage has been used
+		 */
+		int64 stageLastUse[NbStages];
+
+		/**
+		 * Time in ms after which images of unused stages are released.
+		 * Negative values keep stages allocated forever.
+		 */
+		int idleTime;
+
+		/**
+		 * Executor running conversions kernels on bands of rows of the
+		 * source image
+		 */
+		CvBandExecutor bandExecutor;
+
+		/**
+		 * Default idle time in ms before releasing unused stages
+		 */
+		static const int defaultIdleTime;
+
+		/**
+		 * Default number of fractional bits for XYZ computation
+		 */
+		static const int defaultXYZPrecision;
+
+		/**
+		 * Downscale factor of mosaic tiles
+		 */
+		static const int mosaicFactor;
+
+	public:
+		/**
+		 * Names of display modes (used as keys in latencies JSON dumps)
 		 */
-		size_t nbFrames;
+		static const char * const displayNames[NbSelected];
 
 	public :
 		/**
 		 * Color spaces constructor
 		 * @param inFrame input image
+		 * @param nbThreads number of threads (i.e. bands of rows) used to
+		 * compute images, 0 uses all hardware threads
+		 * @throw CvProcessorException if built-in palettes can not be
+		 * created
 		 */
-		CvColorSpaces(Mat * inFrame);
+		CvColorSpaces(Mat * inFrame, const size_t nbThreads = 1)
+			throw (CvProcessorException);
 
 		/**
 		 * Color spaces destructor
@@ -282,6 +348,7 @@ class CvColorSpaces : public virtual CvProcessor
 		 * 	- Y selects YCrCb Y component image for display
 		 * 	- Cr selects YCrCb Cr component image for display
 		 * 	- Cb selects YCrCb Cb component image for display
+		 * 	- MOSAIC selects mosaic of all components for display
 		 * @param index select the index to select display image
 		 */
 		virtual void setDisplayImageIndex(const Display index);
@@ -329,6 +396,72 @@ class CvColorSpaces : public virtual CvProcessor
 		 */
 		virtual void setHueDisplayMode(const HueDisplay mode);
 
+		/**
+		 * Get the precision used to compute XYZ channels
+		 * @return the number of fractional bits used in fixed point
+		 * computation or CvColorKernels::XYZ_FLOAT when XYZ channels are
+		 * computed with floating point values
+		 */
+		int getXYZPrecision() const;
+
+		/**
+		 * Sets the precision used to compute XYZ channels
+		 * @param precision the number of fractional bits used in fixed
+		 * point computation (clamped to [CvColorKernels::XYZ_MIN_BITS ..
+		 * CvColorKernels::XYZ_MAX_BITS]) or CvColorKernels::XYZ_FLOAT to
+		 * use floating point computation
+		 */
+		virtual void setXYZPrecision(const int precision);
+
+		/**
+		 * Get the time after which images of unused stages are released
+		 * @return the idle time in ms (negative when unused stages are
+		 * never released)
+		 */
+		int getIdleTime() const;
+
+		/**
+		 * Sets the time after which images of unused stages are released
+		 * @param ms the new idle time in ms : 0 releases unused stages
+		 * as soon as display mode changes, negative values never release
+		 * them
+		 */
+		virtual void setIdleTime(const int ms);
+
+		/**
+		 * Get the number of threads used to compute images
+		 * @return the number of threads (i.e. bands of rows)
+		 */
+		size_t getNbThreads() const;
+
+		/**
+		 * Sets the number of threads used to compute images
+		 * @param nbThreads the new number of threads (i.e. bands of rows),
+		 * 0 uses all hardware threads
+		 */
+		virtual void setNbThreads(const size_t nbThreads);
+
+		/**
+		 * Gets the stages required by the current display mode
+		 * @return the mask of required stages
+		 * @see #stageMask
+		 */
+		unsigned int dependencies() const;
+
+		/**
+		 * Gets the stages required by a display mode
+		 * @param settings the display settings
+		 * @return the mask of required stages
+		 * @see #stageMask
+		 */
+		static unsigned int dependencies(const DisplaySettings & settings);
+
+		/**
+		 * Snapshot of current display settings
+		 * @return a copy of the current display settings
+		 */
+		DisplaySettings getDisplaySettings() const;
+
 		/**
 		 * Gets the image selected for display
 		 * @return the display image
@@ -336,14 +469,30 @@ class CvColorSpaces : public virtual CvProcessor
 		Mat & getDisplayImage();
 
 		/**
-		 * Return processor MEAN processing time of step index [default
-		 * implementation returning only processTime, should be reimplemented
-		 * in subclasses]
-		 * @param index not used here
-		 * @return the MEAN processing time between two frames.
+		 * Return processor MEAN processing time of step index
+		 * @param index 0 for the whole update, i > 0 for the time spent by
+		 * the (i-1)th band of rows (see #getNbThreads)
+		 * @return the MEAN processing time between two frames (in
+		 * microseconds like CvProcessor#processTime). Update time is the
+		 * mean of the current display mode latencies (see #getLatencies).
 		 */
 		double getProcessTime(const size_t index = 0) const;
 
+		/**
+		 * Get the latencies of a display mode
+		 * @param mode the display mode
+		 * @return the latencies histogram of updates in this display mode
+		 */
+		const CvLatencyHistogram & getLatencies(const Display mode) const;
+
+		/**
+		 * Writes latencies of all display modes as a JSON object :
+		 * {"unit": "us", "threads": ..., "modes": {"input": {...}, ...}}
+		 * where each mode is written by CvLatencyHistogram#toJSON
+		 * @param out the output stream to write to
+		 */
+		void latenciesToJSON(ostream & out) const;
+
 
 	protected:
 		// --------------------------------------------------------------------
@@ -366,21 +515,47 @@ class CvColorSpaces : public virtual CvProcessor
 		virtual void cleanup();
 
 		/**
-		 * Show Min and Max values and locations for a matrix
-		 * @param m the matrix to consider
+		 * Mask of a single stage
+		 * @param stage the stage
+		 * @return the bit mask corresponding to this stage
 		 */
-		static void showMinMaxLoc(const Mat & m);
+		static unsigned int stageMask(const Stage stage);
+
+		/**
+		 * Release images used by a stage
+		 * @param stage the stage to release
+		 */
+		void releaseStage(const Stage stage);
+
+		/**
+		 * Release images of stages which have not been required for more
+		 * than #idleTime
+		 * @param required the stages required by the current update
+		 * @param now the current tick count
+		 */
+		void releaseIdleStages(const unsigned int required, const int64 now);
+
+		/**
+		 * Runs a planar conversion kernel on bands of rows of the source
+		 * image
+		 * @param kernel the kernel to run (CvColorKernels#hsv or
+		 * CvColorKernels#ycrcb)
+		 * @param outputs the kernel outputs on the whole image
+		 */
+		void runPlanarKernel(void (*kernel)(const Mat &,
+									const CvColorKernels::PlanarOutputs &),
+							 const CvColorKernels::PlanarOutputs & outputs);
 
 		/**
-		 * Compute Maximum of color images by comparing pixel norm
-		 * rather than a per channel max like the openCV max function
-		 * @param src1 the first color (or gray) image
-		 * @param src2 the second color (or gray) image
-		 * @param dst the color (or gray) destination
-		 * @pre the norm max is only computed if arguments are of type CV_8UC3,
-		 * otherwise ordinary max is performed
+		 * Reset processing times and latencies of all display modes
 		 */
-		static void normMax(const Mat& src1, const Mat& src2, Mat& dst);
+		void resetProcessTime();
+
+		/**
+		 * Show Min and Max values and locations for a matrix
+		 * @param m the matrix to consider
+		 */
+		static void showMinMaxLoc(const Mat & m);
 };
 
 #endif /* CVCOLORSPACES_H_ */
@@ -0,0 +1,323 @@
+/*
+ * CvImageSequenceCapture.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include <cstdio>	// for sscanf
+#include <iostream>	// for cerr
+using namespace std;
+
+#ifndef _WIN32
+#include <glob.h>
+#endif
+
+#include <opencv2/highgui/highgui.hpp>	// for imread
+
+#include "CvImageSequenceCapture.h"
+
+/*
+ * Default number of frames decoded ahead
+ */
+const size_t CvImageSequenceCapture::defaultAhead = 8;
+
+/*
+ * Default number of decoding threads
+ */
+const size_t CvImageSequenceCapture::defaultDecoders = 2;
+
+/*
+ * Images sequence capture constructor
+ * @param pattern glob pattern of image files
+ * @param frameRate target frame rate or 0 for unthrottled capture
+ * @param ahead number of frames decoded ahead
+ * @param nbDecoders number of decoding threads
+ */
+CvImageSequenceCapture::CvImageSequenceCapture(const string & pattern,
+											   const double frameRate,
+											   const size_t ahead,
+											   const size_t nbDecoders) :
+	CvFrameSource(Size(0, 0), frameRate, CV_8UC3),
+	pattern(pattern),
+	files(),
+	ring(ahead > 0 ? ahead : 1),
+	decoders(),
+	nbDecoders(nbDecoders > 0 ? nbDecoders : 1),
+	consumed(0),
+	nextDecode(0),
+	generation(0),
+	stopDecoders(false)
+{
+	// decoded frames are served without copy
+	zeroCopy = true;
+
+	// No dynamic links in constructors, so setup is called here
+	opened = setup();
+	sizeChanged = false;
+}
+
+/*
+ * Images sequence capture destructor.
+ * Stops decoding threads
+ */
+CvImageSequenceCapture::~CvImageSequenceCapture()
+{
+	stop();
+}
+
+/*
+ * Release this source: stops decoding threads
+ */
+void CvImageSequenceCapture::release()
+{
+	stop();
+	CvFrameSource::release();
+}
+
+/*
+ * Number of images in the sequence
+ * @return the number of images in the sequence
+ */
+long CvImageSequenceCapture::getFrameCount() const
+{
+	return (long) files.size();
+}
+
+/*
+ * Parse images sequence specification <pattern>[@<rate>]
+ * @param spec the specification to parse
+ * @param pattern the parsed glob pattern
+ * @param frameRate the parsed frame rate
+ * @return true if specification has been parsed successfully
+ */
+bool CvImageSequenceCapture::parse(const string & spec,
+								   string & pattern,
+								   double & frameRate)
+{
+	double rate = 0.0;
+	size_t atPos = spec.rfind('@');
+
+	if (atPos != string::npos)
+	{
+		if (sscanf(spec.c_str() + atPos + 1, "%lf", &rate) != 1 ||
+			rate < 0.0)
+		{
+			cerr << "CvImageSequenceCapture::parse: invalid rate in " << spec
+				 << endl;
+			return false;
+		}
+	}
+
+	pattern = spec.substr(0, atPos);
+	if (pattern.empty())
+	{
+		cerr << "CvImageSequenceCapture::parse: empty pattern" << endl;
+		return false;
+	}
+
+	frameRate = rate;
+
+	return true;
+}
+
+/*
+ * Finds image files, decodes first image to get frames size and
+ * type then launches decoding threads
+ * @return true if at least one image has been found and decoded
+ */
+bool CvImageSequenceCapture::setup()
+{
+	stop();
+	files.clear();
+
+#ifndef _WIN32
+	glob_t globResult;
+	int status = glob(pattern.c_str(), 0, NULL, &globResult);
+	if (status == 0)
+	{
+		// glob sorts paths by name
+		for (size_t i = 0; i < globResult.gl_pathc; i++)
+		{
+			files.push_back(string(globResult.gl_pathv[i]));
+		}
+	}
+	globfree(&globResult);
+#else
+	cerr << "CvImageSequenceCapture::setup: images sequences require glob"
+		 << endl;
+#endif
+
+	if (files.empty())
+	{
+		cerr << "CvImageSequenceCapture::setup: no image matches " << pattern
+			 << endl;
+		return false;
+	}
+
+	// First image gives frames size and type
+	Mat first = imread(files[0], CV_LOAD_IMAGE_COLOR);
+	if (first.empty())
+	{
+		cerr << "CvImageSequenceCapture::setup: can not read " << files[0]
+			 << endl;
+		return false;
+	}
+	frameSize = first.size();
+	frameType = first.type();
+
+	// No need for more slots than files
+	if (ring.size() > files.size())
+	{
+		ring.resize(files.size());
+	}
+
+	{
+		lock_guard<mutex> locker(ringLock);
+		for (vector<Slot>::iterator it = ring.begin(); it != ring.end();
+			 ++it)
+		{
+			it->sequence = -1;
+			it->image.release();
+			it->ready = false;
+		}
+
+		// first frame is already decoded
+		ring[0].sequence = 0;
+		ring[0].image = first;
+		ring[0].ready = true;
+		consumed = 0;
+		nextDecode = 1;
+		stopDecoders = false;
+	}
+
+	for (size_t i = 0; i < nbDecoders; i++)
+	{
+		decoders.push_back(thread(&CvImageSequenceCapture::decode, this));
+	}
+
+	return true;
+}
+
+/*
+ * Fetch decoded frame at index (waiting for it to be decoded if needed).
+ * @param index the index of the frame to fetch
+ * @return true if frame has been decoded successfully
+ */
+bool CvImageSequenceCapture::fetchFrame(const long index)
+{
+	const long count = (long) files.size();
+	const long nbSlots = (long) ring.size();
+
+	unique_lock<mutex> locker(ringLock);
+
+	if (consumed % count != index)
+	{
+		// Seek: restart decoding ahead from index
+		generation++;
+		consumed = index;
+		nextDecode = index;
+		for (vector<Slot>::iterator it = ring.begin(); it != ring.end();
+			 ++it)
+		{
+			it->sequence = -1;
+			it->ready = false;
+		}
+		ringCondition.notify_all();
+	}
+
+	Slot & slot = ring[consumed % nbSlots];
+	const long expected = consumed;
+	ringCondition.wait(locker, [&]
+	{
+		return stopDecoders || (slot.sequence == expected && slot.ready);
+	});
+
+	if (stopDecoders)
+	{
+		return false;
+	}
+
+	// header to decoded image: slot image will be replaced (not overwritten)
+	// by decoders, so frame data remains valid
+	frame = slot.image;
+	consumed++;
+
+	// room for decoding one more frame
+	ringCondition.notify_all();
+
+	return !frame.empty();
+}
+
+/*
+ * Decoding thread loop
+ */
+void CvImageSequenceCapture::decode()
+{
+	const long count = (long) files.size();
+	const long nbSlots = (long) ring.size();
+
+	unique_lock<mutex> locker(ringLock);
+
+	while (true)
+	{
+		ringCondition.wait(locker, [&]
+		{
+			return stopDecoders || (nextDecode < consumed + nbSlots);
+		});
+
+		if (stopDecoders)
+		{
+			break;
+		}
+
+		const long sequence = nextDecode++;
+		const unsigned long decodeGeneration = generation;
+		Slot & slot = ring[sequence % nbSlots];
+		slot.sequence = sequence;
+		slot.ready = false;
+
+		// decode without holding the lock
+		locker.unlock();
+		Mat decoded = imread(files[sequence % count], CV_LOAD_IMAGE_COLOR);
+		if (!decoded.empty() &&
+			(decoded.size() != frameSize || decoded.type() != frameType))
+		{
+			cerr << "CvImageSequenceCapture::decode: "
+				 << files[sequence % count] << " has a different size"
+				 << endl;
+			decoded.release();
+		}
+		locker.lock();
+
+		// discard frames decoded before seeking
+		if (decodeGeneration == generation && slot.sequence == sequence)
+		{
+			slot.image = decoded;
+			slot.ready = true;
+			ringCondition.notify_all();
+		}
+	}
+}
+
+/*
+ * Stops and joins decoding threads
+ */
+void CvImageSequenceCapture::stop()
+{
+	{
+		lock_guard<mutex> locker(ringLock);
+		stopDecoders = true;
+	}
+	ringCondition.notify_all();
+
+	for (vector<thread>::iterator it = decoders.begin(); it != decoders.end();
+		 ++it)
+	{
+		if (it->joinable())
+		{
+			it->join();
+		}
+	}
+	decoders.clear();
+}
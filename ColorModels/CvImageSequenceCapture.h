@@ -0,0 +1,194 @@
+/*
+ * CvImageSequenceCapture.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVIMAGESEQUENCECAPTURE_H_
+#define CVIMAGESEQUENCECAPTURE_H_
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+#include "CvFrameSource.h"
+
+/**
+ * Images sequence frame source reading numbered image files (PNG, PPM, ...)
+ * matching a glob pattern (e.g. "frames/img_*.png") sorted by name.
+ * Images are decoded ahead of time by a few decoding threads into a ring
+ * of decoded frames, so grabbing a frame does not wait for decoding unless
+ * decoders fall behind. Retrieved images are headers to decoded frames
+ * (no copy).
+ * @note requires POSIX glob, so images sequences are not available on
+ * Windows
+ */
+class CvImageSequenceCapture : public CvFrameSource
+{
+	protected:
+		/**
+		 * Decoded frame slot in the decode ahead ring
+		 */
+		typedef struct
+		{
+			/**
+			 * Sequence number of the frame in this slot or -1
+			 */
+			long sequence;
+
+			/**
+			 * Decoded image
+			 */
+			Mat image;
+
+			/**
+			 * Indicates image has been decoded
+			 */
+			bool ready;
+		} Slot;
+
+		/**
+		 * Glob pattern used to find image files
+		 */
+		string pattern;
+
+		/**
+		 * Sorted image files names
+		 */
+		vector<string> files;
+
+		/**
+		 * Decode ahead ring
+		 */
+		vector<Slot> ring;
+
+		/**
+		 * Decoding threads
+		 */
+		vector<thread> decoders;
+
+		/**
+		 * Number of decoding threads
+		 */
+		size_t nbDecoders;
+
+		/**
+		 * Sequence number of the next frame to be consumed by #fetchFrame.
+		 * Sequence numbers keep increasing when sequence loops, so that
+		 * file index is sequence % files.size()
+		 */
+		long consumed;
+
+		/**
+		 * Sequence number of the next frame to decode
+		 */
+		long nextDecode;
+
+		/**
+		 * Generation number incremented on each seek so decoders can
+		 * discard frames decoded before seeking
+		 */
+		unsigned long generation;
+
+		/**
+		 * Decoding threads should stop
+		 */
+		bool stopDecoders;
+
+		/**
+		 * Lock protecting ring and sequence numbers
+		 */
+		mutex ringLock;
+
+		/**
+		 * Condition used to wake decoders (room in ring) and consumer
+		 * (frame decoded)
+		 */
+		condition_variable ringCondition;
+
+		/**
+		 * Default number of frames decoded ahead
+		 */
+		static const size_t defaultAhead;
+
+		/**
+		 * Default number of decoding threads
+		 */
+		static const size_t defaultDecoders;
+
+	public:
+		/**
+		 * Images sequence capture constructor
+		 * @param pattern glob pattern of image files
+		 * @param frameRate target frame rate or 0 for unthrottled capture
+		 * @param ahead number of frames decoded ahead
+		 * @param nbDecoders number of decoding threads
+		 */
+		CvImageSequenceCapture(const string & pattern,
+							   const double frameRate = 0.0,
+							   const size_t ahead = defaultAhead,
+							   const size_t nbDecoders = defaultDecoders);
+
+		/**
+		 * Images sequence capture destructor.
+		 * Stops decoding threads
+		 */
+		virtual ~CvImageSequenceCapture();
+
+		/**
+		 * Release this source: stops decoding threads
+		 */
+		void release();
+
+		/**
+		 * Number of images in the sequence
+		 * @return the number of images in the sequence
+		 */
+		long getFrameCount() const;
+
+		/**
+		 * Parse images sequence specification <pattern>[@<rate>]
+		 * (e.g. "frames/*.png@25"). A missing or 0 rate means unthrottled
+		 * capture.
+		 * @param spec the specification to parse
+		 * @param pattern the parsed glob pattern
+		 * @param frameRate the parsed frame rate
+		 * @return true if specification has been parsed successfully
+		 */
+		static bool parse(const string & spec,
+						  string & pattern,
+						  double & frameRate);
+
+	protected:
+		/**
+		 * Finds image files, decodes first image to get frames size and
+		 * type then launches decoding threads
+		 * @return true if at least one image has been found and decoded
+		 */
+		bool setup();
+
+		/**
+		 * Fetch decoded frame at index (waiting for it to be decoded if
+		 * needed). If index is not the next expected frame, decode ahead
+		 * ring is reset to start at index.
+		 * @param index the index of the frame to fetch
+		 * @return true if frame has been decoded successfully
+		 */
+		bool fetchFrame(const long index);
+
+		/**
+		 * Decoding thread loop
+		 */
+		void decode();
+
+		/**
+		 * Stops and joins decoding threads
+		 */
+		void stop();
+};
+
+#endif /* CVIMAGESEQUENCECAPTURE_H_ */
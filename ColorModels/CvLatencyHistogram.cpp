@@ -0,0 +1,312 @@
+/*
+ * CvLatencyHistogram.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include "CvLatencyHistogram.h"
+
+/*
+ * Latency histogram constructor
+ * @param windowSize number of samples in the rolling window
+ */
+CvLatencyHistogram::CvLatencyHistogram(const size_t windowSize) :
+	counts(nbBuckets, 0),
+	samples(MAX(windowSize, (size_t) 1), 0),
+	next(0),
+	count(0),
+	sum(0),
+	total(0)
+{
+}
+
+/*
+ * Latency histogram destructor
+ */
+CvLatencyHistogram::~CvLatencyHistogram()
+{
+}
+
+/*
+ * Records a new sample (and removes the oldest one from the
+ * window if window is full)
+ * @param us the sample in microseconds
+ */
+void CvLatencyHistogram::record(const int64 us)
+{
+	const int64 value = MAX(us, (int64) 0);
+
+	lock_guard<mutex> locker(lock);
+
+	if (count == samples.size())
+	{
+		// oldest sample leaves the window
+		const int64 oldest = samples[next];
+		counts[bucketIndex(oldest)]--;
+		sum -= oldest;
+	}
+	else
+	{
+		count++;
+	}
+
+	samples[next] = value;
+	next = (next + 1) % samples.size();
+	counts[bucketIndex(value)]++;
+	sum += value;
+	total++;
+}
+
+/*
+ * Removes all samples
+ */
+void CvLatencyHistogram::reset()
+{
+	lock_guard<mutex> locker(lock);
+	counts.assign(nbBuckets, 0);
+	next = 0;
+	count = 0;
+	sum = 0;
+	total = 0;
+}
+
+/*
+ * Get the number of samples in the rolling window
+ * @return the window size
+ */
+size_t CvLatencyHistogram::getWindowSize() const
+{
+	lock_guard<mutex> locker(lock);
+	return samples.size();
+}
+
+/*
+ * Sets the number of samples in the rolling window (removes all
+ * samples)
+ * @param windowSize the new window size
+ */
+void CvLatencyHistogram::setWindowSize(const size_t windowSize)
+{
+	{
+		lock_guard<mutex> locker(lock);
+		samples.assign(MAX(windowSize, (size_t) 1), 0);
+	}
+	reset();
+}
+
+/*
+ * Get the number of samples currently in the window
+ * @return the number of samples in the window
+ */
+size_t CvLatencyHistogram::getCount() const
+{
+	lock_guard<mutex> locker(lock);
+	return count;
+}
+
+/*
+ * Get the number of samples recorded since creation or last
+ * reset
+ * @return the total number of recorded samples
+ */
+size_t CvLatencyHistogram::getTotal() const
+{
+	lock_guard<mutex> locker(lock);
+	return total;
+}
+
+/*
+ * Mean of the samples in the window
+ * @return the mean in microseconds (or 0 if there is no samples)
+ */
+double CvLatencyHistogram::getMean() const
+{
+	lock_guard<mutex> locker(lock);
+	return count > 0 ? (double) sum / (double) count : 0.0;
+}
+
+/*
+ * Value at a given percentile of the samples in the window
+ * @param percentile the percentile in [0..100]
+ * @return the middle value of the bucket containing this
+ * percentile in microseconds (or 0 if there is no samples)
+ */
+double CvLatencyHistogram::getPercentile(const double percentile) const
+{
+	lock_guard<mutex> locker(lock);
+	return percentileValue(percentile);
+}
+
+/*
+ * Lower bound of the smallest non empty bucket
+ * @return the minimum value in microseconds (or 0)
+ */
+int64 CvLatencyHistogram::getMin() const
+{
+	lock_guard<mutex> locker(lock);
+	for (int i = 0; i < nbBuckets; i++)
+	{
+		if (counts[i] > 0)
+		{
+			return bucketLow(i);
+		}
+	}
+	return 0;
+}
+
+/*
+ * Upper bound of the largest non empty bucket
+ * @return the maximum value in microseconds (or 0)
+ */
+int64 CvLatencyHistogram::getMax() const
+{
+	lock_guard<mutex> locker(lock);
+	for (int i = nbBuckets - 1; i >= 0; i--)
+	{
+		if (counts[i] > 0)
+		{
+			return bucketHigh(i);
+		}
+	}
+	return 0;
+}
+
+/*
+ * Writes statistics as a JSON object :
+ * {"window": ..., "count": ..., "total": ..., "mean": ...,
+ * "min": ..., "max": ..., "percentiles": {"50": ..., "90": ...,
+ * "99": ..., "99.9": ...}, "buckets": [[low, high, count], ...]}
+ * where only non empty buckets are written
+ * @param out the output stream to write to
+ */
+void CvLatencyHistogram::toJSON(ostream & out) const
+{
+	lock_guard<mutex> locker(lock);
+
+	int minIndex = -1;
+	int maxIndex = -1;
+	for (int i = 0; i < nbBuckets; i++)
+	{
+		if (counts[i] > 0)
+		{
+			minIndex = minIndex < 0 ? i : minIndex;
+			maxIndex = i;
+		}
+	}
+	const int64 minValue = minIndex < 0 ? 0 : bucketLow(minIndex);
+	const int64 maxValue = maxIndex < 0 ? 0 : bucketHigh(maxIndex);
+
+	out << "{\"window\": " << samples.size()
+		<< ", \"count\": " << count
+		<< ", \"total\": " << total
+		<< ", \"mean\": " << (count > 0 ? (double) sum / (double) count : 0.0)
+		<< ", \"min\": " << minValue
+		<< ", \"max\": " << maxValue
+		<< ", \"percentiles\": {"
+		<< "\"50\": " << percentileValue(50.0)
+		<< ", \"90\": " << percentileValue(90.0)
+		<< ", \"99\": " << percentileValue(99.0)
+		<< ", \"99.9\": " << percentileValue(99.9)
+		<< "}, \"buckets\": [";
+
+	bool first = true;
+	for (int i = 0; i < nbBuckets; i++)
+	{
+		if (counts[i] > 0)
+		{
+			out << (first ? "" : ", ") << "[" << bucketLow(i) << ", "
+				<< bucketHigh(i) << ", " << counts[i] << "]";
+			first = false;
+		}
+	}
+
+	out << "]}";
+}
+
+/*
+ * Bucket index of a value
+ * @param us the value in microseconds
+ * @return the index of the bucket containing this value
+ */
+int CvLatencyHistogram::bucketIndex(const int64 us)
+{
+	if (us < subBuckets)
+	{
+		return (int) MAX(us, (int64) 0);
+	}
+
+	// position of the most significant bit (>= 4 since us >= 16)
+	int exponent = 63 - __builtin_clzll((unsigned long long) us);
+	if (exponent > maxExponent)
+	{
+		return nbBuckets - 1;
+	}
+
+	const int sub = (int) ((us >> (exponent - 4)) & (subBuckets - 1));
+	return subBuckets + (exponent - 4) * subBuckets + sub;
+}
+
+/*
+ * Smallest value of a bucket
+ * @param index the bucket index
+ * @return the lower bound of this bucket
+ */
+int64 CvLatencyHistogram::bucketLow(const int index)
+{
+	if (index < subBuckets)
+	{
+		return index;
+	}
+
+	const int exponent = (index - subBuckets) / subBuckets + 4;
+	const int sub = (index - subBuckets) % subBuckets;
+	return ((int64) (subBuckets + sub)) << (exponent - 4);
+}
+
+/*
+ * Largest value of a bucket
+ * @param index the bucket index
+ * @return the upper bound of this bucket
+ */
+int64 CvLatencyHistogram::bucketHigh(const int index)
+{
+	if (index < subBuckets)
+	{
+		return index;
+	}
+
+	const int exponent = (index - subBuckets) / subBuckets + 4;
+	return bucketLow(index) + (((int64) 1) << (exponent - 4)) - 1;
+}
+
+/*
+ * Value at a given percentile (lock must be held)
+ * @param percentile the percentile in [0..100]
+ * @return the middle value of the bucket containing this
+ * percentile
+ */
+double CvLatencyHistogram::percentileValue(const double percentile) const
+{
+	if (count == 0)
+	{
+		return 0.0;
+	}
+
+	// rank of the sample at this percentile (1 based)
+	const double p = MIN(MAX(percentile, 0.0), 100.0);
+	size_t rank = (size_t) ((p / 100.0) * (double) count + 0.5);
+	rank = MIN(MAX(rank, (size_t) 1), count);
+
+	size_t seen = 0;
+	for (int i = 0; i < nbBuckets; i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			return ((double) bucketLow(i) + (double) bucketHigh(i)) / 2.0;
+		}
+	}
+
+	return (double) bucketHigh(nbBuckets - 1);
+}
@@ -0,0 +1,210 @@
+/*
+ * CvLatencyHistogram.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVLATENCYHISTOGRAM_H_
+#define CVLATENCYHISTOGRAM_H_
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <mutex>
+using namespace std;
+
+#include <opencv2/core/core.hpp>	// for int64
+using namespace cv;
+
+/**
+ * Streaming latency statistics over a rolling window of samples.
+ * Samples (in microseconds) are counted in HDR-style log-linear buckets :
+ * values below #subBuckets have their own bucket, then each power of two
+ * range is split into #subBuckets buckets, so percentiles are known within
+ * 1 / #subBuckets of their value whatever their magnitude.
+ * Only the last #windowSize samples are counted : older samples are
+ * removed from their bucket when new ones arrive.
+ * All methods are thread safe so statistics can be read while samples
+ * are recorded by another thread.
+ */
+class CvLatencyHistogram
+{
+	public:
+		/**
+		 * Number of buckets per power of two
+		 */
+		static const int subBuckets = 16;
+
+		/**
+		 * Largest power of two of recorded values : larger values are
+		 * counted in the last bucket
+		 */
+		static const int maxExponent = 36;
+
+		/**
+		 * Total number of buckets
+		 */
+		static const int nbBuckets =
+			subBuckets + (maxExponent - 4 + 1) * subBuckets;
+
+		/**
+		 * Default number of samples in the rolling window
+		 */
+		static const size_t defaultWindowSize = 1000;
+
+	protected:
+		/**
+		 * Number of samples of the window in each bucket
+		 */
+		vector<size_t> counts;
+
+		/**
+		 * Ring buffer of the samples in the window
+		 */
+		vector<int64> samples;
+
+		/**
+		 * Index of the next sample in #samples
+		 */
+		size_t next;
+
+		/**
+		 * Number of samples in the window
+		 */
+		size_t count;
+
+		/**
+		 * Sum of the samples in the window
+		 */
+		int64 sum;
+
+		/**
+		 * Number of samples recorded since creation or last #reset
+		 * (including samples which left the window)
+		 */
+		size_t total;
+
+		/**
+		 * Lock on statistics
+		 */
+		mutable mutex lock;
+
+	public:
+		/**
+		 * Latency histogram constructor
+		 * @param windowSize number of samples in the rolling window
+		 */
+		CvLatencyHistogram(const size_t windowSize = defaultWindowSize);
+
+		/**
+		 * Latency histogram destructor
+		 */
+		virtual ~CvLatencyHistogram();
+
+		/**
+		 * Records a new sample (and removes the oldest one from the
+		 * window if window is full)
+		 * @param us the sample in microseconds
+		 */
+		void record(const int64 us);
+
+		/**
+		 * Removes all samples
+		 */
+		void reset();
+
+		/**
+		 * Get the number of samples in the rolling window
+		 * @return the window size
+		 */
+		size_t getWindowSize() const;
+
+		/**
+		 * Sets the number of samples in the rolling window (removes all
+		 * samples)
+		 * @param windowSize the new window size
+		 */
+		void setWindowSize(const size_t windowSize);
+
+		/**
+		 * Get the number of samples currently in the window
+		 * @return the number of samples in the window
+		 */
+		size_t getCount() const;
+
+		/**
+		 * Get the number of samples recorded since creation or last
+		 * reset
+		 * @return the total number of recorded samples
+		 */
+		size_t getTotal() const;
+
+		/**
+		 * Mean of the samples in the window
+		 * @return the mean in microseconds (or 0 if there is no samples)
+		 */
+		double getMean() const;
+
+		/**
+		 * Value at a given percentile of the samples in the window
+		 * @param percentile the percentile in [0..100]
+		 * @return the middle value of the bucket containing this
+		 * percentile in microseconds (or 0 if there is no samples)
+		 */
+		double getPercentile(const double percentile) const;
+
+		/**
+		 * Lower bound of the smallest non empty bucket
+		 * @return the minimum value in microseconds (or 0)
+		 */
+		int64 getMin() const;
+
+		/**
+		 * Upper bound of the largest non empty bucket
+		 * @return the maximum value in microseconds (or 0)
+		 */
+		int64 getMax() const;
+
+		/**
+		 * Writes statistics as a JSON object :
+		 * {"window": ..., "count": ..., "total": ..., "mean": ...,
+		 * "min": ..., "max": ..., "percentiles": {"50": ..., "90": ...,
+		 * "99": ..., "99.9": ...}, "buckets": [[low, high, count], ...]}
+		 * where only non empty buckets are written
+		 * @param out the output stream to write to
+		 */
+		void toJSON(ostream & out) const;
+
+		/**
+		 * Bucket index of a value
+		 * @param us the value in microseconds
+		 * @return the index of the bucket containing this value
+		 */
+		static int bucketIndex(const int64 us);
+
+		/**
+		 * Smallest value of a bucket
+		 * @param index the bucket index
+		 * @return the lower bound of this bucket
+		 */
+		static int64 bucketLow(const int index);
+
+		/**
+		 * Largest value of a bucket
+		 * @param index the bucket index
+		 * @return the upper bound of this bucket
+		 */
+		static int64 bucketHigh(const int index);
+
+	protected:
+		/**
+		 * Value at a given percentile (lock must be held)
+		 * @param percentile the percentile in [0..100]
+		 * @return the middle value of the bucket containing this
+		 * percentile
+		 */
+		double percentileValue(const double percentile) const;
+};
+
+#endif /* CVLATENCYHISTOGRAM_H_ */
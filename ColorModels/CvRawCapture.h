@@ -0,0 +1,130 @@
+/*
+ * CvRawCapture.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVRAWCAPTURE_H_
+#define CVRAWCAPTURE_H_
+
+#include <string>
+using namespace std;
+
+#include "CvFrameSource.h"
+
+/**
+ * Raw video frame source reading fixed size frames stored contiguously in a
+ * file (e.g. raw BGR dumps) without any codec.
+ * The file is memory mapped (privately, so writing into frames never
+ * modifies the file) and retrieved images are headers pointing straight into
+ * the mapping: no copy and no decoding is performed.
+ * @note requires POSIX mmap, so raw capture is not available on Windows
+ */
+class CvRawCapture : public CvFrameSource
+{
+	protected:
+		/**
+		 * Path to raw frames file
+		 */
+		string path;
+
+		/**
+		 * File descriptor of the raw frames file or -1
+		 */
+		int fileDescriptor;
+
+		/**
+		 * Start of the memory mapping or NULL
+		 */
+		uchar * mapping;
+
+		/**
+		 * Length of the memory mapping in bytes
+		 */
+		size_t mappingLength;
+
+		/**
+		 * Offset of the first frame in the file (e.g. to skip a header)
+		 */
+		size_t offset;
+
+		/**
+		 * Number of bytes per frame
+		 */
+		size_t frameBytes;
+
+		/**
+		 * Number of frames in the file
+		 */
+		long frameCount;
+
+	public:
+		/**
+		 * Raw capture constructor
+		 * @param path the path to the raw frames file
+		 * @param size frames size
+		 * @param type frames type (CV_8UC3 for BGR frames)
+		 * @param frameRate target frame rate or 0 for unthrottled capture
+		 * @param offset offset of the first frame in the file
+		 */
+		CvRawCapture(const string & path,
+					 const Size & size,
+					 const int type = CV_8UC3,
+					 const double frameRate = 0.0,
+					 const size_t offset = 0);
+
+		/**
+		 * Raw capture destructor.
+		 * Unmaps and closes file
+		 */
+		virtual ~CvRawCapture();
+
+		/**
+		 * Release this source: unmaps and closes file
+		 */
+		void release();
+
+		/**
+		 * Number of frames in the file
+		 * @return the number of frames in the file
+		 */
+		long getFrameCount() const;
+
+		/**
+		 * Parse raw capture specification
+		 * <path>:<width>x<height>[@<rate>] (e.g. dump.bgr:1920x1080@30).
+		 * A missing or 0 rate means unthrottled capture.
+		 * @param spec the specification to parse
+		 * @param path the parsed path
+		 * @param size the parsed frames size
+		 * @param frameRate the parsed frame rate
+		 * @return true if specification has been parsed successfully
+		 */
+		static bool parse(const string & spec,
+						  string & path,
+						  Size & size,
+						  double & frameRate);
+
+	protected:
+		/**
+		 * Maps the raw frames file
+		 * @return true if file has been mapped and contains at least one
+		 * frame
+		 */
+		bool setup();
+
+		/**
+		 * Fetch frame at index: sets #frame header into the mapping
+		 * @param index the index of the frame to fetch
+		 * @return true if index is valid
+		 */
+		bool fetchFrame(const long index);
+
+		/**
+		 * Unmaps and closes file
+		 */
+		void unmap();
+};
+
+#endif /* CVRAWCAPTURE_H_ */
@@ -7,174 +7,110 @@
 
 #include <iostream>		// pour cout & cerr
 #include <fstream>		// pour l'ifstream
+#include <sstream>		// pour l'istringstream
 #include <string>		// pour les string
+#include <cstring>		// pour strncmp
 using namespace std;
 
+#include "mapRed.h"
+#include "mapGreen.h"
+#include "mapBlue.h"
+#include "mapHSV.h"
+#include "mapCb.h"
+#include "mapCr.h"
+
+#include "CvColorKernels.h"
 #include "Palette.h"
 
 const size_t Palette::CMAPSIZE = 256;
 
 const size_t Palette::COMPSIZE = 3;
 
+const char * const Palette::BINARYTAG = "PAL1";
+
 /*
  * Constructor from bidimensional array
  * @param map bidimensional array containing palette values
  * @param minimum value in the palette (default is 0)
  * @param maximum value in the palette (default is 255)
  */
-Palette::Palette(unsigned char map[][3], int min, int max) :
-	colormap(COMPSIZE),
+Palette::Palette(const unsigned char map[][3], int min, int max) :
+	packedMap(CMAPSIZE * COMPSIZE + 1, 0),
 	minValue(min),
 	maxValue(max),
-	BGRChannels(COMPSIZE),
-	channelsAllocated(false)
+	squaredNorms(CMAPSIZE, 0)
 {
-	// initialize colormaps
-	for (size_t i=0; i < colormap.size(); i++)
-	{
-		colormap[i].create(CMAPSIZE,1,CV_8UC1);
-	}
-
-	// fill colormap with values
-	for (size_t c = 0; c < COMPSIZE; c++)
+	// fill packed colormap with RGB values in BGR order
+	for (size_t i=0; i < CMAPSIZE; i++)
 	{
-		for (size_t i=0; i < CMAPSIZE; i++)
+		for (size_t c = 0; c < COMPSIZE; c++)
 		{
-			colormap[c].at<uchar>(i, 0) = map[i][c];
+			packedMap[COMPSIZE * i + (COMPSIZE - 1 - c)] = map[i][c];
 		}
 	}
+
+	computeNorms();
 }
 
 /*
  * Constructor from file name.
  * List of operations :
  * 	- opens the file
- * 	- if file is correctly opened, then reads each line (ignoring lines
+ * 	- if file starts with the binary tag, reads 256 RGB triplets
+ * 	- otherwise reads each line (ignoring lines
  * 	starting with a "#" which indicates a comment line)
  * 	- each line should contain 3 bytes : e.g. 127 0 255
  * @param filename the name of the file to read
  * @param minimum value in the palette (default is 0)
  * @param maximum value in the palette (default is 255)
+ * @throw CvProcessorException#FILE_READ_FAIL if file can not be read
+ * @throw CvProcessorException#FILE_PARSE_FAIL if file content is
+ * invalid
  */
-Palette::Palette(const char * const filename, int min, int max) :
-	colormap(COMPSIZE),
+Palette::Palette(const char * const filename, int min, int max)
+	throw (CvProcessorException) :
+	packedMap(CMAPSIZE * COMPSIZE + 1, 0),
 	minValue(min),
 	maxValue(max),
-	BGRChannels(COMPSIZE),
-	channelsAllocated(false)
+	squaredNorms(CMAPSIZE, 0)
 {
-	// initialize colormaps
-	for (size_t i=0; i < colormap.size(); i++)
+	if (filename == NULL)
 	{
-		colormap[i].create(CMAPSIZE,1,CV_8UC1);
+		cerr << "Palette::Palette(NULL filename) : empty file name" << endl;
+		throw CvProcessorException(CvProcessorException::FILE_READ_FAIL,
+								   "empty palette file name");
 	}
 
-	unsigned int lineCount = 0;
-	unsigned int dataLineCount = 0;
+	ifstream inputFile(filename, ios::in | ios::binary);
 
-	if (filename != NULL)
+	if (!inputFile.is_open())
 	{
-		ifstream inputFile(filename);
-
-		if (inputFile.is_open())
-		{
-			string currentLine;
-			istringstream lineStream;
-			size_t searchComment;
-			int readValues[COMPSIZE];
-
-			while (!inputFile.eof())
-			{
-				getline(inputFile, currentLine);
-
-				lineCount++;
-
-				if (currentLine.length() > 0)
-				{
-					// checks for # character at the beginning of the line
-					searchComment = currentLine.find('#');
-
-					if ((searchComment == string::npos) &&
-						((int)searchComment != 0))
-						// no leading comment found : data line
-					{
-						// set current line into input string stream
-						lineStream.str(currentLine);
-
-						for (size_t i=0; i < COMPSIZE; i++)
-						{
-							// reads single value from input string stream
-							lineStream >> readValues[i];
-							if (lineStream.fail())
-							{
-								cerr << "Error reading RGB value index " << i
-								     <<" at line " << lineCount << endl;
-								exit(EXIT_FAILURE);
-							}
-							else
-							{
-								// checks invalid values
-								if (readValues[i] > maxValue)
-								{
-									readValues[i] = maxValue;
-								}
-								if (readValues[i] < minValue)
-								{
-									readValues[i] = minValue;
-								}
-							}
-
-							// Fill colormap with value
-							colormap[i].at<uchar>((int)dataLineCount,0)
-								= (uchar)readValues[i];
-						}
-
-						lineStream.clear();
-
-//						cout << "line " << lineCount << "[" << dataLineCount
-//							 << "] contains : \"" << currentLine << "\" data are "
-//							 << readValues[0] << ", " << readValues[1]
-//							 << ", " << readValues[2] << endl;
-
-						dataLineCount++;
-					}
-//					else // comment found at pos 0
-//					{
-//						cout << "comment line at line " << lineCount
-//						     << " : " << currentLine << endl;
-//					}
-				}
-//				else // empty line : skip
-//				{
-//					cout << "empty line at line " << lineCount << endl;
-//				}
-			}
+		cerr << "Palette::Palette(" << filename << ") : unable to open file"
+			 << endl;
+		throw CvProcessorException(CvProcessorException::FILE_READ_FAIL,
+								   filename);
+	}
 
-			if (dataLineCount != CMAPSIZE)
-			{
-				cerr << "Wrong number of datalines in the colormap : "
-				     << dataLineCount << endl;
-				exit(EXIT_FAILURE);
-			}
-//			else
-//			{
-//				cout << "Correctly read "<< CMAPSIZE <<" data lines" << endl;
-//			}
+	// checks for binary tag at the beginning of the file
+	const size_t tagLength = strlen(BINARYTAG);
+	char tag[8];
+	inputFile.read(tag, tagLength);
 
-			inputFile.close();
-		}
-		else // inputFile is not opened
-		{
-			cerr << "Palette::Palette(" << filename << ") : unable to open file"
-			     << endl;
-			exit(EXIT_FAILURE);
-		}
+	if (inputFile.good() && (strncmp(tag, BINARYTAG, tagLength) == 0))
+	{
+		readBinary(inputFile, filename);
 	}
-	else // filename is NULL
+	else
 	{
-		cerr << "Palette::Palette(NULL filename) : empty file name" << endl;
-		exit(EXIT_FAILURE);
+		// rewind and parse as text
+		inputFile.clear();
+		inputFile.seekg(0, ios::beg);
+		readText(inputFile, filename);
 	}
+
+	inputFile.close();
+
+	computeNorms();
 }
 
 /*
@@ -183,61 +119,411 @@ Palette::Palette(const char * const filename, int min, int max) :
  */
 Palette::~Palette()
 {
-	// Release matrices
-	for (size_t i=0; i < colormap.size(); i++)
-	{
-		colormap[i].release();
-		BGRChannels[i].release();
-	}
-
 	// Clear vectors
-	colormap.clear();
-	BGRChannels.clear();
+	packedMap.clear();
+	squaredNorms.clear();
 }
 
 /*
  * Apply the colormap on the single channel source image to build
  * a destination 3 channels color image.
  * @param src source mono-channel image
- * @param dst destination BGR-BGRChannels image
+ * @param dst destination BGR image
  */
-void Palette::applyPalette(const Mat & src, Mat & dst)
+void Palette::applyPalette(const Mat & src, Mat & dst) const
 {
-	const size_t BGR2RGB[CMAPSIZE] = {2,1,0};
-
 	// checks if source has only one channel
 	if (src.channels() == 1)
 	{
-		if (!channelsAllocated) // BGRChannels should be allocated first
+		// single pass lookup into packed colormap replaces LUT on each
+		// channel followed by a merge
+		applyPalette(src, 0, dst);
+	}
+	else // source has multiple channels
+	{
+		cerr << "Palette::applyColormap(...) : source has " << src.channels()
+		     << " channels" << endl;
+	}
+}
+
+/*
+ * Apply the colormap on a single channel of the source image to
+ * build a destination 3 channels color image in a single pass.
+ * @param src source image (CV_8UC1 or CV_8UC3)
+ * @param channel the channel of source image to apply colormap on
+ * @param dst destination BGR image
+ */
+void Palette::applyPalette(const Mat & src, const int channel, Mat & dst) const
+{
+	const int nbChannels = src.channels();
+
+	if (src.depth() != CV_8U || channel < 0 || channel >= nbChannels)
+	{
+		cerr << "Palette::applyPalette(...) : invalid channel " << channel
+			 << " for source with " << nbChannels << " channels" << endl;
+		return;
+	}
+
+	dst.create(src.size(), CV_8UC3);
+
+	int rows = src.rows;
+	int cols = src.cols;
+
+	// process continuous images as a single row
+	if (src.isContinuous() && dst.isContinuous())
+	{
+		cols *= rows;
+		rows = 1;
+	}
+
+	for (int y = 0; y < rows; y++)
+	{
+		CvColorKernels::paletteRow(src.ptr<uchar>(y) + channel, nbChannels,
+								   &packedMap[0], dst.ptr<uchar>(y), cols);
+	}
+}
+
+/*
+ * Apply the colormap on a single channel of the source image and
+ * write the resulting colors directly into a region of a larger
+ * BGR canvas (e.g. a tile of a mosaic) without any copy.
+ * @param src source image (CV_8UC1 or CV_8UC3)
+ * @param channel the channel of source image to apply colormap on
+ * @param canvas the destination BGR canvas (CV_8UC3)
+ * @param roi the region of the canvas to fill
+ * @pre roi has the same size as src and lies within canvas
+ */
+void Palette::applyPalette(const Mat & src,
+						   const int channel,
+						   Mat & canvas,
+						   const Rect & roi) const
+{
+	if ((canvas.type() != CV_8UC3) ||
+		(roi.size() != src.size()) ||
+		((roi & Rect(0, 0, canvas.cols, canvas.rows)) != roi))
+	{
+		cerr << "Palette::applyPalette(...) : invalid canvas region" << endl;
+		return;
+	}
+
+	// dst shares canvas data : create does nothing since size and
+	// type already match
+	Mat dst(canvas, roi);
+	applyPalette(src, channel, dst);
+}
+
+/*
+ * Packed BGR colormap accessor
+ * @return a pointer to CMAPSIZE consecutive BGR triplets
+ */
+const uchar * Palette::getPackedMap() const
+{
+	return &packedMap[0];
+}
+
+/*
+ * Squared norms accessor
+ * @return a pointer to CMAPSIZE squared norms of colormap colors
+ */
+const int * Palette::getSquaredNorms() const
+{
+	return &squaredNorms[0];
+}
+
+/*
+ * Registered palettes by name
+ * @return the process wide palettes registry
+ */
+map<string, Ptr<Palette> > & Palette::registry()
+{
+	static map<string, Ptr<Palette> > palettes;
+	return palettes;
+}
+
+/*
+ * Lock on the palettes registry
+ * @return the process wide registry lock
+ */
+mutex & Palette::registryLock()
+{
+	static mutex lock;
+	return lock;
+}
+
+/*
+ * Get a shared palette by name. Built-in palettes ("red", "green",
+ * "blue", "hsv", "cb" and "cr") are created on first request,
+ * other palettes should have been registered with load.
+ * @param name the name of the palette
+ * @return the palette registered under this name
+ * @throw CvProcessorException#INVALID_NAME if there is no palette
+ * with this name
+ */
+const Palette * Palette::get(const string & name)
+	throw (CvProcessorException)
+{
+	lock_guard<mutex> guard(registryLock());
+
+	map<string, Ptr<Palette> > & palettes = registry();
+	map<string, Ptr<Palette> >::iterator it = palettes.find(name);
+	if (it != palettes.end())
+	{
+		return it->second;
+	}
+
+	// Built-in palettes
+	Palette * palette = NULL;
+	if (name == "red")
+	{
+		palette = new Palette(mapRed);
+	}
+	else if (name == "green")
+	{
+		palette = new Palette(mapGreen);
+	}
+	else if (name == "blue")
+	{
+		palette = new Palette(mapBlue);
+	}
+	else if (name == "hsv")
+	{
+		palette = new Palette(mapHSV);
+	}
+	else if (name == "cb")
+	{
+		palette = new Palette(mapCb);
+	}
+	else if (name == "cr")
+	{
+		palette = new Palette(mapCr);
+	}
+	else
+	{
+		cerr << "Palette::get(" << name << ") : unknown palette" << endl;
+		throw CvProcessorException(CvProcessorException::INVALID_NAME,
+								   name.c_str());
+	}
+
+	palettes[name] = Ptr<Palette>(palette);
+	return palette;
+}
+
+/*
+ * Load a palette file (text or binary) and register it by name.
+ * If a palette is already registered by this name, it is returned
+ * and the file is not read again.
+ * @param name the name to register the palette with
+ * @param filename the name of the file to read
+ * @return the palette registered under this name
+ * @throw CvProcessorException if file can not be read or parsed
+ */
+const Palette * Palette::load(const string & name,
+							  const char * const filename)
+	throw (CvProcessorException)
+{
+	lock_guard<mutex> guard(registryLock());
+
+	map<string, Ptr<Palette> > & palettes = registry();
+	map<string, Ptr<Palette> >::iterator it = palettes.find(name);
+	if (it != palettes.end())
+	{
+		return it->second;
+	}
+
+	Palette * palette = new Palette(filename);
+	palettes[name] = Ptr<Palette>(palette);
+	return palette;
+}
+
+/*
+ * Save this palette in binary format
+ * @param filename the name of the file to write
+ * @throw CvProcessorException#FILE_WRITE_FAIL if file can not be
+ * written
+ */
+void Palette::save(const char * const filename) const
+	throw (CvProcessorException)
+{
+	if (filename == NULL)
+	{
+		throw CvProcessorException(CvProcessorException::FILE_WRITE_FAIL,
+								   "empty palette file name");
+	}
+
+	ofstream outputFile(filename, ios::out | ios::binary | ios::trunc);
+
+	if (outputFile.is_open())
+	{
+		outputFile.write(BINARYTAG, strlen(BINARYTAG));
+
+		// stored in RGB order as text files and arrays
+		for (size_t i = 0; i < CMAPSIZE; i++)
 		{
-			for (size_t i=0; i < BGRChannels.size(); i++)
+			for (size_t c = 0; c < COMPSIZE; c++)
 			{
-				BGRChannels[i].create(src.size(),CV_8UC1);
+				outputFile.put((char) packedMap[COMPSIZE * i + (COMPSIZE - 1 - c)]);
 			}
-			channelsAllocated = true;
 		}
 
-		if (src.size() != BGRChannels[0].size()) // BGRChannels should be reallocated
+		outputFile.close();
+	}
+
+	if (outputFile.fail())
+	{
+		cerr << "Palette::save(" << filename << ") : unable to write file"
+			 << endl;
+		throw CvProcessorException(CvProcessorException::FILE_WRITE_FAIL,
+								   filename);
+	}
+}
+
+/*
+ * Converts a text palette file into a binary palette file
+ * @param textFilename the text palette file to read
+ * @param binaryFilename the binary palette file to write
+ * @throw CvProcessorException if text file can not be read or
+ * parsed or if binary file can not be written
+ */
+void Palette::compile(const char * const textFilename,
+					  const char * const binaryFilename)
+	throw (CvProcessorException)
+{
+	Palette palette(textFilename);
+	palette.save(binaryFilename);
+}
+
+/*
+ * Computes squaredNorms from packedMap
+ */
+void Palette::computeNorms()
+{
+	for (size_t i = 0; i < CMAPSIZE; i++)
+	{
+		int norm = 0;
+		for (size_t c = 0; c < COMPSIZE; c++)
+		{
+			const int value = packedMap[COMPSIZE * i + c];
+			norm += value * value;
+		}
+		squaredNorms[i] = norm;
+	}
+}
+
+/*
+ * Sets a color in packedMap from a RGB value
+ * @param index the index of the color
+ * @param component the RGB component index
+ * @param value the value of the component (clamped to
+ * [minValue..maxValue])
+ */
+void Palette::setComponent(const size_t index,
+						   const size_t component,
+						   int value)
+{
+	// checks invalid values
+	if (value > maxValue)
+	{
+		value = maxValue;
+	}
+	if (value < minValue)
+	{
+		value = minValue;
+	}
+
+	// RGB values are stored in BGR order
+	packedMap[COMPSIZE * index + (COMPSIZE - 1 - component)] = (uchar) value;
+}
+
+/*
+ * Reads 256 RGB triplets of a binary palette file (after tag)
+ * @param inputFile the opened file
+ * @param filename the file name for error messages
+ * @throw CvProcessorException#FILE_PARSE_FAIL if file is too short
+ */
+void Palette::readBinary(ifstream & inputFile, const char * const filename)
+	throw (CvProcessorException)
+{
+	vector<char> values(CMAPSIZE * COMPSIZE);
+	inputFile.read(&values[0], values.size());
+
+	if ((size_t) inputFile.gcount() != values.size())
+	{
+		cerr << "Palette::Palette(" << filename << ") : truncated binary "
+			 << "palette" << endl;
+		throw CvProcessorException(CvProcessorException::FILE_PARSE_FAIL,
+								   filename);
+	}
+
+	for (size_t i = 0; i < CMAPSIZE; i++)
+	{
+		for (size_t c = 0; c < COMPSIZE; c++)
+		{
+			setComponent(i, c, (uchar) values[COMPSIZE * i + c]);
+		}
+	}
+}
+
+/*
+ * Reads 256 "R G B" lines of a text palette file
+ * @param inputFile the opened file
+ * @param filename the file name for error messages
+ * @throw CvProcessorException#FILE_PARSE_FAIL if a line can not be
+ * read or if the number of data lines is not 256
+ */
+void Palette::readText(ifstream & inputFile, const char * const filename)
+	throw (CvProcessorException)
+{
+	unsigned int lineCount = 0;
+	size_t dataLineCount = 0;
+	string currentLine;
+	istringstream lineStream;
+	int readValues[COMPSIZE];
+
+	while (getline(inputFile, currentLine))
+	{
+		lineCount++;
+
+		// skip empty lines and lines starting with a # character
+		if ((currentLine.length() == 0) ||
+			(currentLine.find_first_not_of(" \t\r") == string::npos) ||
+			(currentLine[currentLine.find_first_not_of(" \t")] == '#'))
 		{
-			for (size_t i=0; i < BGRChannels.size(); i++)
+			continue;
+		}
+
+		// set current line into input string stream
+		lineStream.clear();
+		lineStream.str(currentLine);
+
+		for (size_t i=0; i < COMPSIZE; i++)
+		{
+			// reads single value from input string stream
+			lineStream >> readValues[i];
+			if (lineStream.fail())
 			{
-				BGRChannels[i].release();
-				BGRChannels[i].create(src.size(),CV_8UC1);
+				cerr << "Error reading RGB value index " << i
+					 <<" at line " << lineCount << " of " << filename << endl;
+				throw CvProcessorException(CvProcessorException::FILE_PARSE_FAIL,
+										   filename);
 			}
 		}
 
-		// Apply Look Up Table on each channel
-		for (size_t i=0; i < COMPSIZE; i++)
+		if (dataLineCount < CMAPSIZE)
 		{
-			LUT(src,colormap[BGR2RGB[i]],BGRChannels[i]);
+			for (size_t i=0; i < COMPSIZE; i++)
+			{
+				setComponent(dataLineCount, i, readValues[i]);
+			}
 		}
 
-		// then merge all the BGRChannels into a BGR image
-		merge(BGRChannels, dst);
+		dataLineCount++;
 	}
-	else // source has multiple channels
+
+	if (dataLineCount != CMAPSIZE)
 	{
-		cerr << "Palette::applyColormap(...) : source has " << src.channels()
-		     << " channels" << endl;
+		cerr << "Wrong number of datalines in the colormap " << filename
+			 << " : " << dataLineCount << endl;
+		throw CvProcessorException(CvProcessorException::FILE_PARSE_FAIL,
+								   filename);
 	}
 }
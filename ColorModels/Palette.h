@@ -12,28 +12,41 @@
 using namespace cv;
 
 #include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <mutex>
 using namespace std;
 
+#include "CvProcessorException.h"
+
 /**
  * Palette loads colormap from files or static arrays and apply it to a single
- * channel image (8 bits single channel image : CV_8UC1) in order to rebuild a
- * BGR image featuring the colors in the palette.
+ * channel image (8 bits single channel image : CV_8UC1) or to a single
+ * channel of a multichannel image in order to rebuild a BGR image featuring
+ * the colors in the palette.
  * A Colormap is composed of 256 RGB values that should be applied for each
  * level (from 0 to 255) of the single channel image.
  * colormap is applied
- * @warning colormap are stored in RGB order, but OpenCV images are stored in
- * BGR order.
+ * Palettes can be read from text files (one "R G B" line per level) or from
+ * compact binary files ("PAL1" tag followed by 256 RGB triplets) which can be
+ * produced from text files with #compile.
+ * Palettes are immutable once built, so they can be shared between
+ * processors : #get provides process wide instances by name (built-in
+ * palettes or palettes registered with #load).
+ * @warning colormap arrays and files are in RGB order, but colors are
+ * stored in BGR order, as in OpenCV images.
  */
 class Palette
 {
 	protected:
 		/**
-		 * RGB colormap
-		 * 	- Red colormap is first component
-		 * 	- Green colormap is second component
-		 * 	- Blue colormap is third component
+		 * Packed BGR colormap : CMAPSIZE BGR colors stored consecutively
+		 * (in the same order as OpenCV images) so a single lookup provides
+		 * all components of a color. An extra padding byte at the end
+		 * allows to read any color as a 32 bits word.
 		 */
-		vector<Mat> colormap;
+		vector<uchar> packedMap;
 
 		/**
 		 * Minimum value in the palette.
@@ -48,18 +61,10 @@ class Palette
 		int maxValue;
 
 		/**
-		 * BGR BGRChannels of the resulting image
-		 */
-		vector<Mat> BGRChannels;
-
-		/**
-		 * Checks if channels have been allocated yet.
-		 * Channels may be allocated only when they are not or when they
-		 * does not fit the image dimension provided in applyPalette methods.
-		 * In this case, if BGRChannels have been allocated they are released and
-		 * recreated.
+		 * Squared norms of each color in #packedMap, used to compare
+		 * colors obtained from different palettes
 		 */
-		bool channelsAllocated;
+		vector<int> squaredNorms;
 
 		/**
 		 * Number of elements in the colormap : 256
@@ -71,6 +76,23 @@ class Palette
 		 */
 		static const size_t COMPSIZE;
 
+		/**
+		 * Tag at the beginning of binary palette files
+		 */
+		static const char * const BINARYTAG;
+
+		/**
+		 * Registered palettes by name
+		 * @return the process wide palettes registry
+		 */
+		static map<string, Ptr<Palette> > & registry();
+
+		/**
+		 * Lock on the palettes registry
+		 * @return the process wide registry lock
+		 */
+		static mutex & registryLock();
+
 	public:
 		/**
 		 * Constructor from bidimensional array
@@ -78,20 +100,25 @@ class Palette
 		 * @param min  minimum value in the palette (default is 0)
 		 * @param max maximum value in the palette (default is 255)
 		 */
-		Palette(uchar map[][3], int min = 0, int max = 255);
+		Palette(const uchar map[][3], int min = 0, int max = 255);
 
 		/**
 		 * Constructor from file name.
 		 * List of operations :
 		 * 	- opens the file
-		 * 	- if file is correctly opened, then reads each line (ignoring lines
+		 * 	- if file starts with the binary tag, reads 256 RGB triplets
+		 * 	- otherwise reads each line (ignoring lines
 		 * 	starting with a "#" which indicates a comment line)
 		 * 	- each line should contain 3 bytes : e.g. 127 0 255
 		 * @param filename the name of the file to read
 		 * @param min minimum value in the palette (default is 0)
 		 * @param max maximum value in the palette (default is 255)
+		 * @throw CvProcessorException#FILE_READ_FAIL if file can not be read
+		 * @throw CvProcessorException#FILE_PARSE_FAIL if file content is
+		 * invalid
 		 */
-		Palette(const char * const filename, int min=0, int max = 255);
+		Palette(const char * const filename, int min=0, int max = 255)
+			throw (CvProcessorException);
 
 		/**
 		 * Palette destructor.
@@ -99,13 +126,131 @@ class Palette
 		 */
 		virtual ~Palette();
 
+		/**
+		 * Get a shared palette by name. Built-in palettes ("red", "green",
+		 * "blue", "hsv", "cb" and "cr") are created on first request,
+		 * other palettes should have been registered with #load.
+		 * @param name the name of the palette
+		 * @return the palette registered under this name
+		 * @throw CvProcessorException#INVALID_NAME if there is no palette
+		 * with this name
+		 */
+		static const Palette * get(const string & name)
+			throw (CvProcessorException);
+
+		/**
+		 * Load a palette file (text or binary) and register it by name.
+		 * If a palette is already registered by this name, it is returned
+		 * and the file is not read again.
+		 * @param name the name to register the palette with
+		 * @param filename the name of the file to read
+		 * @return the palette registered under this name
+		 * @throw CvProcessorException if file can not be read or parsed
+		 */
+		static const Palette * load(const string & name,
+									const char * const filename)
+			throw (CvProcessorException);
+
+		/**
+		 * Save this palette in binary format
+		 * @param filename the name of the file to write
+		 * @throw CvProcessorException#FILE_WRITE_FAIL if file can not be
+		 * written
+		 */
+		void save(const char * const filename) const
+			throw (CvProcessorException);
+
+		/**
+		 * Converts a text palette file into a binary palette file
+		 * @param textFilename the text palette file to read
+		 * @param binaryFilename the binary palette file to write
+		 * @throw CvProcessorException if text file can not be read or
+		 * parsed or if binary file can not be written
+		 */
+		static void compile(const char * const textFilename,
+							const char * const binaryFilename)
+			throw (CvProcessorException);
+
 		/**
 		 * Apply the colormap on the single channel source image to build
 		 * a destination 3 channels color image.
 		 * @param src source mono-channel image
-		 * @param dst destination BGR-BGRChannels image
+		 * @param dst destination BGR image
+		 */
+		void applyPalette(const Mat & src, Mat & dst) const;
+
+		/**
+		 * Apply the colormap on a single channel of the source image to
+		 * build a destination 3 channels color image in a single pass (no
+		 * channel split, no merge).
+		 * @param src source image (CV_8UC1 or CV_8UC3)
+		 * @param channel the channel of source image to apply colormap on
+		 * @param dst destination BGR image
+		 */
+		void applyPalette(const Mat & src, const int channel, Mat & dst) const;
+
+		/**
+		 * Apply the colormap on a single channel of the source image and
+		 * write the resulting colors directly into a region of a larger
+		 * BGR canvas (e.g. a tile of a mosaic) without any copy.
+		 * @param src source image (CV_8UC1 or CV_8UC3)
+		 * @param channel the channel of source image to apply colormap on
+		 * @param canvas the destination BGR canvas (CV_8UC3)
+		 * @param roi the region of the canvas to fill
+		 * @pre roi has the same size as src and lies within canvas
+		 */
+		void applyPalette(const Mat & src,
+						  const int channel,
+						  Mat & canvas,
+						  const Rect & roi) const;
+
+		/**
+		 * Packed BGR colormap accessor
+		 * @return a pointer to CMAPSIZE consecutive BGR triplets
+		 */
+		const uchar * getPackedMap() const;
+
+		/**
+		 * Squared norms accessor
+		 * @return a pointer to CMAPSIZE squared norms of colormap colors
+		 */
+		const int * getSquaredNorms() const;
+
+	protected:
+		/**
+		 * Computes #squaredNorms from #packedMap
+		 */
+		void computeNorms();
+
+		/**
+		 * Sets a color in #packedMap from a RGB value
+		 * @param index the index of the color
+		 * @param component the RGB component index
+		 * @param value the value of the component (clamped to
+		 * [#minValue..#maxValue])
+		 */
+		void setComponent(const size_t index,
+						  const size_t component,
+						  int value);
+
+		/**
+		 * Reads 256 RGB triplets of a binary palette file (after tag)
+		 * @param inputFile the opened file
+		 * @param filename the file name for error messages
+		 * @throw CvProcessorException#FILE_PARSE_FAIL if file is too short
+		 */
+		void readBinary(ifstream & inputFile, const char * const filename)
+			throw (CvProcessorException);
+
+		/**
+		 * Reads 256 "R G B" lines of a text palette file
+		 * @param inputFile the opened file
+		 * @param filename the file name for error messages
+		 * @throw CvProcessorException#FILE_PARSE_FAIL if a line can not be
+		 * read or if the number of data lines is not 256
 		 */
-		void applyPalette(const Mat & src, Mat & dst);
+		void readText(ifstream & inputFile, const char * const filename)
+			throw (CvProcessorException);
 };
 
 #endif /* PALETTE_H_ */
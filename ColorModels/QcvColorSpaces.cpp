@@ -5,7 +5,12 @@
  *      Author: davidroussel
  */
 
+#include <sstream>	// for ostringstream
+#include <fstream>	// for ofstream
+using namespace std;
+
 #include <QDebug>
+#include "CvColorKernels.h"
 #include "QcvColorSpaces.h"
 
 /*
@@ -14,14 +19,17 @@
  * @param imageLock the mutex on source image
  * @param updateThread the thread in which this processor runs
  * @param parent object
+ * @param nbThreads number of threads (i.e. bands of rows) used to
+ * compute images, 0 uses all hardware threads
  */
 QcvColorSpaces::QcvColorSpaces(Mat * inFrame,
 							   QMutex * imageLock,
 							   QThread * updateThread,
-							   QObject * parent) :
+							   QObject * parent,
+							   const size_t nbThreads) :
 	CvProcessor(inFrame),
 	QcvProcessor(inFrame, imageLock, updateThread, parent),
-	CvColorSpaces(inFrame)
+	CvColorSpaces(inFrame, nbThreads)
 {
 }
 
@@ -117,6 +125,9 @@ void QcvColorSpaces::setDisplayImageIndex(const Display index)
 		case Cb:
 			message.append(tr("Cb component of YCbCr space"));
 			break;
+		case MOSAIC:
+			message.append(tr("Mosaic of RGB, HSV, YCbCr and XYZ components"));
+			break;
 		case NbSelected:
 		default:
 			message.append(tr("Unknown"));
@@ -209,3 +220,112 @@ void QcvColorSpaces::setHueDisplayMode(const HueDisplay mode)
 
 	emit sendMessage(message, defaultTimeOut);
 }
+
+/*
+ * Sets the precision used to compute XYZ channels and sends
+ * notification message
+ * @param precision the number of fractional bits or
+ * CvColorKernels::XYZ_FLOAT
+ */
+void QcvColorSpaces::setXYZPrecision(const int precision)
+{
+	CvColorSpaces::setXYZPrecision(precision);
+
+	message.clear();
+	message.append(tr("XYZ components computed with: "));
+	if (xyzPrecision == CvColorKernels::XYZ_FLOAT)
+	{
+		message.append(tr("floating point values"));
+	}
+	else
+	{
+		message.append(QString::number(xyzPrecision));
+		message.append(tr(" bits fixed point values"));
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets the time after which images of unused stages are released
+ * and sends notification message
+ * @param ms the new idle time in ms
+ */
+void QcvColorSpaces::setIdleTime(const int ms)
+{
+	CvColorSpaces::setIdleTime(ms);
+
+	message.clear();
+	message.append(tr("Unused images released after: "));
+	if (ms < 0)
+	{
+		message.append(tr("never"));
+	}
+	else
+	{
+		message.append(QString::number(ms));
+		message.append(tr(" ms"));
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets the number of threads used to compute images and sends
+ * notification message
+ * @param nbThreads the new number of threads (i.e. bands of rows),
+ * 0 uses all hardware threads
+ */
+void QcvColorSpaces::setNbThreads(const size_t nbThreads)
+{
+	CvColorSpaces::setNbThreads(nbThreads);
+
+	message.clear();
+	message.append(tr("Images computed in bands by: "));
+	message.append(QString::number((qulonglong) getNbThreads()));
+	message.append(tr(" thread(s)"));
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Latencies of all display modes as JSON
+ * @return a JSON object containing latencies statistics of each
+ * display mode (see CvColorSpaces::latenciesToJSON)
+ */
+QString QcvColorSpaces::getLatenciesJSON() const
+{
+	ostringstream json;
+	latenciesToJSON(json);
+	return QString::fromStdString(json.str());
+}
+
+/*
+ * Dumps latencies of all display modes to a JSON file and sends
+ * notification message
+ * @param fileName the name of the file to write
+ * @return true if file has been written, false otherwise
+ */
+bool QcvColorSpaces::dumpLatencies(const QString & fileName)
+{
+	ofstream file(fileName.toLocal8Bit().constData());
+	if (file.is_open())
+	{
+		latenciesToJSON(file);
+	}
+
+	message.clear();
+	if (file.good())
+	{
+		message.append(tr("Latencies written to: "));
+	}
+	else
+	{
+		message.append(tr("Unable to write latencies to: "));
+	}
+	message.append(fileName);
+
+	emit sendMessage(message, defaultTimeOut);
+
+	return file.good();
+}
@@ -25,11 +25,14 @@ class QcvColorSpaces : public QcvProcessor, public CvColorSpaces
 		 * @param imageLock the mutex on source image
 		 * @param updateThread the thread in which this processor runs
 		 * @param parent object
+		 * @param nbThreads number of threads (i.e. bands of rows) used to
+		 * compute images, 0 uses all hardware threads
 		 */
 		QcvColorSpaces(Mat * inFrame,
 					   QMutex * imageLock = NULL,
 					   QThread * updateThread = NULL,
-					   QObject * parent = NULL);
+					   QObject * parent = NULL,
+					   const size_t nbThreads = 1);
 
 		/**
 		 * QcvColorSpaces destructor
@@ -56,12 +59,50 @@ class QcvColorSpaces : public QcvProcessor, public CvColorSpaces
 		 */
 		void setHueDisplayMode(const HueDisplay mode);
 
+		/**
+		 * Sets the precision used to compute XYZ channels and sends
+		 * notification message
+		 * @param precision the number of fractional bits or
+		 * CvColorKernels::XYZ_FLOAT
+		 */
+		void setXYZPrecision(const int precision);
+
+		/**
+		 * Sets the time after which images of unused stages are released
+		 * and sends notification message
+		 * @param ms the new idle time in ms
+		 */
+		void setIdleTime(const int ms);
+
+		/**
+		 * Sets the number of threads used to compute images and sends
+		 * notification message
+		 * @param nbThreads the new number of threads (i.e. bands of rows),
+		 * 0 uses all hardware threads
+		 */
+		void setNbThreads(const size_t nbThreads);
+
+		/**
+		 * Latencies of all display modes as JSON
+		 * @return a JSON object containing latencies statistics of each
+		 * display mode (see CvColorSpaces#latenciesToJSON)
+		 */
+		QString getLatenciesJSON() const;
+
 	public slots:
 		/**
 		 * Update computed images and sends displayImageChanged signal if
 		 * required
 		 */
 		void update();
+
+		/**
+		 * Dumps latencies of all display modes to a JSON file and sends
+		 * notification message
+		 * @param fileName the name of the file to write
+		 * @return true if file has been written, false otherwise
+		 */
+		bool dumpLatencies(const QString & fileName);
 };
 
 #endif /* QCVCOLORSPACES_H_ */
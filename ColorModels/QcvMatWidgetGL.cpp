@@ -60,7 +60,7 @@ void QcvMatWidgetGL::setSourceImage(Mat *sourceImage)
 		delete gl;
 	}
 
-	convertImage();
+	convertIfDirty();
 
 	gl = new QGLImageRender(displayImage, this);
 
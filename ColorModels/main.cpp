@@ -2,12 +2,16 @@
 #include <QThread>
 #include <libgen.h>		// for basename
 #include <iostream>		// for cout
+#include <vector>
+#include <cstdlib>		// for EXIT_SUCCESS & EXIT_FAILURE
 
 using namespace std;
 
 #include "QcvVideoCapture.h"
+#include "QcvCapturePool.h"
 #include "CaptureFactory.h"
 #include "QcvColorSpaces.h"
+#include "Palette.h"
 #include "mainwindow.h"
 
 /**
@@ -16,6 +20,16 @@ using namespace std;
  */
 void usage(char * name);
 
+/**
+ * Checks X, Y and Z components computed by CvColorKernels::xyzComponent
+ * with floating point and each fixed point precision against a double
+ * precision conversion on all 2^24 BGR colors and prints the maximum
+ * error of each precision on standard output
+ * @return true if all components are within 1 LSB of the double precision
+ * conversion, false otherwise
+ */
+bool checkXYZ();
+
 /**
  * Test program OpenCV2 + QT5
  * @param argc argument count
@@ -25,6 +39,9 @@ void usage(char * name);
  * [--mirror | -m] [--size | -s] <width>x<height>
  * 	- device : [--device | -d] <device #> (0, 1, ...) Opens capture device #
  * 	- filename : [--file | -f ] <filename> Opens a video file or URL (including rtsp)
+ * 	- multiple devices and/or files can be provided to open multiple streams,
+ * 	the first one is displayed and each stream is processed by its own
+ * 	processor. Streams share [--pool | -p] <threads> threads.
  * 	- mirror : mirrors image horizontally before display
  *	- render : use Qimage and Qlabel or QGLWidget for image rendering in QtWidget
  *		[-r | --render] [IM | LBL | GL]
@@ -33,6 +50,19 @@ void usage(char * name);
  *		- GL for OpenGL rendering
  *	- size : [--size | -s] <width>x<height> resize capture to fit desired <width>
  *	and <height>
+ *	- palette compiler : [--compile-palette] <text file> <binary file>
+ *	converts a text palette file to binary palette format and exits
+ *	- bands : [--bands] <threads> number of threads computing bands of rows
+ *	in each processor (0 uses all hardware threads)
+ *	- latencies : [--latencies] <file> dumps latencies of each display mode
+ *	to a JSON file when program ends
+ *	- xyz precision : [--xyz-precision] <bits | float> number of fractional
+ *	bits of fixed point XYZ conversion or float for floating point conversion
+ *	- idle time : [--idle-time] <ms> time after which images of unused
+ *	stages are released (negative values never release them)
+ *	- check xyz : [--check-xyz] checks XYZ conversion of all colors with
+ *	each precision against double precision conversion (within 1 LSB),
+ *	then exits
  */
 int main(int argc, char *argv[])
 {
@@ -45,7 +75,12 @@ int main(int argc, char *argv[])
 	QStringList argList = QCoreApplication::arguments();
 
 	int threadNumber = 3;
-	// parse arguments for --threads tag
+	int bandsNumber = 1;
+	QString latenciesFile;
+	int xyzPrecision = CvColorSpaces::defaultXYZPrecision;
+	int idleTime = CvColorSpaces::defaultIdleTime;
+	// parse arguments for --threads, --bands, --latencies, --xyz-precision,
+	// --idle-time, --check-xyz and --compile-palette tags
 	for (QListIterator<QString> it(argList); it.hasNext(); )
 	{
 		QString currentArg(it.next());
@@ -69,6 +104,126 @@ int main(int argc, char *argv[])
 				qWarning("Warning: thread tag found with no following thread number");
 			}
 		}
+
+		if (currentArg == "--bands")
+		{
+			// Next argument should be bands threads number integer
+			if (it.hasNext())
+			{
+				QString bandsString(it.next());
+				bool convertOk;
+				bandsNumber = bandsString.toInt(&convertOk,10);
+				if (!convertOk || bandsNumber < 0)
+				{
+					qWarning("Warning: Invalid bands threads number %d",
+							 bandsNumber);
+					bandsNumber = 1;
+				}
+			}
+			else
+			{
+				qWarning("Warning: bands tag found with no following threads number");
+			}
+		}
+
+		if (currentArg == "--latencies")
+		{
+			// Next argument should be the JSON file name
+			if (it.hasNext())
+			{
+				latenciesFile = it.next();
+			}
+			else
+			{
+				qWarning("Warning: latencies tag found with no following file name");
+			}
+		}
+
+		if (currentArg == "--xyz-precision")
+		{
+			// Next argument should be bits number integer or float
+			if (it.hasNext())
+			{
+				QString precisionString(it.next());
+				if (precisionString == "float")
+				{
+					xyzPrecision = CvColorKernels::XYZ_FLOAT;
+				}
+				else
+				{
+					bool convertOk;
+					xyzPrecision = precisionString.toInt(&convertOk,10);
+					if (!convertOk ||
+						xyzPrecision < CvColorKernels::XYZ_MIN_BITS ||
+						xyzPrecision > CvColorKernels::XYZ_MAX_BITS)
+					{
+						qWarning("Warning: Invalid XYZ precision %s",
+								 precisionString.toLocal8Bit().constData());
+						xyzPrecision = CvColorSpaces::defaultXYZPrecision;
+					}
+				}
+			}
+			else
+			{
+				qWarning("Warning: xyz-precision tag found with no following precision");
+			}
+		}
+
+		if (currentArg == "--idle-time")
+		{
+			// Next argument should be idle time integer in ms
+			if (it.hasNext())
+			{
+				QString idleString(it.next());
+				bool convertOk;
+				idleTime = idleString.toInt(&convertOk,10);
+				if (!convertOk)
+				{
+					qWarning("Warning: Invalid idle time %s",
+							 idleString.toLocal8Bit().constData());
+					idleTime = CvColorSpaces::defaultIdleTime;
+				}
+			}
+			else
+			{
+				qWarning("Warning: idle-time tag found with no following time");
+			}
+		}
+
+		if (currentArg == "--check-xyz")
+		{
+			return checkXYZ() ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		if (currentArg == "--compile-palette")
+		{
+			// Next arguments should be text and binary palette file names
+			if (it.hasNext())
+			{
+				QString textFile(it.next());
+				if (it.hasNext())
+				{
+					QString binaryFile(it.next());
+					try
+					{
+						Palette::compile(textFile.toLocal8Bit().constData(),
+										 binaryFile.toLocal8Bit().constData());
+						cout << "Palette " << textFile.toStdString()
+							 << " compiled to " << binaryFile.toStdString()
+							 << endl;
+						return EXIT_SUCCESS;
+					}
+					catch (CvProcessorException & e)
+					{
+						cerr << "Palette compilation failed : " << e.what()
+							 << endl;
+						return EXIT_FAILURE;
+					}
+				}
+			}
+			qWarning("Warning: compile-palette tag needs text and binary file names");
+			return EXIT_FAILURE;
+		}
 	}
 	// ------------------------------------------------------------------------
 	// Create Capture factory using program arguments and
@@ -77,15 +232,54 @@ int main(int argc, char *argv[])
 	CaptureFactory factory(argList);
 	factory.setSkippable(true);
 
+	int nbStreams = factory.getNbStreams();
+
 	// Helper thread for capture
 	QThread * capThread = NULL;
-	if (threadNumber > 1)
+
+	// Capture pool when multiple streams are requested
+	QcvCapturePool * pool = NULL;
+
+	// Capture
+	QcvVideoCapture * capture = NULL;
+
+	if (nbStreams > 1)
 	{
-		capThread = new QThread();
+		// Multiple streams share the pool threads
+		pool = factory.getCapturePool();
+		if (pool->getNbStreams() > 0)
+		{
+			capture = pool->getCapture(0);
+			capThread = capture->getUpdateThread();
+		}
+		else
+		{
+			delete pool; // deletes shared threads
+			pool = NULL;
+		}
 	}
+	else
+	{
+		if (threadNumber > 1)
+		{
+			capThread = new QThread();
+		}
 
-	// Capture
-	QcvVideoCapture * capture = factory.getCaptureInstance(capThread);
+		capture = factory.getCaptureInstance(capThread);
+
+		if (capture == NULL && capThread != NULL)
+		{
+			delete capThread;
+			capThread = NULL;
+		}
+	}
+
+	if (capture == NULL)
+	{
+		cerr << "Unable to open video source" << endl;
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
 
 	// ------------------------------------------------------------------------
 	// Create QColorSpaces
@@ -108,7 +302,11 @@ int main(int argc, char *argv[])
 	QcvColorSpaces * colorSpace = NULL;
 	if (procThread == NULL)
 	{
-		colorSpace = new QcvColorSpaces(capture->getImage());
+		// captures of a pool run in pool threads even with 1 thread, so
+		// processor in the main thread should lock their images
+		colorSpace = new QcvColorSpaces(capture->getImage(),
+										capThread != NULL ?
+											capture->getMutex() : NULL);
 	}
 	else
 	{
@@ -126,6 +324,34 @@ int main(int argc, char *argv[])
 		}
 	}
 	colorSpace->setVerboseLevel(CvProcessor::VERBOSE_WARNINGS);
+	colorSpace->setNbThreads((size_t) bandsNumber);
+	colorSpace->setXYZPrecision(xyzPrecision);
+	colorSpace->setIdleTime(idleTime);
+
+	// Processors of other streams run in their capture's thread
+	vector<QcvColorSpaces *> streamProcessors;
+	if (pool != NULL)
+	{
+		for (size_t i = 1; i < pool->getNbStreams(); i++)
+		{
+			QcvVideoCapture * streamCapture = pool->getCapture(i);
+			QcvColorSpaces * streamProcessor =
+				new QcvColorSpaces(streamCapture->getImage(),
+								   NULL,
+								   streamCapture->getUpdateThread());
+			streamProcessor->setVerboseLevel(CvProcessor::VERBOSE_WARNINGS);
+			streamProcessor->setNbThreads((size_t) bandsNumber);
+			streamProcessor->setXYZPrecision(xyzPrecision);
+			streamProcessor->setIdleTime(idleTime);
+
+			QObject::connect(streamCapture, SIGNAL(updated()),
+							 streamProcessor, SLOT(update()));
+			QObject::connect(streamCapture, SIGNAL(imageChanged(Mat*)),
+							 streamProcessor, SLOT(setSourceImage(Mat*)));
+
+			streamProcessors.push_back(streamProcessor);
+		}
+	}
 
 	// ------------------------------------------------------------------------
 	// Connects capture to colorSpaces
@@ -146,13 +372,51 @@ int main(int argc, char *argv[])
 	MainWindow w(capture, colorSpace);
 	w.show();
 
+	if (pool != NULL)
+	{
+		// Show aggregate streams statistics in status bar
+		QObject::connect(pool, SIGNAL(messageChanged(QString,int)),
+						 &w, SIGNAL(sendMessage(QString,int)));
+		pool->setReportInterval(2000);
+	}
+
 	usage(argv[0]);
 
 	int retVal = app.exec();
 
+	if (!latenciesFile.isEmpty())
+	{
+		colorSpace->dumpLatencies(latenciesFile);
+	}
+
 	// ------------------------------------------------------------------------
 	// Cleanup & return
 	// ------------------------------------------------------------------------
+	if (pool != NULL)
+	{
+		// Stop shared threads before deleting processors running in them
+		pool->stop();
+
+		// Per stream statistics are reported once at exit
+		cout << pool->statisticsReport(true).toStdString() << endl;
+
+		for (vector<QcvColorSpaces *>::iterator it = streamProcessors.begin();
+			 it != streamProcessors.end(); ++it)
+		{
+			delete *it;
+		}
+
+		delete colorSpace; // Should quit the procThread if any
+		delete pool; // deletes captures and shared threads
+
+		if (procThread != NULL && procThread != capThread)
+		{
+			delete procThread;
+		}
+
+		return retVal;
+	}
+
 	delete capture; // Should quit the capThread if any
 	delete colorSpace; // Should quit the procThread if any
 
@@ -181,7 +445,19 @@ void usage(char * name)
 		 << "[-d | --device] <device number> "
 		 << "[-v | --video] <video file> "
 		 << "[-s | --size] <width>x<height> "
-		 << "[-m | --mirror]  " << endl
+		 << "[-y | --synthetic] <width>x<height>[@<rate>][:<pattern>] "
+		 << "[--raw] <path>:<width>x<height>[@<rate>] "
+		 << "[--sequence] <glob pattern>[@<rate>] "
+		 << "[-m | --mirror] "
+		 << "[-p | --pool] <threads> "
+		 << "[--bands] <threads> "
+		 << "[--latencies] <json file> "
+		 << "[--xyz-precision] <bits [8..22] | float> "
+		 << "[--idle-time] <ms> "
+		 << "[--check-xyz] "
+		 << "[--compile-palette] <text palette> <binary palette> " << endl
+		 << "\t multiple devices or videos can be provided to open "
+		 << "multiple streams" << endl
 		 << "\t if no argument provided try to open first webcam" << endl
 		 << "Key help : components multiple keystrokes switches from colored "
 		 << "to B&W component display" << endl
@@ -199,5 +475,91 @@ void usage(char * name)
 		 << "\ty : Show lightness image from YCbCr color model" << endl
 		 << "\tu : Show Cr component image from YCbCr color model" << endl
 		 << "\tt : Show Cb component image from YCbCr color model" << endl
+		 << "\ta : Show mosaic of all components" << endl
 		 << "\te : prints this help" << endl;
 }
+
+/*
+ * Checks X, Y and Z components computed by CvColorKernels::xyzComponent
+ * with floating point and each fixed point precision against a double
+ * precision conversion on all 2^24 BGR colors and prints the maximum
+ * error of each precision on standard output
+ * @return true if all components are within 1 LSB of the double precision
+ * conversion, false otherwise
+ */
+bool checkXYZ()
+{
+	// sRGB (D65) to XYZ matrix applied on BGR ordered channels
+	const Matx33d bgr2xyz(0.180423, 0.357580, 0.412453,
+						  0.072169, 0.715160, 0.212671,
+						  0.950227, 0.119193, 0.019334);
+
+	vector<int> precisions;
+	precisions.push_back(CvColorKernels::XYZ_FLOAT);
+	for (int bits = CvColorKernels::XYZ_MIN_BITS;
+		 bits <= CvColorKernels::XYZ_MAX_BITS; bits++)
+	{
+		precisions.push_back(bits);
+	}
+	vector<double> maxErrors(precisions.size(), 0.0);
+
+	// each image contains all green and red levels of a single blue level
+	Mat bgr(256, 256, CV_8UC3);
+	Mat bgrDouble;
+	Mat xyzDouble;
+	Mat xyz;
+	Mat reference[3];
+	Mat component;
+
+	for (int b = 0; b < 256; b++)
+	{
+		for (int g = 0; g < 256; g++)
+		{
+			Vec3b * row = bgr.ptr<Vec3b>(g);
+			for (int r = 0; r < 256; r++)
+			{
+				row[r] = Vec3b((uchar) b, (uchar) g, (uchar) r);
+			}
+		}
+
+		// double precision reference rounded and saturated to 8 bits
+		bgr.convertTo(bgrDouble, CV_64F);
+		transform(bgrDouble, xyzDouble, bgr2xyz);
+		xyzDouble.convertTo(xyz, CV_8U);
+		split(xyz, reference);
+
+		for (size_t p = 0; p < precisions.size(); p++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				CvColorKernels::xyzComponent(bgr, c, precisions[p], component);
+				maxErrors[p] = MAX(maxErrors[p],
+								   norm(component, reference[c], NORM_INF));
+			}
+		}
+	}
+
+	bool success = true;
+	cout << "precision\tmax error (LSB)" << endl;
+	for (size_t p = 0; p < precisions.size(); p++)
+	{
+		if (precisions[p] == CvColorKernels::XYZ_FLOAT)
+		{
+			cout << "float";
+		}
+		else
+		{
+			cout << precisions[p] << " bits";
+		}
+		cout << "\t\t" << maxErrors[p] << endl;
+
+		if (maxErrors[p] > 1.0)
+		{
+			success = false;
+		}
+	}
+
+	cout << "XYZ check " << (success ? "passed" : "failed") << endl;
+
+	return success;
+}
@@ -272,6 +272,9 @@ void MainWindow::setupUIfromProcessor()
 		case CvColorSpaces::Cb:
 			ui->radioButtonCb->setChecked(true);
 			break;
+		case CvColorSpaces::MOSAIC:
+			ui->radioButtonMosaic->setChecked(true);
+			break;
 		case CvColorSpaces::NbSelected:
 		default:
 			// Do nothing
@@ -310,6 +313,17 @@ void MainWindow::setupUIfromProcessor()
 		default:
 			break;
 	}
+
+	// Sets XYZ precision and idle time without notifying processor back
+	int precision = processor->getXYZPrecision();
+	ui->spinBoxXYZBits->blockSignals(true);
+	ui->spinBoxXYZBits->setValue(precision == CvColorKernels::XYZ_FLOAT ?
+		ui->spinBoxXYZBits->minimum() : precision);
+	ui->spinBoxXYZBits->blockSignals(false);
+
+	ui->spinBoxIdleTime->blockSignals(true);
+	ui->spinBoxIdleTime->setValue(MAX(processor->getIdleTime(), -1));
+	ui->spinBoxIdleTime->blockSignals(false);
 }
 
 /*
@@ -373,6 +387,11 @@ void MainWindow::setupProcessorfromUI()
 		processor->setDisplayImageIndex(CvColorSpaces::Cb);
 	}
 
+	if (ui->radioButtonMosaic->isChecked())
+	{
+		processor->setDisplayImageIndex(CvColorSpaces::MOSAIC);
+	}
+
 	if (ui->radioButtonChColor->isChecked())
 	{
 		for (size_t i = 0; i < CvColorSpaces::NbShows; i++)
@@ -720,6 +739,14 @@ void MainWindow::on_radioButtonCb_clicked()
 	processor->setDisplayImageIndex(CvColorSpaces::Cb);
 }
 
+/*
+ * Select mosaic of all components for display
+ */
+void MainWindow::on_radioButtonMosaic_clicked()
+{
+	processor->setDisplayImageIndex(CvColorSpaces::MOSAIC);
+}
+
 /*
  * Select component display as colored image
  */
@@ -799,3 +826,29 @@ void MainWindow::on_radioButtonMaxBGR_clicked()
 	processor->setDisplayImageIndex(CvColorSpaces::MAX_BGR);
 }
 
+/*
+ * Sets the number of fractional bits used to compute XYZ components
+ * @param value the new number of bits (values below
+ * CvColorKernels::XYZ_MIN_BITS select floating point computation)
+ */
+void MainWindow::on_spinBoxXYZBits_valueChanged(int value)
+{
+	if (value < CvColorKernels::XYZ_MIN_BITS)
+	{
+		processor->setXYZPrecision(CvColorKernels::XYZ_FLOAT);
+	}
+	else
+	{
+		processor->setXYZPrecision(value);
+	}
+}
+
+/*
+ * Sets the time after which images of unused stages are released
+ * @param value the new idle time in ms (negative values never
+ * release images)
+ */
+void MainWindow::on_spinBoxIdleTime_valueChanged(int value)
+{
+	processor->setIdleTime(value);
+}
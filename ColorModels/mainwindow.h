@@ -304,6 +304,11 @@ class MainWindow : public QMainWindow
 		 */
 		void on_radioButtonCb_clicked();
 
+		/**
+		 * Select mosaic of all components for display
+		 */
+		void on_radioButtonMosaic_clicked();
+
 		/**
 		 * Select component display as colored image
 		 */
@@ -348,6 +353,20 @@ class MainWindow : public QMainWindow
 		 * Select Maximum of RGB as display
 		 */
 		void on_radioButtonMaxBGR_clicked();
+
+		/**
+		 * Sets the number of fractional bits used to compute XYZ components
+		 * @param value the new number of bits (values below
+		 * CvColorKernels::XYZ_MIN_BITS select floating point computation)
+		 */
+		void on_spinBoxXYZBits_valueChanged(int value);
+
+		/**
+		 * Sets the time after which images of unused stages are released
+		 * @param value the new idle time in ms (negative values never
+		 * release images)
+		 */
+		void on_spinBoxIdleTime_valueChanged(int value);
 };
 
 #endif // MAINWINDOW_H
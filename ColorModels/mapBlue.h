@@ -4,7 +4,7 @@
 /**
  * Color map for RGB blue component color image
  */
-unsigned char mapBlue[256][3] =
+constexpr unsigned char mapBlue[256][3] =
 {
 	{0, 0, 0},
 	{0, 0, 1},
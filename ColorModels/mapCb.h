@@ -5,7 +5,7 @@
  * Color map for YCbCr Cb component color image.
  * Yellow to Blue colormap
  */
-unsigned char mapCb[256][3] =
+constexpr unsigned char mapCb[256][3] =
 {
 	{255, 255, 0},
 	{254, 254, 1},
@@ -5,7 +5,7 @@
  * Color map for YCbCr Cr component color image.
  * Green to Magenta colormap
  */
-unsigned char mapCr[256][3] =
+constexpr unsigned char mapCr[256][3] =
 {
 	{0, 255, 0},
 	{1, 254, 1},
@@ -4,7 +4,7 @@
 /**
  * Color map for RGB green component color image
  */
-unsigned char mapGreen[256][3] =
+constexpr unsigned char mapGreen[256][3] =
 {
 	{0, 0, 0},
 	{0, 1, 0},
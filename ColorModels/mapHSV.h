@@ -6,7 +6,7 @@
  * Color circle colormap starting with red, yellow, green, cyan, blue, magenta,
  * and red again.
  */
-unsigned char mapHSV[256][3] =
+constexpr unsigned char mapHSV[256][3] =
 {
 	{255, 0, 0},
 	{255, 6, 0},
@@ -4,7 +4,7 @@
 /**
  * Color map for RGB red component color image
  */
-unsigned char mapRed[256][3] =
+constexpr unsigned char mapRed[256][3] =
 {
 	{0, 0, 0},
 	{1, 0, 0},
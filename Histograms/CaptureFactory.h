@@ -11,13 +11,52 @@
 #include <QString>
 #include <QStringList>
 #include <QThread>
+#include <QList>
 #include "QcvVideoCapture.h"
+#include "QcvCapturePool.h"
 
 /**
  * Capture Factory creates QcvVideoCapture from arguments list
  */
 class CaptureFactory
 {
+	public:
+		/**
+		 * Stream source types
+		 */
+		typedef enum
+		{
+			DEVICE_SOURCE = 0,	//!< camera device
+			FILE_SOURCE,		//!< video file or URL
+			SYNTHETIC_SOURCE,	//!< synthetic frames (@see CvSyntheticCapture)
+			RAW_SOURCE,			//!< raw frames file (@see CvRawCapture)
+			SEQUENCE_SOURCE,	//!< images sequence (@see CvImageSequenceCapture)
+			NBSOURCETYPES
+		} SourceType;
+
+		/**
+		 * Stream source description
+		 */
+		typedef struct
+		{
+			/**
+			 * Source type
+			 */
+			SourceType type;
+
+			/**
+			 * Device number when #type is DEVICE_SOURCE
+			 */
+			int deviceNumber;
+
+			/**
+			 * Path to video file when #type is FILE_SOURCE or
+			 * specification when #type is SYNTHETIC_SOURCE, RAW_SOURCE or
+			 * SEQUENCE_SOURCE
+			 */
+			QString path;
+		} StreamSource;
+
 	protected:
 		/**
 		 * The capture instance to create
@@ -73,6 +112,38 @@ class CaptureFactory
 		 */
 		QString videoPath;
 
+		/**
+		 * Indicates capture uses a frame source (synthetic frames, raw
+		 * frames file or images sequence) rather than camera or
+		 * file. Default value is false
+		 */
+		bool frameSourceVideo;
+
+		/**
+		 * Frame source type when #frameSourceVideo is true
+		 */
+		SourceType frameSourceType;
+
+		/**
+		 * Frame source specification
+		 * @see CvSyntheticCapture::parse
+		 * @see CvRawCapture::parse
+		 * @see CvImageSequenceCapture::parse
+		 */
+		QString frameSourceSpec;
+
+		/**
+		 * All sources found in arguments list (each -d or -v argument adds
+		 * a new source) used to open multiple streams
+		 */
+		QList<StreamSource> sources;
+
+		/**
+		 * Number of threads shared among captures in multi-stream mode.
+		 * Default value is QThread::idealThreadCount()
+		 */
+		int poolThreads;
+
 	public:
 		/**
 		 * Capture Factory constructor.
@@ -82,6 +153,13 @@ class CaptureFactory
 		 * 	- [-m | --mirror] : flip image horizontally
 		 * 	- [-g | --gray] : convert to gray level
 		 * 	- [-s | --size] <width>x<height>: preferred width and height
+		 * 	- [-p | --pool] <threads> : number of threads shared among
+		 * 	streams when multiple devices or files are provided
+		 * 	- [-y | --synthetic] <width>x<height>[@<rate>][:<pattern>] :
+		 * 	synthetic frames (patterns are gradient, noise or moving), a
+		 * 	missing or 0 rate means unthrottled
+		 * 	- --raw <path>:<width>x<height>[@<rate>] : raw BGR frames file
+		 * 	- --sequence <glob pattern>[@<rate>] : images sequence
 		 * @param argList program the argument list provided as a list of
 		 * strings
 		 */
@@ -111,6 +189,27 @@ class CaptureFactory
 		 */
 		void setFile(const QString & path);
 
+		/**
+		 * Set synthetic frames specification and use synthetic frames
+		 * @param spec the synthetic frames specification
+		 * <width>x<height>[@<rate>][:<pattern>]
+		 */
+		void setSynthetic(const QString & spec);
+
+		/**
+		 * Set raw frames file specification and use raw frames file
+		 * @param spec the raw frames specification
+		 * <path>:<width>x<height>[@<rate>]
+		 */
+		void setRaw(const QString & spec);
+
+		/**
+		 * Set images sequence specification and use images sequence
+		 * @param spec the images sequence specification
+		 * <glob pattern>[@<rate>]
+		 */
+		void setSequence(const QString & spec);
+
 		/**
 		 * Set video horizontal flip state (useful for selfies)
 		 * @param flipped the horizontal flip state
@@ -147,12 +246,53 @@ class CaptureFactory
 
 		/**
 		 * Provide capture instanciated according to values
-		 * extracted from argument lists
+		 * extracted from argument lists : the first stream when several
+		 * streams are provided
 		 * @param updateThread the thread to run this capture or NULL if this
 		 * capture run in the current thread
 		 * @return the new capture instance
 		 */
 		QcvVideoCapture * getCaptureInstance(QThread * updatethread = NULL);
+
+		/**
+		 * Set number of threads shared among captures in multi-stream mode
+		 * @param nbThreads the number of threads (0 to update all captures
+		 * in the current thread)
+		 */
+		void setPoolThreads(const int nbThreads);
+
+		/**
+		 * Number of streams found in arguments list
+		 * @return the number of streams to open (at least 1)
+		 */
+		int getNbStreams() const;
+
+		/**
+		 * Provide capture instanciated for a specific stream
+		 * @param index the index of the stream in #sources
+		 * @param updateThread the thread to run this capture or NULL if this
+		 * capture run in the current thread
+		 * @return the new capture instance
+		 */
+		QcvVideoCapture * getStreamInstance(const int index,
+											QThread * updateThread);
+
+		/**
+		 * Provide a capture pool containing one capture per stream found in
+		 * arguments list running on #poolThreads shared threads.
+		 * @return a new capture pool (to be deleted by the caller)
+		 */
+		QcvCapturePool * getCapturePool();
+
+	protected:
+		/**
+		 * Creates a new capture instance
+		 * @param source the source to open
+		 * @param updateThread the thread to run this capture or NULL
+		 * @return the new capture instance or NULL if source is invalid
+		 */
+		QcvVideoCapture * createCapture(const StreamSource & source,
+										QThread * updateThread);
 };
 
 #endif /* CAPTUREFACTORY_H_ */
@@ -0,0 +1,185 @@
+/*
+ * CvFrameSource.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVFRAMESOURCE_H_
+#define CVFRAMESOURCE_H_
+
+#include <opencv2/core/core.hpp>	// for Mat
+#include <opencv2/highgui/highgui.hpp>	// for VideoCapture
+using namespace cv;
+
+/**
+ * Base class for frame sources which are not cameras or codec based video
+ * files (synthetic frames, raw dumps, images sequences...).
+ * Frame sources are VideoCapture so they can be used wherever a
+ * VideoCapture is used (e.g. into QcvVideoCapture): all VideoCapture
+ * virtual methods are reimplemented to serve frames provided by sub classes
+ * through #fetchFrame.
+ * Frame sources never run out of frames: when a finite source reaches its
+ * last frame it loops back to the first one, so no rewind is needed.
+ * Frames are indexed from 0 so random access is possible through
+ * CV_CAP_PROP_POS_FRAMES.
+ */
+class CvFrameSource : public VideoCapture
+{
+	protected:
+		/**
+		 * Source opened state
+		 */
+		bool opened;
+
+		/**
+		 * Target frame rate (in frames per second) or 0 for unthrottled
+		 * sources which should be read as fast as possible.
+		 */
+		double frameRate;
+
+		/**
+		 * Index of the next frame to grab
+		 */
+		long frameIndex;
+
+		/**
+		 * Frames size
+		 */
+		Size frameSize;
+
+		/**
+		 * Frames type (CV_8UC3 by default)
+		 */
+		int frameType;
+
+		/**
+		 * Indicates #frameSize has changed since last #setup so frames
+		 * need to be reallocated before next grab
+		 */
+		bool sizeChanged;
+
+		/**
+		 * Header to last grabbed frame, set by #fetchFrame (might point to
+		 * data owned by sub classes)
+		 */
+		Mat frame;
+
+		/**
+		 * Indicates retrieved images are headers to #frame data rather than
+		 * copies. When false, frames are copied into retrieved images,
+		 * which keeps retrieved images buffers stable across frames.
+		 */
+		bool zeroCopy;
+
+	public:
+		/**
+		 * Frame source constructor
+		 * @param size frames size
+		 * @param frameRate target frame rate or 0 for unthrottled source
+		 * @param type frames type
+		 */
+		CvFrameSource(const Size & size = Size(0, 0),
+					  const double frameRate = 0.0,
+					  const int type = CV_8UC3);
+
+		/**
+		 * Frame source destructor
+		 */
+		virtual ~CvFrameSource();
+
+		/**
+		 * Opened state
+		 * @return true if this source has been set up and can provide frames
+		 */
+		virtual bool isOpened() const;
+
+		/**
+		 * Release this source
+		 */
+		virtual void release();
+
+		/**
+		 * Grabs next frame from this source
+		 * @return true if next frame has been fetched
+		 */
+		virtual bool grab();
+
+		/**
+		 * Retrieves last grabbed frame
+		 * @param image the image to fill with last grabbed frame
+		 * @param channel unused
+		 * @return true if a frame has been grabbed before
+		 */
+		virtual bool retrieve(Mat & image, int channel = 0);
+
+		/**
+		 * Grabs and retrieves next frame
+		 * @param image the image to fill with next frame
+		 * @return true if next frame has been grabbed and retrieved
+		 */
+		virtual bool read(Mat & image);
+
+		/**
+		 * Grabs and retrieves next frame
+		 * @param image the image to fill with next frame
+		 * @return a reference to this source
+		 */
+		virtual VideoCapture & operator >>(Mat & image);
+
+		/**
+		 * Sets a property on this source. Supported properties are
+		 * 	- CV_CAP_PROP_POS_FRAMES : index of the next frame to grab
+		 * 	- CV_CAP_PROP_FRAME_WIDTH : frames width (if #isResizable)
+		 * 	- CV_CAP_PROP_FRAME_HEIGHT : frames height (if #isResizable)
+		 * 	- CV_CAP_PROP_FPS : target frame rate
+		 * @param propId the property id
+		 * @param value the property value
+		 * @return true if property has been set
+		 */
+		virtual bool set(int propId, double value);
+
+		/**
+		 * Gets a property of this source. Supported properties are
+		 * 	- CV_CAP_PROP_POS_FRAMES : index of the next frame to grab
+		 * 	- CV_CAP_PROP_FRAME_COUNT : number of frames or -1 if infinite
+		 * 	- CV_CAP_PROP_FRAME_WIDTH : frames width
+		 * 	- CV_CAP_PROP_FRAME_HEIGHT : frames height
+		 * 	- CV_CAP_PROP_FPS : target frame rate (0 when unthrottled)
+		 * @param propId the property id
+		 * @return the property value or 0 if property is not supported
+		 */
+		virtual double get(int propId);
+
+		/**
+		 * Number of frames of this source
+		 * @return the number of frames of this source or -1 if this source
+		 * is infinite
+		 */
+		virtual long getFrameCount() const;
+
+		/**
+		 * Indicates frames size can be changed through
+		 * CV_CAP_PROP_FRAME_WIDTH and CV_CAP_PROP_FRAME_HEIGHT
+		 * @return true if frames size can be changed
+		 */
+		virtual bool isResizable() const;
+
+	protected:
+		/**
+		 * Setup this source for current #frameSize and #frameType.
+		 * Called before grabbing when #sizeChanged is true.
+		 * @return true if source has been set up successfully
+		 */
+		virtual bool setup() = 0;
+
+		/**
+		 * Fetch frame at index into #frame
+		 * @param index the index of the frame to fetch (between 0 and
+		 * #getFrameCount() - 1 for finite sources)
+		 * @return true if frame has been fetched
+		 */
+		virtual bool fetchFrame(const long index) = 0;
+};
+
+#endif /* CVFRAMESOURCE_H_ */
@@ -0,0 +1,288 @@
+/*
+ * CvSyntheticCapture.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include <cstdio>	// for sscanf
+#include <cmath>	// for cos, sin
+#include <iostream>	// for cerr
+#include <algorithm>	// for min, max
+using namespace std;
+
+#include <opencv2/core/core.hpp>	// for RNG, circle
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "CvSyntheticCapture.h"
+
+/*
+ * Default maximum number of frames in the pool
+ */
+const size_t CvSyntheticCapture::defaultPoolSize = 64;
+
+/*
+ * Maximum number of bytes used by the frames pool : 32 MB, i.e. about
+ * 34 frames in 640x480 or 5 frames in 1920x1080
+ */
+const size_t CvSyntheticCapture::poolBudget = 32 * 1024 * 1024;
+
+/*
+ * Patterns names used by parse
+ */
+const char * CvSyntheticCapture::patternNames[NBPATTERNS] =
+{
+	"gradient",
+	"noise",
+	"moving"
+};
+
+/*
+ * Synthetic capture constructor
+ * @param size frames size
+ * @param frameRate target frame rate or 0 for unthrottled capture
+ * @param pattern the pattern to generate
+ * @param poolSize maximum number of distinct frames to generate
+ * (limited by #poolBudget)
+ * @param seed random seed used by NOISE pattern
+ */
+CvSyntheticCapture::CvSyntheticCapture(const Size & size,
+									   const double frameRate,
+									   const Pattern pattern,
+									   const size_t poolSize,
+									   const uint64 seed) :
+	CvFrameSource(size, frameRate, CV_8UC3),
+	pattern(pattern),
+	pool(),
+	maxPoolSize(poolSize > 0 ? poolSize : 1),
+	poolSize(1),
+	seed(seed)
+{
+	// No dynamic links in constructors, so setup is called here
+	opened = setup();
+	sizeChanged = false;
+}
+
+/*
+ * Synthetic capture destructor
+ */
+CvSyntheticCapture::~CvSyntheticCapture()
+{
+	for (vector<Mat>::iterator it = pool.begin(); it != pool.end(); ++it)
+	{
+		it->release();
+	}
+	pool.clear();
+}
+
+/*
+ * Pattern accessor
+ * @return the current pattern
+ */
+CvSyntheticCapture::Pattern CvSyntheticCapture::getPattern() const
+{
+	return pattern;
+}
+
+/*
+ * Synthetic frames can be resized
+ * @return true
+ */
+bool CvSyntheticCapture::isResizable() const
+{
+	return true;
+}
+
+/*
+ * Parse synthetic capture specification
+ * <width>x<height>[@<rate>][:<pattern>]
+ * @param spec the specification to parse
+ * @param size the parsed frames size
+ * @param frameRate the parsed frame rate
+ * @param pattern the parsed pattern
+ * @return true if specification has been parsed successfully
+ */
+bool CvSyntheticCapture::parse(const string & spec,
+							   Size & size,
+							   double & frameRate,
+							   Pattern & pattern)
+{
+	int width = 0;
+	int height = 0;
+	double rate = 0.0;
+	Pattern parsedPattern = MOVING;
+
+	if (sscanf(spec.c_str(), "%dx%d", &width, &height) != 2 ||
+		width <= 0 || height <= 0)
+	{
+		cerr << "CvSyntheticCapture::parse: invalid size in " << spec << endl;
+		return false;
+	}
+
+	size_t atPos = spec.find('@');
+	size_t colonPos = spec.find(':');
+
+	if (atPos != string::npos)
+	{
+		if (sscanf(spec.c_str() + atPos + 1, "%lf", &rate) != 1 || rate < 0.0)
+		{
+			cerr << "CvSyntheticCapture::parse: invalid rate in " << spec
+				 << endl;
+			return false;
+		}
+	}
+
+	if (colonPos != string::npos)
+	{
+		string name = spec.substr(colonPos + 1);
+		bool found = false;
+		for (int i = 0; i < NBPATTERNS; i++)
+		{
+			if (name == patternNames[i])
+			{
+				parsedPattern = (Pattern) i;
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			cerr << "CvSyntheticCapture::parse: unknown pattern " << name
+				 << endl;
+			return false;
+		}
+	}
+
+	size = Size(width, height);
+	frameRate = rate;
+	pattern = parsedPattern;
+
+	return true;
+}
+
+/*
+ * Pattern name
+ * @param pattern the pattern
+ * @return the name of the pattern
+ */
+const char * CvSyntheticCapture::patternName(const Pattern pattern)
+{
+	if (pattern >= 0 && pattern < NBPATTERNS)
+	{
+		return patternNames[pattern];
+	}
+
+	return "unknown";
+}
+
+/*
+ * Allocates and fills frames pool for current size
+ * @return true if frames pool has been generated
+ */
+bool CvSyntheticCapture::setup()
+{
+	if (frameSize.width <= 0 || frameSize.height <= 0)
+	{
+		cerr << "CvSyntheticCapture::setup: invalid size " << frameSize.width
+			 << "x" << frameSize.height << endl;
+		return false;
+	}
+
+	frame.release();
+
+	// Pool size limited by memory budget for current frames size
+	const size_t frameBytes = (size_t) frameSize.area() *
+		CV_ELEM_SIZE(frameType);
+	poolSize = std::max((size_t) 1,
+						std::min(maxPoolSize, poolBudget / frameBytes));
+
+	pool.resize(poolSize);
+
+	for (size_t i = 0; i < poolSize; i++)
+	{
+		pool[i].create(frameSize, frameType);
+		generate(i, pool[i]);
+	}
+
+	return true;
+}
+
+/*
+ * Fetch frame at index from frames pool
+ * @param index the index of the frame to fetch
+ * @return true
+ */
+bool CvSyntheticCapture::fetchFrame(const long index)
+{
+	frame = pool[(size_t) index % poolSize];
+
+	return true;
+}
+
+/*
+ * Generates pool frame
+ * @param index index of the frame in the pool
+ * @param image the image to fill
+ */
+void CvSyntheticCapture::generate(const size_t index, Mat & image) const
+{
+	const int width = image.cols;
+	const int height = image.rows;
+	// phase in [0..256[ so that last frame loops smoothly to the first one
+	const int phase = (int) ((index * 256) / poolSize);
+
+	switch (pattern)
+	{
+		case NOISE:
+		{
+			// one generator per frame so frames do not depend on generation
+			// order
+			RNG rng(seed + (uint64) index + 1);
+			rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+			break;
+		}
+		case GRADIENT:
+		case MOVING:
+		default:
+		{
+			for (int y = 0; y < height; y++)
+			{
+				uchar * row = image.ptr<uchar>(y);
+				const int g = (y * 255) / (height > 1 ? height - 1 : 1);
+				for (int x = 0; x < width; x++, row += 3)
+				{
+					const int b = (x * 255) / (width > 1 ? width - 1 : 1);
+					row[0] = (uchar) ((b + phase) & 0xFF);
+					row[1] = (uchar) g;
+					row[2] = (uchar) ((255 - b + g / 2 + 2 * phase) & 0xFF);
+				}
+			}
+
+			if (pattern == MOVING)
+			{
+				// vertical bars moving one period over the pool
+				const int period = MAX(width / 8, 2);
+				const int offset = (int) ((index * period) / poolSize);
+				for (int y = 0; y < height; y++)
+				{
+					uchar * row = image.ptr<uchar>(y);
+					for (int x = 0; x < width; x++, row += 3)
+					{
+						if (((x + offset) % period) < period / 4)
+						{
+							row[0] = row[1] = row[2] = 255;
+						}
+					}
+				}
+
+				// disc moving along an ellipse
+				const double angle = (2.0 * CV_PI * index) / poolSize;
+				const int radius = MAX(MIN(width, height) / 10, 1);
+				Point center((int) (width / 2 + (width / 3) * cos(angle)),
+							 (int) (height / 2 + (height / 3) * sin(angle)));
+				circle(image, center, radius, Scalar(0, 0, 0), -1);
+			}
+			break;
+		}
+	}
+}
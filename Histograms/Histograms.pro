@@ -32,6 +32,11 @@ MODULES = CvProcessor \
 	QcvMatWidgetGL \
 	QGLImageRender \
 	QcvVideoCapture \
+	QcvCapturePool \
+	CvFrameSource \
+	CvSyntheticCapture \
+	CvRawCapture \
+	CvImageSequenceCapture \
 	CaptureFactory \
 	mainwindow
 for(f, MODULES){
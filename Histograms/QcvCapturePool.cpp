@@ -0,0 +1,277 @@
+/*
+ * QcvCapturePool.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include <QDebug>
+
+#include "QcvCapturePool.h"
+
+/*
+ * Capture pool constructor
+ * @param nbThreads the number of worker threads to share among
+ * captures. 0 means captures are updated in the current thread.
+ * @param parent the parent QObject
+ */
+QcvCapturePool::QcvCapturePool(const size_t nbThreads, QObject * parent) :
+	QObject(parent),
+	threadIndex(0),
+	reportTimer(new QTimer(this)),
+	stopped(false)
+{
+	for (size_t i = 0; i < nbThreads; i++)
+	{
+		threads.push_back(new QThread());
+	}
+
+	connect(reportTimer, SIGNAL(timeout()), SLOT(report()));
+}
+
+/*
+ * Capture pool destructor.
+ * Stops worker threads, then deletes captures and threads
+ */
+QcvCapturePool::~QcvCapturePool()
+{
+	reportTimer->stop();
+
+	// captures destructors wait for their thread so threads should be
+	// stopped first
+	stop();
+
+	for (vector<QcvVideoCapture *>::iterator it = captures.begin();
+		 it != captures.end(); ++it)
+	{
+		delete *it;
+	}
+	captures.clear();
+
+	for (vector<QThread *>::iterator it = threads.begin();
+		 it != threads.end(); ++it)
+	{
+		delete *it;
+	}
+	threads.clear();
+}
+
+/*
+ * Number of worker threads accessor
+ * @return the number of worker threads
+ */
+size_t QcvCapturePool::getNbThreads() const
+{
+	return threads.size();
+}
+
+/*
+ * Number of streams accessor
+ * @return the number of captures in this pool
+ */
+size_t QcvCapturePool::getNbStreams() const
+{
+	return captures.size();
+}
+
+/*
+ * Provides the thread the next capture should be run in
+ * (round robin among worker threads)
+ * @return the next worker thread or NULL if this pool has no threads
+ */
+QThread * QcvCapturePool::nextThread()
+{
+	if (threads.empty())
+	{
+		return NULL;
+	}
+
+	QThread * thread = threads[threadIndex];
+	threadIndex = (threadIndex + 1) % threads.size();
+
+	return thread;
+}
+
+/*
+ * Adds a capture to this pool. The pool takes ownership of the capture.
+ * @param capture the capture to add
+ */
+void QcvCapturePool::addCapture(QcvVideoCapture * capture)
+{
+	if (capture == NULL)
+	{
+		qWarning("QcvCapturePool::addCapture: NULL capture");
+		return;
+	}
+
+	QThread * thread = capture->getUpdateThread();
+	if (thread != NULL)
+	{
+		// A finished stream should not quit a thread shared with others
+		disconnect(capture, SIGNAL(finished()), thread, SLOT(quit()));
+	}
+
+	captures.push_back(capture);
+}
+
+/*
+ * Capture accessor
+ * @param index the index of the stream
+ * @return the capture at this index or NULL if index is out of bounds
+ */
+QcvVideoCapture * QcvCapturePool::getCapture(const size_t index) const
+{
+	if (index < captures.size())
+	{
+		return captures[index];
+	}
+
+	qWarning("QcvCapturePool::getCapture: index %lu out of bounds",
+			 (unsigned long) index);
+	return NULL;
+}
+
+/*
+ * Per stream statistics accessor
+ * @param index the index of the stream
+ * @return the statistics of this stream
+ */
+QcvVideoCapture::Statistics
+QcvCapturePool::getStatistics(const size_t index) const
+{
+	QcvVideoCapture * capture = getCapture(index);
+	if (capture != NULL)
+	{
+		return capture->getStatistics();
+	}
+
+	QcvVideoCapture::Statistics empty = {0, 0, 0.0, 0.0};
+	return empty;
+}
+
+/*
+ * Aggregate statistics of all streams: frames counts and frame rates
+ * are summed, latency is averaged over streams
+ * @return the aggregate statistics
+ */
+QcvVideoCapture::Statistics QcvCapturePool::getAggregateStatistics() const
+{
+	QcvVideoCapture::Statistics total = {0, 0, 0.0, 0.0};
+
+	for (vector<QcvVideoCapture *>::const_iterator it = captures.begin();
+		 it != captures.end(); ++it)
+	{
+		QcvVideoCapture::Statistics stats = (*it)->getStatistics();
+		total.grabbedFrames += stats.grabbedFrames;
+		total.droppedFrames += stats.droppedFrames;
+		total.frameRate += stats.frameRate;
+		total.latency += stats.latency;
+	}
+
+	if (!captures.empty())
+	{
+		total.latency /= (double) captures.size();
+	}
+
+	return total;
+}
+
+/*
+ * Builds a text report of aggregate and per stream statistics
+ * @param perStream include per stream statistics
+ * @return the statistics report
+ */
+QString QcvCapturePool::statisticsReport(const bool perStream) const
+{
+	QString report;
+	QcvVideoCapture::Statistics total = getAggregateStatistics();
+
+	report.sprintf("%lu streams on %lu threads: %5.1f fps, %lu dropped, "
+				   "%5.2f ms latency",
+				   (unsigned long) captures.size(),
+				   (unsigned long) threads.size(),
+				   total.frameRate,
+				   (unsigned long) total.droppedFrames,
+				   total.latency);
+
+	if (perStream)
+	{
+		for (size_t i = 0; i < captures.size(); i++)
+		{
+			QcvVideoCapture::Statistics stats = captures[i]->getStatistics();
+			QString line;
+			line.sprintf("\n\t#%lu: %5.1f fps, %lu grabbed, %lu dropped, "
+						 "%5.2f ms latency",
+						 (unsigned long) i,
+						 stats.frameRate,
+						 (unsigned long) stats.grabbedFrames,
+						 (unsigned long) stats.droppedFrames,
+						 stats.latency);
+			report.append(line);
+		}
+	}
+
+	return report;
+}
+
+/*
+ * Stops (quit and wait) all worker threads.
+ */
+void QcvCapturePool::stop()
+{
+	if (stopped)
+	{
+		return;
+	}
+
+	for (vector<QThread *>::iterator it = threads.begin();
+		 it != threads.end(); ++it)
+	{
+		(*it)->quit();
+	}
+
+	for (vector<QThread *>::iterator it = threads.begin();
+		 it != threads.end(); ++it)
+	{
+		(*it)->wait();
+	}
+
+	stopped = true;
+}
+
+/*
+ * Sets statistics report interval
+ * @param interval the interval between reports in ms or 0 to stop
+ * reporting
+ */
+void QcvCapturePool::setReportInterval(const int interval)
+{
+	if (interval > 0)
+	{
+		reportTimer->start(interval);
+	}
+	else
+	{
+		reportTimer->stop();
+	}
+}
+
+/*
+ * Resets statistics of all streams
+ */
+void QcvCapturePool::resetStatistics()
+{
+	for (vector<QcvVideoCapture *>::iterator it = captures.begin();
+		 it != captures.end(); ++it)
+	{
+		(*it)->resetStatistics();
+	}
+}
+
+/*
+ * Emits messageChanged with aggregate statistics report
+ */
+void QcvCapturePool::report()
+{
+	emit messageChanged(statisticsReport(false), reportTimer->interval());
+}
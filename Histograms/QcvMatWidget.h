@@ -12,6 +12,13 @@
 #include <QHBoxLayout>
 #include <QMouseEvent>
 #include <QPoint>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QResizeEvent>
+
+#include <vector>
+#include <algorithm>
+using namespace std;
 
 #include <opencv/cv.h>
 using namespace cv;
@@ -132,6 +139,86 @@ class QcvMatWidget : public QWidget
 		 */
 		static const int drawingWidth;
 
+		/**
+		 * Indicates source image has been updated since the last conversion
+		 * to #displayImage. Conversion is deferred until next paint so
+		 * several source updates between two paints only cost one conversion
+		 */
+		bool frameDirty;
+
+		/**
+		 * Single shot timer used to coalesce repaints so that the widget is
+		 * painted at most once per display interval
+		 * @see #displayRate
+		 */
+		QTimer * refreshTimer;
+
+		/**
+		 * Time elapsed since last paint
+		 */
+		QElapsedTimer paintClock;
+
+		/**
+		 * Maximum display refresh rate (in frames per second).
+		 * 0 means the refresh rate of the screen is used
+		 */
+		double displayRate;
+
+		/**
+		 * Default display refresh rate : 0 (screen refresh rate)
+		 */
+		static double defaultDisplayRate;
+
+		/**
+		 * Refresh rate to use when screen refresh rate is unknown
+		 */
+		static double fallbackDisplayRate;
+
+		/**
+		 * Number of frames converted and painted
+		 */
+		size_t paintedFrames;
+
+		/**
+		 * Number of source updates which have been coalesced with a later
+		 * update and hence never converted nor painted
+		 */
+		size_t skippedFrames;
+
+		/**
+		 * Indicates the display image can be a downscaled preview of the
+		 * source image fitting the widget size rather than a full resolution
+		 * copy. Only relevant for sub classes scaling display image to the
+		 * widget size (such as QcvMatWidgetImage).
+		 * Default value is false
+		 */
+		bool previewEnabled;
+
+		/**
+		 * Integer box filter downscale factor used to build the display
+		 * image from the source image (1 means no downscale)
+		 */
+		int previewFactor;
+
+		/**
+		 * Scale fitting the whole source image into the widget when
+		 * display image is a preview (< 1), 1 otherwise. Display image is
+		 * downscaled by #previewFactor then drawn into #previewRect which
+		 * performs the remaining (less than 2) downscale.
+		 */
+		double previewScale;
+
+		/**
+		 * Indicates #previewFactor is valid for the current widget size
+		 * and source image size. Invalidated on resize or source change.
+		 */
+		bool previewValid;
+
+		/**
+		 * Row sums buffer used by the box filter downscale
+		 */
+		vector<int> previewSums;
+
 //		size_t count;
 
 	public:
@@ -186,6 +273,31 @@ class QcvMatWidget : public QWidget
 		 */
 		bool isMouseDragable() const;
 
+		/**
+		 * Gets the maximum display refresh rate
+		 * @return the maximum display refresh rate in frames per second or 0
+		 * if screen refresh rate is used
+		 */
+		double getDisplayRate() const;
+
+		/**
+		 * Number of frames converted and painted since last counters reset
+		 * @return the number of painted frames
+		 */
+		size_t getPaintedFrames() const;
+
+		/**
+		 * Number of source updates which have been coalesced (hence never
+		 * converted nor painted) since last counters reset
+		 * @return the number of skipped frames
+		 */
+		size_t getSkippedFrames() const;
+
+		/**
+		 * Reset painted and skipped frames counters
+		 */
+		void resetFrameCounters();
+
 	protected:
 
 		/**
@@ -210,6 +322,53 @@ class QcvMatWidget : public QWidget
 		 */
 		void convertImage();
 
+		/**
+		 * Computes #previewScale and #previewFactor from current widget
+		 * size and source image size if they are not valid anymore
+		 * @post #previewValid is true
+		 */
+		void updatePreviewFactor();
+
+		/**
+		 * Area of the widget where display image is drawn : the source
+		 * image size scaled by #previewScale (keeping its aspect ratio)
+		 * for a preview, or the display image size otherwise
+		 * @return the display image area in widget coordinates
+		 */
+		QRect previewRect() const;
+
+		/**
+		 * Resize event reimplemented to invalidate downscaled preview
+		 * @param event the resize event
+		 */
+		virtual void resizeEvent(QResizeEvent * event);
+
+		/**
+		 * Box filter downscale fused with conversion to RGB:
+		 * each factor x factor block of the BGR or gray source image is
+		 * averaged and written as a single RGB pixel of the destination.
+		 * @param src the BGR or gray source image (CV_8UC3 or CV_8UC1)
+		 * @param dst the RGB destination image (CV_8UC3) of size
+		 * src.size() / factor rounded up : last blocks of rows and
+		 * columns may be partial and are averaged over their actual size
+		 * @param factor the integer downscale factor
+		 * @param sums row sums buffer
+		 */
+		static void downscaleToRGB(const Mat & src,
+								   Mat & dst,
+								   const int factor,
+								   vector<int> & sums);
+
+		/**
+		 * Maps a point in widget coordinates to display image coordinates
+		 * (which differ when display image is a downscaled preview
+		 * drawn into #previewRect : the per axis display image to
+		 * preview area ratio is used)
+		 * @param p the point in widget coordinates
+		 * @return the point in display image coordinates
+		 */
+		Point toDisplayPoint(const QPoint & p) const;
+
 		/**
 		 * Callback called when mouse button pressed event occurs.
 		 * reimplemented to send pressPoint signal when left mouse button is
@@ -259,6 +418,26 @@ class QcvMatWidget : public QWidget
 		 */
 		void selectionRectFromPoints(const QPoint & p1, const QPoint & p2);
 
+		/**
+		 * Minimum interval between two paints according to #displayRate
+		 * @return the minimum interval between two paints in ms
+		 */
+		int displayInterval() const;
+
+		/**
+		 * Converts source image into display image if it has been updated
+		 * since last conversion
+		 * @post #frameDirty is false
+		 */
+		void convertIfDirty();
+
+	protected slots:
+		/**
+		 * Refresh slot triggered by #refreshTimer : schedules an actual
+		 * repaint of the widget
+		 */
+		void refresh();
+
 	public slots:
 		/**
 		 * Sets new source image
@@ -269,12 +448,21 @@ class QcvMatWidget : public QWidget
 		virtual void setSourceImage(Mat * sourceImage);
 
 		/**
-		 * Update slot customized to include convertImage before actually
-		 * updating
-		 * @post sourceImage have been converted to RGB and widget updated
+		 * Update slot customized to mark source image as updated and
+		 * schedule a repaint. Conversion of the source image is deferred
+		 * until paint time, and repaints are coalesced so that the widget
+		 * is painted at most once per display interval.
+		 * @post sourceImage is marked dirty and a repaint has been scheduled
 		 */
 		virtual void update();
 
+		/**
+		 * Sets the maximum display refresh rate
+		 * @param rate the maximum number of paints per second or 0 to use
+		 * the screen refresh rate
+		 */
+		void setDisplayRate(const double rate);
+
 	signals:
 
 		/**
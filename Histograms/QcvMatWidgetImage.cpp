@@ -46,13 +46,21 @@ void QcvMatWidgetImage::setup()
 //	qDebug("QcvMatWidgetImage::Setup");
 
 	/*
-	 * Customize size policy
+	 * Customize size policy : preferred size is the source image size
+	 * but widget may shrink (e.g. in a resizable scroll area) in which
+	 * case a downscaled preview is displayed
 	 */
-	QSizePolicy qsp(QSizePolicy::Fixed, QSizePolicy::Fixed);
+	QSizePolicy qsp(QSizePolicy::Preferred, QSizePolicy::Preferred);
 	// sets height depends on width (also need to reimplement heightForWidth())
 	qsp.setHeightForWidth(true);
 	setSizePolicy(qsp);
 
+	/*
+	 * Display image is scaled to widget size so it can be a downscaled
+	 * preview of the source image when widget is smaller than source
+	 */
+	previewEnabled = true;
+
 	/*
 	 * Customize layout
 	 */
@@ -78,19 +86,37 @@ QcvMatWidgetImage::~QcvMatWidgetImage()
  */
 void QcvMatWidgetImage::setSourceImage(Mat * sourceImage)
 {
+	// setup and convert image
+	QcvMatWidget::setSourceImage(sourceImage);
+	convertIfDirty();
+	updateQImage();
+
+	// re-setup geometry since height x width may have changed
+	updateGeometry();
+}
+
+/*
+ * (Re)builds qImage around displayImage whenever display image
+ * has been reallocated
+ */
+void QcvMatWidgetImage::updateQImage()
+{
+	if ((qImage != NULL) &&
+		(qImage->constBits() == displayImage.data) &&
+		(qImage->width() == displayImage.cols) &&
+		(qImage->height() == displayImage.rows))
+	{
+		return;
+	}
+
 	if (qImage != NULL)
 	{
 		delete qImage;
 	}
-	// setup and convert image
-	QcvMatWidget::setSourceImage(sourceImage);
-	convertImage();
+
 	qImage = new QImage((uchar *) displayImage.data, displayImage.cols,
 		displayImage.rows, displayImage.step,
 		QImage::Format_RGB888);
-
-	// re-setup geometry since height x width may have changed
-	updateGeometry();
 }
 
 /*
@@ -138,10 +164,18 @@ void QcvMatWidgetImage::paintEvent(QPaintEvent *event)
 
 	if (displayImage.data != NULL)
 	{
+		// display image might have been reallocated by preview downscale
+		updateQImage();
+
 		// then draw image
 		QPainter painter(this);
 		painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-		if (event == NULL)
+		if (previewScale < 1.0)
+		{
+			// downscaled preview is drawn at source aspect ratio
+			painter.drawImage(previewRect(), *qImage);
+		}
+		else if (event == NULL)
 		{
 			painter.drawImage(0, 0, *qImage);
 		}
@@ -84,6 +84,12 @@ class QcvMatWidgetImage: public QcvMatWidget
 		 */
 		void setup();
 
+		/**
+		 * (Re)builds #qImage around #displayImage whenever display image
+		 * has been reallocated (e.g. when downscaled preview size changes)
+		 */
+		void updateQImage();
+
 		/**
 		 * paint event reimplemented to draw content
 		 * @param event the paint event
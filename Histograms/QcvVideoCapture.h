@@ -13,6 +13,8 @@
 #include <QTimer>
 #include <QThread>
 #include <QMutex>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 
 #include <opencv2/highgui/highgui.hpp>
 using namespace cv;
@@ -26,6 +28,35 @@ class QcvVideoCapture: public QObject
 {
 	Q_OBJECT
 
+	public:
+		/**
+		 * Capture statistics gathered during #update
+		 */
+		typedef struct
+		{
+			/**
+			 * Number of frames successfully grabbed
+			 */
+			size_t grabbedFrames;
+
+			/**
+			 * Number of frames dropped because previous frame was still
+			 * locked by its consumer
+			 */
+			size_t droppedFrames;
+
+			/**
+			 * Measured frame rate (smoothed) in frames per second
+			 */
+			double frameRate;
+
+			/**
+			 * Measured grab latency (smoothed) in ms: time spent grabbing
+			 * and transforming a frame until #updated is emitted
+			 */
+			double latency;
+		} Statistics;
+
 	protected:
 
 		/**
@@ -40,14 +71,34 @@ class QcvVideoCapture: public QObject
 		 * manipulated by other methods (such as #setDirectSize). So capture
 		 * access for new images should be protected by a mutex to ensure
 		 * atomic access to capture object at a time.
+		 * @note capture might be a regular VideoCapture (camera or video
+		 * file) or any frame source sub class of VideoCapture
+		 * (@see CvFrameSource)
 		 */
-		VideoCapture capture;
+		Ptr<VideoCapture> capture;
+
+		/**
+		 * Indicates #capture is a frame source (@see CvFrameSource) rather
+		 * than a camera or a video file. Frame sources always support
+		 * properties queries, provide their own frame rate (0 meaning
+		 * unthrottled) and never run out of frames.
+		 */
+		bool frameSource;
 
 		/**
 		 * refresh timer
 		 */
 		QTimer * timer;
 
+		/**
+		 * Unthrottled frame source grabbing in #updateThread : instead of
+		 * a zero delay #timer living in the main thread (which would post
+		 * update events to the #updateThread without bound), each grab
+		 * queues the next one when it is done (see #grabNext).
+		 * Non zero while grabbing should go on.
+		 */
+		QAtomicInt unthrottled;
+
 		/**
 		 * Independant thread to update capture.
 		 * If independant thread is required, then update method is called
@@ -174,6 +225,33 @@ class QcvVideoCapture: public QObject
 		 */
 		static int messageDelay;
 
+		/**
+		 * Capture statistics
+		 */
+		Statistics statistics;
+
+		/**
+		 * Clock used to measure frame rate and latency
+		 */
+		QElapsedTimer statisticsClock;
+
+		/**
+		 * Time of last grabbed frame (in ns from #statisticsClock start) or
+		 * -1 if no frame has been grabbed yet
+		 */
+		qint64 lastGrabTime;
+
+		/**
+		 * Mutex protecting #statistics since they are updated in
+		 * #updateThread and read from any other thread
+		 */
+		mutable QMutex statisticsMutex;
+
+		/**
+		 * Smoothing factor used for frame rate and latency moving averages
+		 */
+		static double statisticsSmoothing;
+
 	public:
 		/**
 		 * QcvVideoCapture constructor.
@@ -244,6 +322,32 @@ class QcvVideoCapture: public QObject
 						QThread * updateThread = NULL,
 						QObject * parent = NULL);
 
+		/**
+		 * QcvVideoCapture constructor from frame source
+		 * @param source the frame source to capture frames from (such as
+		 * a CvSyntheticCapture)
+		 * @param name the name of the source used in status messages
+		 * @param flipVideo mirror image
+		 * @param gray convert image to gray
+		 * @param skip indicates capture can skip an image. When the capture
+		 * result has not been processed yet, or when false that capture should
+		 * wait for the result to be processed before grabbing a new image.
+		 * This only applies when #updateThread is not NULL.
+		 * @param width desired width or 0 to keep capture width
+		 * @param height desired height or 0 to keep capture height
+		 * @param updateThread the thread used to run this capture
+		 * @param parent the parent QObject
+		 */
+		QcvVideoCapture(const Ptr<VideoCapture> & source,
+						const QString & name,
+						const bool flipVideo = false,
+						const bool gray = false,
+						const bool skip = true,
+						const unsigned int  width = 0,
+						const unsigned int height = 0,
+						QThread * updateThread = NULL,
+						QObject * parent = NULL);
+
 		/**
 		 * QcvVideoCapture destructor.
 		 * releases video capture and image
@@ -309,6 +413,19 @@ class QcvVideoCapture: public QObject
 		 */
 		QMutex * getMutex();
 
+		/**
+		 * Capture statistics accessor
+		 * @return a copy of the current capture statistics
+		 */
+		Statistics getStatistics() const;
+
+		/**
+		 * Update thread accessor
+		 * @return the thread running this capture or NULL if capture is
+		 * updated in the main thread
+		 */
+		QThread * getUpdateThread() const;
+
 	public slots:
 		/**
 		 * Open new device Id
@@ -352,6 +469,11 @@ class QcvVideoCapture: public QObject
 		 */
 		void setSize(const QSize & size);
 
+		/**
+		 * Resets capture statistics
+		 */
+		void resetStatistics();
+
 	protected:
 		/**
 		 * Performs a grab test to fill #image.
@@ -406,6 +528,33 @@ class QcvVideoCapture: public QObject
 		 */
 		bool setDirectSize(const unsigned int width, const unsigned int height);
 
+		/**
+		 * Refresh headers of the image chain
+		 * image -> imageResized -> imageFlipped -> imageDisplay
+		 * sharing the #image buffer. Zero copy frame sources (such as
+		 * CvRawCapture) provide a different buffer for each frame, so
+		 * images sharing the #image buffer should follow.
+		 * Headers are swapped under #mutex (when running in #updateThread)
+		 * so consumers reading #imageDisplay under this lock always see a
+		 * consistent header.
+		 * @return true if #imageDisplay size or type changed so consumers
+		 * should be notified with #imageChanged, false if only its buffer
+		 * changed
+		 */
+		bool relinkImageChain();
+
+		/**
+		 * Records a successfully grabbed frame in #statistics
+		 * @param startTime time at which grabbing this frame started (in ns
+		 * from #statisticsClock start)
+		 */
+		void recordGrab(const qint64 startTime);
+
+		/**
+		 * Records a dropped frame in #statistics
+		 */
+		void recordDrop();
+
 	protected slots:
 		/**
 		 * update slot trigerred by timer : Grabs a new image and sends updated()
@@ -417,6 +566,13 @@ class QcvVideoCapture: public QObject
 		 */
 		void update();
 
+		/**
+		 * Unthrottled grabbing slot run in #updateThread : grabs a new
+		 * image with #update then queues the next grab as long as
+		 * #unthrottled is set
+		 */
+		void grabNext();
+
 	signals:
 		/**
 		 * Signal emitted when a new image has been grabbed
@@ -3,6 +3,7 @@
 #include <QDebug>
 #include <libgen.h>		// for basename
 #include <iostream>		// for cout
+#include <cstdlib>		// for EXIT_SUCCESS & EXIT_FAILURE
 
 #include "QcvVideoCapture.h"
 #include "CaptureFactory.h"
@@ -24,6 +25,8 @@ void usage(char * name);
  * [--mirror | -m] [--gray | -g] [--size | -s] <width>x<height>
  * 	- device : [--device | -d] <device #> (0, 1, ...) Opens capture device #
  * 	- filename : [--file | -f ] <filename> Opens a video file or URL (including rtsp)
+ * 	only the first device or file is opened when several are provided
+ * 	(multiple streams and [--pool | -p] are not supported here)
  * 	- mirror : mirrors image horizontally before display
  * 	- gray : turns on source image gray conversion
  *	- size : [--size | -s] <width>x<height> resize capture to fit desired <width>
@@ -72,6 +75,13 @@ int main(int argc, char *argv[])
 	CaptureFactory factory(argList);
 	factory.setSkippable(true);
 
+	// Multiple streams are only handled by ColorModels capture pool
+	if (factory.getNbStreams() > 1)
+	{
+		qWarning("Warning: %d streams requested, only the first one is opened",
+				 factory.getNbStreams());
+	}
+
 	// Helper thread for capture
 	QThread * capThread = NULL;
 	if (threadNumber > 1)
@@ -82,6 +92,17 @@ int main(int argc, char *argv[])
 	// Capture
 	QcvVideoCapture * capture = factory.getCaptureInstance(capThread);
 
+	if (capture == NULL)
+	{
+		cerr << "Unable to open video source" << endl;
+		usage(argv[0]);
+		if (capThread != NULL)
+		{
+			delete capThread;
+		}
+		return EXIT_FAILURE;
+	}
+
 	// ------------------------------------------------------------------------
 	// Create QHistandLUT
 	// ------------------------------------------------------------------------
@@ -176,6 +197,9 @@ void usage(char * name)
 		 << "[-d | --device] <device number> "
 		 << "[-v | --video] <video file> "
 		 << "[-s | --size] <width>x<height> "
+		 << "[-y | --synthetic] <width>x<height>[@<rate>][:<pattern>] "
+		 << "[--raw] <path>:<width>x<height>[@<rate>] "
+		 << "[--sequence] <glob pattern>[@<rate>] "
 		 << "[-m | --mirror]"
 		 << "[-t | --threads] <number of threads [1..3]>"
 		 << endl;
@@ -0,0 +1,185 @@
+/*
+ * CvBandExecutor.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVBANDEXECUTOR_H_
+#define CVBANDEXECUTOR_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+using namespace std;
+
+#include <opencv2/core/core.hpp>	// for Range
+using namespace cv;
+
+/**
+ * Persistent pool of threads executing a row processing function on
+ * horizontal bands of an image : rows are split into as many contiguous
+ * bands as threads, the calling thread processes the first band while
+ * workers process the others. "Rows" can be any kind of independent
+ * items such as image channels or columns. Mean processing time of each
+ * band is recorded so scaling can be observed.
+ */
+class CvBandExecutor
+{
+	public:
+		/**
+		 * Function processing a range of rows
+		 */
+		typedef function<void(const Range &)> BandFunction;
+
+	protected:
+		/**
+		 * Worker threads (number of bands - 1)
+		 */
+		vector<thread> workers;
+
+		/**
+		 * Number of bands (including the calling thread's band)
+		 */
+		size_t nbBands;
+
+		/**
+		 * Lock preventing threads changes while a task is running
+		 */
+		mutex runLock;
+
+		/**
+		 * Lock on the current task
+		 */
+		mutex taskLock;
+
+		/**
+		 * Signals workers a new task is available or that they should
+		 * stop
+		 */
+		condition_variable taskCondition;
+
+		/**
+		 * Signals the calling thread all workers bands are done
+		 */
+		condition_variable doneCondition;
+
+		/**
+		 * Current task
+		 */
+		BandFunction task;
+
+		/**
+		 * Number of rows of the current task
+		 */
+		int taskRows;
+
+		/**
+		 * Task generation, incremented each time a new task is run so
+		 * workers do not process the same task twice
+		 */
+		size_t generation;
+
+		/**
+		 * Number of workers bands still running for the current task
+		 */
+		size_t pending;
+
+		/**
+		 * Workers should stop
+		 */
+		bool stopping;
+
+		/**
+		 * Accumulated processing time of each band in ticks
+		 * (see cv::getTickCount)
+		 */
+		vector<int64> bandTicks;
+
+		/**
+		 * Number of runs since last reset
+		 */
+		size_t nbRuns;
+
+	public:
+		/**
+		 * Band executor constructor
+		 * @param nbThreads number of threads (i.e. bands) including the
+		 * calling thread. 0 uses the number of hardware threads
+		 */
+		CvBandExecutor(const size_t nbThreads = 1);
+
+		/**
+		 * Band executor destructor.
+		 * Stops and joins worker threads
+		 */
+		virtual ~CvBandExecutor();
+
+		/**
+		 * Number of threads (i.e. bands) including the calling thread
+		 * @return the number of threads
+		 */
+		size_t getNbThreads() const;
+
+		/**
+		 * Changes the number of threads : stops current workers and
+		 * launches new ones.
+		 * @param nbThreads number of threads including the calling thread.
+		 * 0 uses the number of hardware threads
+		 * @note waits for the end of a run in progress
+		 */
+		void setNbThreads(const size_t nbThreads);
+
+		/**
+		 * Runs a function on bands of rows and waits until all bands are
+		 * processed. When there is less rows than bands, empty bands are
+		 * skipped so function is only called on non empty ranges
+		 * @param rows the number of rows to split into bands
+		 * @param function the function to run on each band
+		 */
+		void run(const int rows, const BandFunction & function);
+
+		/**
+		 * Mean processing time of a band
+		 * @param band the band index
+		 * @return the mean processing time of this band per run in ms
+		 * (or 0 if band does not exist)
+		 */
+		double getBandTime(const size_t band) const;
+
+		/**
+		 * Resets bands processing times
+		 */
+		void resetTimes();
+
+	protected:
+		/**
+		 * Range of rows of a band
+		 * @param band the band index
+		 * @param rows the total number of rows
+		 * @return the rows range of this band
+		 */
+		Range bandRange(const size_t band, const int rows) const;
+
+		/**
+		 * Worker thread loop : waits for new tasks and processes its band
+		 * @param band the band processed by this worker
+		 * @param startGeneration the task generation when worker was
+		 * launched
+		 */
+		void work(const size_t band, const size_t startGeneration);
+
+		/**
+		 * Launches worker threads
+		 */
+		void startWorkers();
+
+		/**
+		 * Stops and joins worker threads
+		 */
+		void stopWorkers();
+};
+
+#endif /* CVBANDEXECUTOR_H_ */
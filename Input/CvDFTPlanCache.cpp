@@ -0,0 +1,205 @@
+/*
+ * CvDFTPlanCache.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include "CvDFTPlanCache.h"
+
+/*
+ * Maximum number of pooled buffers for each (size, type, direction)
+ * key. Buffers released beyond this number are deallocated.
+ * Default value is 16.
+ */
+const size_t CvDFTPlanCache::maxPooledBuffers = 16;
+
+/*
+ * Key constructor
+ * @param size buffers size
+ * @param type buffers type
+ * @param direction transform direction
+ */
+CvDFTPlanCache::Key::Key(const Size & size,
+						 const int type,
+						 const Direction direction) :
+	width(size.width),
+	height(size.height),
+	type(type),
+	direction(direction)
+{
+}
+
+/*
+ * Key ordering for maps
+ * @param other the other key to compare
+ * @return true if this key is less than the other key
+ */
+bool CvDFTPlanCache::Key::operator <(const Key & other) const
+{
+	if (width != other.width)
+	{
+		return width < other.width;
+	}
+	if (height != other.height)
+	{
+		return height < other.height;
+	}
+	if (type != other.type)
+	{
+		return type < other.type;
+	}
+	return direction < other.direction;
+}
+
+/*
+ * Plan cache constructor.
+ * Use instance to get the shared cache
+ */
+CvDFTPlanCache::CvDFTPlanCache() :
+	hits(0),
+	misses(0)
+{
+}
+
+/*
+ * The cache shared by all processors
+ * @return the shared cache
+ */
+CvDFTPlanCache & CvDFTPlanCache::instance()
+{
+	static CvDFTPlanCache cache;
+	return cache;
+}
+
+/*
+ * Optimal DFT size (see cv::getOptimalDFTSize) computed only once
+ * for each size
+ * @param size the minimum size
+ * @return the optimal DFT size greater or equal to size
+ */
+int CvDFTPlanCache::getOptimalSize(const int size)
+{
+	lock_guard<mutex> locker(lock);
+
+	map<int, int>::const_iterator it = optimalSizes.find(size);
+	if (it != optimalSizes.end())
+	{
+		return it->second;
+	}
+
+	const int optimalSize = getOptimalDFTSize(size);
+	optimalSizes[size] = optimalSize;
+	return optimalSize;
+}
+
+/*
+ * Acquires a buffer from the pool of (size, type, direction)
+ * buffers or allocates a new one if the pool is empty
+ * @param size buffer size
+ * @param type buffer type
+ * @param direction transform direction
+ * @return a buffer which is not used by other processors until
+ * it is released
+ */
+Mat CvDFTPlanCache::acquire(const Size & size,
+							const int type,
+							const Direction direction)
+{
+	{
+		lock_guard<mutex> locker(lock);
+
+		map<Key, vector<Mat> >::iterator it =
+			pools.find(Key(size, type, direction));
+		if (it != pools.end() && !it->second.empty())
+		{
+			Mat buffer = it->second.back();
+			it->second.pop_back();
+			hits++;
+			return buffer;
+		}
+
+		misses++;
+	}
+
+	// allocation outside of lock
+	return Mat(size, type);
+}
+
+/*
+ * Releases a buffer back to the pool corresponding to its
+ * current size and type (which may have changed since it has been
+ * acquired)
+ * @param buffer the buffer to release. buffer is released
+ * (and therefore empty) after this call. Buffers still shared with other
+ * matrices are not pooled, only this reference is dropped.
+ * @param direction transform direction
+ */
+void CvDFTPlanCache::release(Mat & buffer, const Direction direction)
+{
+	// Only whole 2D buffers are pooled, not sub matrices, and only when
+	// this is their last reference : a buffer still shared with another
+	// matrix would be handed to a second owner by acquire
+	if (!buffer.empty() && buffer.dims == 2 && buffer.isContinuous() &&
+		buffer.refcount != NULL && *buffer.refcount == 1)
+	{
+		lock_guard<mutex> locker(lock);
+
+		vector<Mat> & pool =
+			pools[Key(buffer.size(), buffer.type(), direction)];
+		if (pool.size() < maxPooledBuffers)
+		{
+			pool.push_back(buffer);
+		}
+	}
+
+	buffer.release();
+}
+
+/*
+ * Deallocates all pooled buffers and forget optimal sizes
+ */
+void CvDFTPlanCache::clear()
+{
+	lock_guard<mutex> locker(lock);
+
+	pools.clear();
+	optimalSizes.clear();
+}
+
+/*
+ * Number of buffers acquisitions served from pools
+ * @return the number of acquisitions without allocation
+ */
+size_t CvDFTPlanCache::getHits() const
+{
+	lock_guard<mutex> locker(lock);
+	return hits;
+}
+
+/*
+ * Number of buffers acquisitions which required an allocation
+ * @return the number of acquisitions with allocation
+ */
+size_t CvDFTPlanCache::getMisses() const
+{
+	lock_guard<mutex> locker(lock);
+	return misses;
+}
+
+/*
+ * Number of free buffers in all pools
+ * @return the number of pooled buffers
+ */
+size_t CvDFTPlanCache::getPooledBuffers() const
+{
+	lock_guard<mutex> locker(lock);
+
+	size_t count = 0;
+	for (map<Key, vector<Mat> >::const_iterator it = pools.begin();
+		 it != pools.end(); ++it)
+	{
+		count += it->second.size();
+	}
+	return count;
+}
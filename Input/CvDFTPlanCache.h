@@ -0,0 +1,186 @@
+/*
+ * CvDFTPlanCache.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVDFTPLANCACHE_H_
+#define CVDFTPLANCACHE_H_
+
+#include <map>
+#include <vector>
+#include <mutex>
+using namespace std;
+
+#include <opencv2/core/core.hpp>
+using namespace cv;
+
+/**
+ * Cache of Fourier transforms plans shared by all DFT processors :
+ * optimal DFT sizes and pools of workspace buffers keyed by
+ * (size, type, direction). Processors acquire their buffers during
+ * setup and release them back to the cache during cleanup, so they
+ * persist across source image changes and switching back to a
+ * previously used resolution reuses already allocated buffers.
+ * OpenCV does not expose its internal DFT plans, so a plan here only
+ * consists of the optimal size and the workspace buffers.
+ */
+class CvDFTPlanCache
+{
+	public:
+		/**
+		 * Direction of the transform a buffer is used for
+		 */
+		typedef enum
+		{
+			FORWARD = 0,	//!< Buffers used by forward transforms
+			INVERSE,		//!< Buffers used by inverse transforms
+			NbDirections	//!< Number of directions
+		} Direction;
+
+		/**
+		 * Maximum number of pooled buffers for each (size, type, direction)
+		 * key. Buffers released beyond this number are deallocated.
+		 * Default value is 16.
+		 */
+		static const size_t maxPooledBuffers;
+
+	protected:
+		/**
+		 * Key of a pool of buffers
+		 */
+		struct Key
+		{
+			/**
+			 * Buffers width
+			 */
+			int width;
+
+			/**
+			 * Buffers height
+			 */
+			int height;
+
+			/**
+			 * Buffers type
+			 */
+			int type;
+
+			/**
+			 * Transform direction
+			 */
+			Direction direction;
+
+			/**
+			 * Key constructor
+			 * @param size buffers size
+			 * @param type buffers type
+			 * @param direction transform direction
+			 */
+			Key(const Size & size, const int type, const Direction direction);
+
+			/**
+			 * Key ordering for maps
+			 * @param other the other key to compare
+			 * @return true if this key is less than the other key
+			 */
+			bool operator <(const Key & other) const;
+		};
+
+		/**
+		 * Optimal DFT sizes already computed
+		 */
+		map<int, int> optimalSizes;
+
+		/**
+		 * Pools of free buffers
+		 */
+		map<Key, vector<Mat> > pools;
+
+		/**
+		 * Number of buffers acquisitions served from pools
+		 */
+		size_t hits;
+
+		/**
+		 * Number of buffers acquisitions which required an allocation
+		 */
+		size_t misses;
+
+		/**
+		 * Lock on cache contents since cache is shared between
+		 * processors running in different threads
+		 */
+		mutable mutex lock;
+
+		/**
+		 * Plan cache constructor.
+		 * Use #instance to get the shared cache
+		 */
+		CvDFTPlanCache();
+
+	public:
+		/**
+		 * The cache shared by all processors
+		 * @return the shared cache
+		 */
+		static CvDFTPlanCache & instance();
+
+		/**
+		 * Optimal DFT size (see cv::getOptimalDFTSize) computed only once
+		 * for each size
+		 * @param size the minimum size
+		 * @return the optimal DFT size greater or equal to size
+		 */
+		int getOptimalSize(const int size);
+
+		/**
+		 * Acquires a buffer from the pool of (size, type, direction)
+		 * buffers or allocates a new one if the pool is empty
+		 * @param size buffer size
+		 * @param type buffer type
+		 * @param direction transform direction
+		 * @return a buffer which is not used by other processors until
+		 * it is released
+		 */
+		Mat acquire(const Size & size,
+					const int type,
+					const Direction direction = FORWARD);
+
+		/**
+		 * Releases a buffer back to the pool corresponding to its
+		 * current size and type (which may have changed since it has been
+		 * acquired)
+		 * @param buffer the buffer to release. buffer is released
+		 * (and therefore empty) after this call. Buffers still shared with
+		 * other matrices are not pooled, only this reference is dropped.
+		 * @param direction transform direction
+		 */
+		void release(Mat & buffer, const Direction direction = FORWARD);
+
+		/**
+		 * Deallocates all pooled buffers and forget optimal sizes
+		 */
+		void clear();
+
+		/**
+		 * Number of buffers acquisitions served from pools
+		 * @return the number of acquisitions without allocation
+		 */
+		size_t getHits() const;
+
+		/**
+		 * Number of buffers acquisitions which required an allocation
+		 * @return the number of acquisitions with allocation
+		 */
+		size_t getMisses() const;
+
+		/**
+		 * Number of free buffers in all pools
+		 * @return the number of pooled buffers
+		 */
+		size_t getPooledBuffers() const;
+};
+
+#endif /* CVDFTPLANCACHE_H_ */
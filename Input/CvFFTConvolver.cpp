@@ -0,0 +1,519 @@
+/*
+ * CvFFTConvolver.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include <cmath>	// for log2
+#include <algorithm>	// for min & max
+
+#include "CvFFTConvolver.h"
+#include "CvDFTPlanCache.h"
+
+/*
+ * Default minimum tiles size (before rounding to optimal DFT size).
+ * Default value is 256.
+ */
+const int CvFFTConvolver::defaultTileSize = 256;
+
+/*
+ * Relative cost of one FFT operation (per pixel and per log2 of
+ * tile area) compared to one direct filtering multiply-add,
+ * used by AUTO_CONVOLUTION to choose between direct and FFT
+ * filtering. Default value is 4.
+ */
+const double CvFFTConvolver::fftCostFactor = 4.0;
+
+/*
+ * FFT convolver constructor
+ * @param kernel the filter kernel (single channel). Converted to
+ * float.
+ * @param method convolution method
+ * @param tileSize minimum tiles size
+ * @param nbThreads number of threads transforming tiles
+ * (0 uses the number of hardware threads)
+ */
+CvFFTConvolver::CvFFTConvolver(const Mat & kernel,
+							   const Method method,
+							   const int tileSize,
+							   const size_t nbThreads) :
+	method(method),
+	lastMethod(DIRECT_CONVOLUTION),
+	tileSize(tileSize > 0 ? tileSize : defaultTileSize),
+	dftSize(0, 0),
+	executor(nbThreads)
+{
+	if (!kernel.empty())
+	{
+		setKernel(kernel);
+	}
+}
+
+/*
+ * FFT convolver destructor.
+ * Releases tiles results buffers
+ */
+CvFFTConvolver::~CvFFTConvolver()
+{
+	releaseTilesResults();
+	kernelSpectrum.release();
+	planes.clear();
+	results.clear();
+}
+
+/*
+ * Filter kernel
+ * @return the single channel float kernel
+ */
+const Mat & CvFFTConvolver::getKernel() const
+{
+	return kernel;
+}
+
+/*
+ * Changes filter kernel and invalidates cached kernel spectrum
+ * @param kernel the new filter kernel (single channel).
+ * Converted to float.
+ */
+void CvFFTConvolver::setKernel(const Mat & kernel)
+{
+	CV_Assert(kernel.channels() == 1);
+
+	lock_guard<mutex> guard(lock);
+	kernel.convertTo(this->kernel, CV_32F);
+	kernelSpectrum.release();
+}
+
+/*
+ * Requested convolution method
+ * @return the requested convolution method
+ */
+CvFFTConvolver::Method CvFFTConvolver::getMethod() const
+{
+	return method;
+}
+
+/*
+ * Changes convolution method
+ * @param method the new convolution method
+ */
+void CvFFTConvolver::setMethod(const Method method)
+{
+	if (method >= AUTO_CONVOLUTION && method < NbMethods)
+	{
+		lock_guard<mutex> guard(lock);
+		this->method = method;
+	}
+}
+
+/*
+ * Method used during last apply
+ * @return the method used during last apply (DIRECT_CONVOLUTION,
+ * OVERLAP_SAVE or OVERLAP_ADD)
+ */
+CvFFTConvolver::Method CvFFTConvolver::getLastMethod() const
+{
+	return lastMethod;
+}
+
+/*
+ * Minimum tiles size
+ * @return the minimum tiles size
+ */
+int CvFFTConvolver::getTileSize() const
+{
+	return tileSize;
+}
+
+/*
+ * Changes minimum tiles size and invalidates cached kernel
+ * spectrum
+ * @param tileSize the new minimum tiles size.
+ * Tiles are at least twice as large as the kernel
+ */
+void CvFFTConvolver::setTileSize(const int tileSize)
+{
+	if (tileSize > 0)
+	{
+		lock_guard<mutex> guard(lock);
+		this->tileSize = tileSize;
+		kernelSpectrum.release();
+	}
+}
+
+/*
+ * Current tiles DFT size
+ * @return the tiles DFT size used during last FFT apply
+ */
+Size CvFFTConvolver::getDftSize() const
+{
+	return dftSize;
+}
+
+/*
+ * Number of threads transforming tiles
+ * @return the number of threads
+ */
+size_t CvFFTConvolver::getNbThreads() const
+{
+	return executor.getNbThreads();
+}
+
+/*
+ * Changes the number of threads transforming tiles
+ * @param nbThreads the new number of threads
+ * (0 uses the number of hardware threads)
+ */
+void CvFFTConvolver::setNbThreads(const size_t nbThreads)
+{
+	executor.setNbThreads(nbThreads);
+}
+
+/*
+ * Filters an image with kernel as cv::filter2D would do
+ * @param src the source image (any number of channels)
+ * @param dst the destination image (same size and channels
+ * as source)
+ * @param ddepth destination depth (-1 uses source depth)
+ * @param borderType border extrapolation method
+ * (see cv::copyMakeBorder)
+ */
+void CvFFTConvolver::apply(const Mat & src,
+						   Mat & dst,
+						   const int ddepth,
+						   const int borderType)
+{
+	lock_guard<mutex> guard(lock);
+
+	int depth = ddepth < 0 ? src.depth() : ddepth;
+
+	if (kernel.empty())
+	{
+		lastMethod = DIRECT_CONVOLUTION;
+		src.convertTo(dst, depth);
+		return;
+	}
+
+	lastMethod = method == AUTO_CONVOLUTION ? selectMethod(src.size()) :
+		method;
+
+	if (lastMethod == DIRECT_CONVOLUTION)
+	{
+		filter2D(src, dst, depth, kernel, Point(-1, -1), 0, borderType);
+		return;
+	}
+
+	updateKernelSpectrum(src.size());
+
+	// Border extension so that each output pixel only depends on extended
+	// image pixels, with the kernel anchored at its center as in filter2D
+	Mat extended;
+	int top = kernel.rows / 2;
+	int left = kernel.cols / 2;
+	copyMakeBorder(src, extended,
+				   top, kernel.rows - 1 - top,
+				   left, kernel.cols - 1 - left,
+				   borderType);
+
+	split(extended, planes);
+	results.resize(planes.size());
+	for (size_t p = 0; p < planes.size(); p++)
+	{
+		if (planes[p].depth() != CV_32F)
+		{
+			planes[p].convertTo(planes[p], CV_32F);
+		}
+		results[p].create(src.size(), CV_32F);
+	}
+
+	if (lastMethod == OVERLAP_ADD)
+	{
+		overlapAdd(src.size());
+	}
+	else
+	{
+		overlapSave(src.size());
+	}
+
+	if (results.size() > 1)
+	{
+		Mat merged;
+		merge(results, merged);
+		merged.convertTo(dst, depth);
+	}
+	else
+	{
+		results[0].convertTo(dst, depth);
+	}
+}
+
+/*
+ * Method chosen by AUTO_CONVOLUTION for an image size
+ * @param imageSize the image size
+ * @return DIRECT_CONVOLUTION if direct filtering cost is lower
+ * than estimated FFT cost, OVERLAP_SAVE otherwise
+ */
+CvFFTConvolver::Method CvFFTConvolver::selectMethod(const Size & imageSize) const
+{
+	double directCost = (double) imageSize.area() * (double) kernel.total();
+
+	if (kernel.empty() || directCost <= fftCost(imageSize))
+	{
+		return DIRECT_CONVOLUTION;
+	}
+
+	return OVERLAP_SAVE;
+}
+
+/*
+ * Tiles DFT size for an image size : tiles are at least tileSize
+ * and twice the kernel size, but never larger than the border
+ * extended image, then rounded to optimal DFT sizes
+ * @param imageSize the image size
+ * @return the tiles DFT size
+ */
+Size CvFFTConvolver::tilesDftSize(const Size & imageSize) const
+{
+	CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+	int extendedWidth = imageSize.width + kernel.cols - 1;
+	int extendedHeight = imageSize.height + kernel.rows - 1;
+
+	return Size(cache.getOptimalSize(std::min(std::max(tileSize,
+													   2 * kernel.cols),
+											  extendedWidth)),
+				cache.getOptimalSize(std::min(std::max(tileSize,
+													   2 * kernel.rows),
+											  extendedHeight)));
+}
+
+/*
+ * Estimated FFT filtering cost of one channel
+ * @param imageSize the image size
+ * @return the estimated number of operations
+ */
+double CvFFTConvolver::fftCost(const Size & imageSize) const
+{
+	Size size = tilesDftSize(imageSize);
+	int blockWidth = size.width - kernel.cols + 1;
+	int blockHeight = size.height - kernel.rows + 1;
+	int nbTiles = ((imageSize.width + blockWidth - 1) / blockWidth) *
+		((imageSize.height + blockHeight - 1) / blockHeight);
+	double area = (double) size.area();
+
+	return fftCostFactor * (double) nbTiles * area * log2(area);
+}
+
+/*
+ * Computes kernel spectrum if tiles DFT size changed
+ * @param imageSize the image size
+ */
+void CvFFTConvolver::updateKernelSpectrum(const Size & imageSize)
+{
+	Size size = tilesDftSize(imageSize);
+
+	if (size == dftSize && !kernelSpectrum.empty())
+	{
+		return;
+	}
+
+	dftSize = size;
+
+	// Flipped kernel turns spectrum product into a correlation
+	Mat padded = Mat::zeros(dftSize, CV_32F);
+	Mat paddedKernel = padded(Rect(0, 0, kernel.cols, kernel.rows));
+	flip(kernel, paddedKernel, -1);
+	dft(padded, kernelSpectrum, 0, kernel.rows);
+
+	// tiles results have the former DFT size
+	releaseTilesResults();
+}
+
+/*
+ * Filters extended planes into results planes with overlap-save
+ * @param imageSize the image size
+ */
+void CvFFTConvolver::overlapSave(const Size & imageSize)
+{
+	// Each DFT sized input tile produces a block of valid output pixels :
+	// the first (kernel - 1) rows and columns are corrupted by circular
+	// wrapping, so successive input tiles overlap by (kernel - 1)
+	Size block(dftSize.width - kernel.cols + 1,
+			   dftSize.height - kernel.rows + 1);
+	int tilesX = (imageSize.width + block.width - 1) / block.width;
+	int tilesY = (imageSize.height + block.height - 1) / block.height;
+	int nbTiles = tilesX * tilesY;
+
+	executor.run((int) planes.size() * nbTiles,
+				 [this, &imageSize, block, tilesX, nbTiles]
+		(const Range & jobs)
+	{
+		if (jobs.empty())
+		{
+			return;
+		}
+
+		CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+		Mat tile = cache.acquire(dftSize, CV_32F);
+
+		for (int j = jobs.start; j < jobs.end; j++)
+		{
+			const Mat & plane = planes[j / nbTiles];
+			int x = ((j % nbTiles) % tilesX) * block.width;
+			int y = ((j % nbTiles) / tilesX) * block.height;
+
+			Rect input(x, y,
+					   std::min(dftSize.width, plane.cols - x),
+					   std::min(dftSize.height, plane.rows - y));
+			if (input.size() != dftSize)
+			{
+				tile.setTo(Scalar::all(0));
+			}
+			Mat tileInput = tile(Rect(Point(0, 0), input.size()));
+			plane(input).copyTo(tileInput);
+
+			Rect output(x, y,
+						std::min(block.width, imageSize.width - x),
+						std::min(block.height, imageSize.height - y));
+
+			convolveTile(tile, input.height, kernel.rows - 1 + output.height);
+
+			Mat resultOutput = results[j / nbTiles](output);
+			tile(Rect(Point(kernel.cols - 1, kernel.rows - 1),
+					  output.size())).copyTo(resultOutput);
+		}
+
+		cache.release(tile);
+	});
+}
+
+/*
+ * Filters extended planes into results planes with overlap-add
+ * @param imageSize the image size
+ */
+void CvFFTConvolver::overlapAdd(const Size & imageSize)
+{
+	// Disjoint input blocks padded to DFT size hold their whole linear
+	// convolution without wrapping. Successive convolutions overlap by
+	// (kernel - 1) and are summed
+	Size block(dftSize.width - kernel.cols + 1,
+			   dftSize.height - kernel.rows + 1);
+	Size extendedSize(imageSize.width + kernel.cols - 1,
+					  imageSize.height + kernel.rows - 1);
+	int tilesX = (extendedSize.width + block.width - 1) / block.width;
+	int tilesY = (extendedSize.height + block.height - 1) / block.height;
+	int nbTiles = tilesX * tilesY;
+	size_t nbResults = planes.size() * (size_t) nbTiles;
+
+	if (tilesResults.size() > nbResults)
+	{
+		CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+		for (size_t i = nbResults; i < tilesResults.size(); i++)
+		{
+			cache.release(tilesResults[i], CvDFTPlanCache::INVERSE);
+		}
+	}
+	tilesResults.resize(nbResults);
+
+	// Convolves each tile into its own result
+	executor.run((int) nbResults,
+				 [this, &extendedSize, block, tilesX, nbTiles]
+		(const Range & jobs)
+	{
+		CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+
+		for (int j = jobs.start; j < jobs.end; j++)
+		{
+			Mat & tile = tilesResults[j];
+			if (tile.empty())
+			{
+				tile = cache.acquire(dftSize, CV_32F, CvDFTPlanCache::INVERSE);
+			}
+
+			const Mat & plane = planes[j / nbTiles];
+			Rect input(((j % nbTiles) % tilesX) * block.width,
+					   ((j % nbTiles) / tilesX) * block.height,
+					   0, 0);
+			input.width = std::min(block.width, extendedSize.width - input.x);
+			input.height = std::min(block.height, extendedSize.height - input.y);
+
+			tile.setTo(Scalar::all(0));
+			Mat tileInput = tile(Rect(Point(0, 0), input.size()));
+			plane(input).copyTo(tileInput);
+
+			convolveTile(tile, input.height, dftSize.height);
+		}
+	});
+
+	// Sums overlapping tiles results on bands of output rows : output
+	// pixel (x, y) is the full convolution at (x + kernel.cols - 1,
+	// y + kernel.rows - 1)
+	Point offset(kernel.cols - 1, kernel.rows - 1);
+	executor.run(imageSize.height,
+				 [this, &imageSize, block, tilesX, nbTiles, offset]
+		(const Range & rows)
+	{
+		if (rows.empty())
+		{
+			return;
+		}
+
+		Rect band(offset.x, offset.y + rows.start,
+				  imageSize.width, rows.size());
+
+		for (size_t p = 0; p < planes.size(); p++)
+		{
+			Mat resultBand = results[p].rowRange(rows);
+			resultBand.setTo(Scalar::all(0));
+
+			for (int t = 0; t < nbTiles; t++)
+			{
+				Rect tileRect((t % tilesX) * block.width,
+							  (t / tilesX) * block.height,
+							  dftSize.width,
+							  dftSize.height);
+				Rect overlap = band & tileRect;
+
+				if (overlap.area() > 0)
+				{
+					Mat resultOverlap = results[p](overlap - offset);
+					const Mat & tile = tilesResults[p * nbTiles + t];
+					resultOverlap += tile(overlap - tileRect.tl());
+				}
+			}
+		}
+	});
+}
+
+/*
+ * Convolves a tile with kernel spectrum in place
+ * @param tile the zero padded tile to convolve
+ * @param inputRows number of non zero rows in tile
+ * @param outputRows number of rows of interest in convolved tile
+ * @note tile is a single precision DFT sized buffer
+ */
+void CvFFTConvolver::convolveTile(Mat & tile,
+								  const int inputRows,
+								  const int outputRows) const
+{
+	dft(tile, tile, 0, inputRows);
+	mulSpectrums(tile, kernelSpectrum, tile, 0);
+	dft(tile, tile, DFT_INVERSE | DFT_REAL_OUTPUT | DFT_SCALE, outputRows);
+}
+
+/*
+ * Releases tiles results buffers to the plan cache
+ */
+void CvFFTConvolver::releaseTilesResults()
+{
+	CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+
+	for (size_t i = 0; i < tilesResults.size(); i++)
+	{
+		if (!tilesResults[i].empty())
+		{
+			cache.release(tilesResults[i], CvDFTPlanCache::INVERSE);
+		}
+	}
+	tilesResults.clear();
+}
@@ -0,0 +1,287 @@
+/*
+ * CvFFTConvolver.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVFFTCONVOLVER_H_
+#define CVFFTCONVOLVER_H_
+
+#include <vector>
+#include <mutex>
+using namespace std;
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+using namespace cv;
+
+#include "CvBandExecutor.h"
+
+/**
+ * Large kernels filtering engine using Fourier transforms on tiles.
+ * Produces the same result as cv::filter2D up to single precision
+ * rounding (correlation with kernel anchored at its center, same border
+ * extrapolation, checked by Input --benchmark) but image is split
+ * into tiles whose size is chosen with cv::getOptimalDFTSize :
+ * 	- overlap-save : overlapping input tiles are transformed and only the
+ * 	part of each tile unaffected by circular wrapping is kept
+ * 	- overlap-add : disjoint input tiles are transformed and their full
+ * 	linear convolutions are summed where they overlap
+ * The kernel spectrum is computed once for each tile size and reused for
+ * all tiles and all frames until the kernel or the image size changes.
+ * Tiles are transformed concurrently by a band executor and tiles
+ * buffers come from the shared DFT plan cache. Small kernels, for which
+ * direct filtering is cheaper than transforms, fall back to cv::filter2D.
+ * CvSimpleDFT uses it to blur frames with a box kernel before their
+ * transform (see CvSimpleDFT::setKernelSize).
+ */
+class CvFFTConvolver
+{
+	public:
+		/**
+		 * Convolution methods
+		 */
+		typedef enum
+		{
+			AUTO_CONVOLUTION = 0,	//!< Chosen from estimated costs
+			DIRECT_CONVOLUTION,		//!< Direct filtering with cv::filter2D
+			OVERLAP_SAVE,			//!< FFT on overlapping tiles
+			OVERLAP_ADD,			//!< FFT on disjoint tiles summed
+			NbMethods				//!< Number of methods
+		} Method;
+
+		/**
+		 * Default minimum tiles size (before rounding to optimal DFT size).
+		 * Default value is 256.
+		 */
+		static const int defaultTileSize;
+
+		/**
+		 * Relative cost of one FFT operation (per pixel and per log2 of
+		 * tile area) compared to one direct filtering multiply-add,
+		 * used by AUTO_CONVOLUTION to choose between direct and FFT
+		 * filtering. Accounts for forward and inverse transforms,
+		 * spectrum product and tiles copies. Default value is 4.
+		 */
+		static const double fftCostFactor;
+
+	protected:
+		/**
+		 * Kernel (single channel float)
+		 */
+		Mat kernel;
+
+		/**
+		 * Kernel flipped around its center and zero padded to DFT size
+		 * transformed : filter2D computes a correlation whereas spectrum
+		 * product computes a convolution
+		 */
+		Mat kernelSpectrum;
+
+		/**
+		 * Requested method
+		 */
+		Method method;
+
+		/**
+		 * Method used during last #apply (never AUTO_CONVOLUTION)
+		 */
+		Method lastMethod;
+
+		/**
+		 * Minimum tiles size
+		 */
+		int tileSize;
+
+		/**
+		 * Tiles DFT size (size of kernelSpectrum)
+		 */
+		Size dftSize;
+
+		/**
+		 * Executor transforming tiles concurrently
+		 */
+		CvBandExecutor executor;
+
+		/**
+		 * Float planes of the border extended source image
+		 */
+		vector<Mat> planes;
+
+		/**
+		 * Float planes of the filtered image
+		 */
+		vector<Mat> results;
+
+		/**
+		 * Overlap-add full convolutions of each tile of each plane
+		 */
+		vector<Mat> tilesResults;
+
+		/**
+		 * Lock preventing kernel or settings changes during #apply
+		 */
+		mutable mutex lock;
+
+	public:
+		/**
+		 * FFT convolver constructor
+		 * @param kernel the filter kernel (single channel). Converted to
+		 * float.
+		 * @param method convolution method
+		 * @param tileSize minimum tiles size
+		 * @param nbThreads number of threads transforming tiles
+		 * (0 uses the number of hardware threads)
+		 */
+		CvFFTConvolver(const Mat & kernel = Mat(),
+					   const Method method = AUTO_CONVOLUTION,
+					   const int tileSize = defaultTileSize,
+					   const size_t nbThreads = 1);
+
+		/**
+		 * FFT convolver destructor.
+		 * Releases tiles results buffers
+		 */
+		virtual ~CvFFTConvolver();
+
+		/**
+		 * Filter kernel
+		 * @return the single channel float kernel
+		 */
+		const Mat & getKernel() const;
+
+		/**
+		 * Changes filter kernel and invalidates cached kernel spectrum
+		 * @param kernel the new filter kernel (single channel).
+		 * Converted to float.
+		 */
+		void setKernel(const Mat & kernel);
+
+		/**
+		 * Requested convolution method
+		 * @return the requested convolution method
+		 */
+		Method getMethod() const;
+
+		/**
+		 * Changes convolution method
+		 * @param method the new convolution method
+		 */
+		void setMethod(const Method method);
+
+		/**
+		 * Method used during last #apply
+		 * @return the method used during last apply (DIRECT_CONVOLUTION,
+		 * OVERLAP_SAVE or OVERLAP_ADD)
+		 */
+		Method getLastMethod() const;
+
+		/**
+		 * Minimum tiles size
+		 * @return the minimum tiles size
+		 */
+		int getTileSize() const;
+
+		/**
+		 * Changes minimum tiles size and invalidates cached kernel
+		 * spectrum
+		 * @param tileSize the new minimum tiles size.
+		 * Tiles are at least twice as large as the kernel
+		 */
+		void setTileSize(const int tileSize);
+
+		/**
+		 * Current tiles DFT size
+		 * @return the tiles DFT size used during last FFT apply
+		 */
+		Size getDftSize() const;
+
+		/**
+		 * Number of threads transforming tiles
+		 * @return the number of threads
+		 */
+		size_t getNbThreads() const;
+
+		/**
+		 * Changes the number of threads transforming tiles
+		 * @param nbThreads the new number of threads
+		 * (0 uses the number of hardware threads)
+		 */
+		void setNbThreads(const size_t nbThreads);
+
+		/**
+		 * Filters an image with kernel as cv::filter2D would do
+		 * @param src the source image (any number of channels)
+		 * @param dst the destination image (same size and channels
+		 * as source)
+		 * @param ddepth destination depth (-1 uses source depth)
+		 * @param borderType border extrapolation method
+		 * (see cv::copyMakeBorder)
+		 */
+		void apply(const Mat & src,
+				   Mat & dst,
+				   const int ddepth = -1,
+				   const int borderType = BORDER_REFLECT_101);
+
+		/**
+		 * Method chosen by AUTO_CONVOLUTION for an image size
+		 * @param imageSize the image size
+		 * @return DIRECT_CONVOLUTION if direct filtering cost is lower
+		 * than estimated FFT cost, OVERLAP_SAVE otherwise
+		 */
+		Method selectMethod(const Size & imageSize) const;
+
+	protected:
+		/**
+		 * Tiles DFT size for an image size : tiles are at least tileSize
+		 * and twice the kernel size, but never larger than the border
+		 * extended image, then rounded to optimal DFT sizes
+		 * @param imageSize the image size
+		 * @return the tiles DFT size
+		 */
+		Size tilesDftSize(const Size & imageSize) const;
+
+		/**
+		 * Estimated FFT filtering cost of one channel
+		 * @param imageSize the image size
+		 * @return the estimated number of operations
+		 */
+		double fftCost(const Size & imageSize) const;
+
+		/**
+		 * Computes kernel spectrum if tiles DFT size changed
+		 * @param imageSize the image size
+		 */
+		void updateKernelSpectrum(const Size & imageSize);
+
+		/**
+		 * Filters extended planes into results planes with overlap-save
+		 * @param imageSize the image size
+		 */
+		void overlapSave(const Size & imageSize);
+
+		/**
+		 * Filters extended planes into results planes with overlap-add
+		 * @param imageSize the image size
+		 */
+		void overlapAdd(const Size & imageSize);
+
+		/**
+		 * Convolves a tile with kernel spectrum in place
+		 * @param tile the zero padded tile to convolve
+		 * @param inputRows number of non zero rows in tile
+		 * @param outputRows number of rows of interest in convolved tile
+		 * @note tile is a single precision DFT sized buffer
+		 */
+		void convolveTile(Mat & tile,
+						  const int inputRows,
+						  const int outputRows) const;
+
+		/**
+		 * Releases tiles results buffers to the plan cache
+		 */
+		void releaseTilesResults();
+};
+
+#endif /* CVFFTCONVOLVER_H_ */
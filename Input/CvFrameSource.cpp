@@ -0,0 +1,243 @@
+/*
+ * CvFrameSource.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include "CvFrameSource.h"
+
+/*
+ * Frame source constructor
+ * @param size frames size
+ * @param frameRate target frame rate or 0 for unthrottled source
+ * @param type frames type
+ */
+CvFrameSource::CvFrameSource(const Size & size,
+							 const double frameRate,
+							 const int type) :
+	VideoCapture(),
+	opened(false),
+	frameRate(frameRate < 0.0 ? 0.0 : frameRate),
+	frameIndex(0),
+	frameSize(size),
+	frameType(type),
+	sizeChanged(true),
+	frame(),
+	zeroCopy(false)
+{
+}
+
+/*
+ * Frame source destructor
+ */
+CvFrameSource::~CvFrameSource()
+{
+	frame.release();
+}
+
+/*
+ * Opened state
+ * @return true if this source has been set up and can provide frames
+ */
+bool CvFrameSource::isOpened() const
+{
+	return opened;
+}
+
+/*
+ * Release this source
+ */
+void CvFrameSource::release()
+{
+	frame.release();
+	opened = false;
+}
+
+/*
+ * Grabs next frame from this source
+ * @return true if next frame has been fetched
+ */
+bool CvFrameSource::grab()
+{
+	if (sizeChanged)
+	{
+		opened = setup();
+		sizeChanged = false;
+	}
+
+	if (!opened)
+	{
+		return false;
+	}
+
+	long count = getFrameCount();
+	if (count == 0)
+	{
+		return false;
+	}
+
+	if (count > 0 && frameIndex >= count)
+	{
+		// finite sources loop
+		frameIndex = 0;
+	}
+
+	bool fetched = fetchFrame(frameIndex);
+	if (fetched)
+	{
+		frameIndex++;
+	}
+
+	return fetched;
+}
+
+/*
+ * Retrieves last grabbed frame
+ * @param image the image to fill with last grabbed frame
+ * @param channel unused
+ * @return true if a frame has been grabbed before
+ */
+bool CvFrameSource::retrieve(Mat & image, int channel)
+{
+	(void) channel;
+
+	if (frame.empty())
+	{
+		image.release();
+		return false;
+	}
+
+	if (zeroCopy)
+	{
+		image = frame;
+	}
+	else
+	{
+		// copyTo does not reallocate image when size and type are unchanged
+		frame.copyTo(image);
+	}
+
+	return true;
+}
+
+/*
+ * Grabs and retrieves next frame
+ * @param image the image to fill with next frame
+ * @return true if next frame has been grabbed and retrieved
+ */
+bool CvFrameSource::read(Mat & image)
+{
+	if (grab())
+	{
+		return retrieve(image);
+	}
+
+	image.release();
+	return false;
+}
+
+/*
+ * Grabs and retrieves next frame
+ * @param image the image to fill with next frame
+ * @return a reference to this source
+ */
+VideoCapture & CvFrameSource::operator >>(Mat & image)
+{
+	read(image);
+	return *this;
+}
+
+/*
+ * Sets a property on this source.
+ * @param propId the property id
+ * @param value the property value
+ * @return true if property has been set
+ */
+bool CvFrameSource::set(int propId, double value)
+{
+	switch (propId)
+	{
+		case CV_CAP_PROP_POS_FRAMES:
+		{
+			long index = (long) value;
+			long count = getFrameCount();
+			if (index < 0 || (count >= 0 && index >= count))
+			{
+				return false;
+			}
+			frameIndex = index;
+			return true;
+		}
+		case CV_CAP_PROP_FRAME_WIDTH:
+			if (!isResizable() || value < 1.0)
+			{
+				return false;
+			}
+			if ((int) value != frameSize.width)
+			{
+				frameSize.width = (int) value;
+				sizeChanged = true;
+			}
+			return true;
+		case CV_CAP_PROP_FRAME_HEIGHT:
+			if (!isResizable() || value < 1.0)
+			{
+				return false;
+			}
+			if ((int) value != frameSize.height)
+			{
+				frameSize.height = (int) value;
+				sizeChanged = true;
+			}
+			return true;
+		case CV_CAP_PROP_FPS:
+			frameRate = value < 0.0 ? 0.0 : value;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Gets a property of this source.
+ * @param propId the property id
+ * @return the property value or 0 if property is not supported
+ */
+double CvFrameSource::get(int propId)
+{
+	switch (propId)
+	{
+		case CV_CAP_PROP_POS_FRAMES:
+			return (double) frameIndex;
+		case CV_CAP_PROP_FRAME_COUNT:
+			return (double) getFrameCount();
+		case CV_CAP_PROP_FRAME_WIDTH:
+			return (double) frameSize.width;
+		case CV_CAP_PROP_FRAME_HEIGHT:
+			return (double) frameSize.height;
+		case CV_CAP_PROP_FPS:
+			return frameRate;
+		default:
+			return 0.0;
+	}
+}
+
+/*
+ * Number of frames of this source
+ * @return the number of frames of this source or -1 if this source
+ * is infinite
+ */
+long CvFrameSource::getFrameCount() const
+{
+	return -1;
+}
+
+/*
+ * Indicates frames size can be changed
+ * @return true if frames size can be changed
+ */
+bool CvFrameSource::isResizable() const
+{
+	return false;
+}
@@ -0,0 +1,243 @@
+/*
+ * CvRawCapture.cpp
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#include <cstdio>	// for sscanf
+#include <cstring>	// for strerror
+#include <cerrno>	// for errno
+#include <iostream>	// for cerr
+using namespace std;
+
+#ifndef _WIN32
+#include <fcntl.h>		// for open
+#include <unistd.h>		// for close
+#include <sys/mman.h>	// for mmap
+#include <sys/stat.h>	// for fstat
+#endif
+
+#include "CvRawCapture.h"
+
+/*
+ * Raw capture constructor
+ * @param path the path to the raw frames file
+ * @param size frames size
+ * @param type frames type (CV_8UC3 for BGR frames)
+ * @param frameRate target frame rate or 0 for unthrottled capture
+ * @param offset offset of the first frame in the file
+ */
+CvRawCapture::CvRawCapture(const string & path,
+						   const Size & size,
+						   const int type,
+						   const double frameRate,
+						   const size_t offset) :
+	CvFrameSource(size, frameRate, type),
+	path(path),
+	fileDescriptor(-1),
+	mapping(NULL),
+	mappingLength(0),
+	offset(offset),
+	frameBytes((size_t) size.area() * CV_ELEM_SIZE(type)),
+	frameCount(0)
+{
+	// frames are served straight from the mapping
+	zeroCopy = true;
+
+	// No dynamic links in constructors, so setup is called here
+	opened = setup();
+	sizeChanged = false;
+}
+
+/*
+ * Raw capture destructor.
+ * Unmaps and closes file
+ */
+CvRawCapture::~CvRawCapture()
+{
+	unmap();
+}
+
+/*
+ * Release this source: unmaps and closes file
+ */
+void CvRawCapture::release()
+{
+	CvFrameSource::release();
+	unmap();
+}
+
+/*
+ * Number of frames in the file
+ * @return the number of frames in the file
+ */
+long CvRawCapture::getFrameCount() const
+{
+	return frameCount;
+}
+
+/*
+ * Parse raw capture specification <path>:<width>x<height>[@<rate>]
+ * @param spec the specification to parse
+ * @param path the parsed path
+ * @param size the parsed frames size
+ * @param frameRate the parsed frame rate
+ * @return true if specification has been parsed successfully
+ */
+bool CvRawCapture::parse(const string & spec,
+						 string & path,
+						 Size & size,
+						 double & frameRate)
+{
+	// path might contain ':' so size is after the last one
+	size_t colonPos = spec.rfind(':');
+	if (colonPos == string::npos || colonPos == 0)
+	{
+		cerr << "CvRawCapture::parse: missing <path>:<width>x<height> in "
+			 << spec << endl;
+		return false;
+	}
+
+	string format = spec.substr(colonPos + 1);
+	int width = 0;
+	int height = 0;
+	double rate = 0.0;
+
+	if (sscanf(format.c_str(), "%dx%d", &width, &height) != 2 ||
+		width <= 0 || height <= 0)
+	{
+		cerr << "CvRawCapture::parse: invalid size in " << spec << endl;
+		return false;
+	}
+
+	size_t atPos = format.find('@');
+	if (atPos != string::npos)
+	{
+		if (sscanf(format.c_str() + atPos + 1, "%lf", &rate) != 1 ||
+			rate < 0.0)
+		{
+			cerr << "CvRawCapture::parse: invalid rate in " << spec << endl;
+			return false;
+		}
+	}
+
+	path = spec.substr(0, colonPos);
+	size = Size(width, height);
+	frameRate = rate;
+
+	return true;
+}
+
+/*
+ * Maps the raw frames file
+ * @return true if file has been mapped and contains at least one frame
+ */
+bool CvRawCapture::setup()
+{
+	unmap();
+
+	if (frameBytes == 0)
+	{
+		cerr << "CvRawCapture::setup: invalid frame size" << endl;
+		return false;
+	}
+
+#ifndef _WIN32
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		cerr << "CvRawCapture::setup: can not open " << path << ": "
+			 << strerror(errno) << endl;
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0)
+	{
+		cerr << "CvRawCapture::setup: can not stat " << path << ": "
+			 << strerror(errno) << endl;
+		unmap();
+		return false;
+	}
+
+	size_t fileSize = (size_t) fileStat.st_size;
+	if (fileSize < offset + frameBytes)
+	{
+		cerr << "CvRawCapture::setup: " << path
+			 << " does not contain a single frame" << endl;
+		unmap();
+		return false;
+	}
+
+	frameCount = (long) ((fileSize - offset) / frameBytes);
+	mappingLength = fileSize;
+
+	/*
+	 * Private mapping: frames can be written to (e.g. drawn into) without
+	 * modifying the file, pages are only copied when written to.
+	 */
+	void * address = mmap(NULL, mappingLength, PROT_READ | PROT_WRITE,
+						  MAP_PRIVATE, fileDescriptor, 0);
+	if (address == MAP_FAILED)
+	{
+		cerr << "CvRawCapture::setup: can not map " << path << ": "
+			 << strerror(errno) << endl;
+		mappingLength = 0;
+		unmap();
+		return false;
+	}
+
+	mapping = (uchar *) address;
+
+	// frames are read sequentially
+	madvise(address, mappingLength, MADV_SEQUENTIAL);
+
+	return true;
+#else
+	cerr << "CvRawCapture::setup: raw capture requires mmap" << endl;
+	return false;
+#endif
+}
+
+/*
+ * Fetch frame at index: sets frame header into the mapping
+ * @param index the index of the frame to fetch
+ * @return true if index is valid
+ */
+bool CvRawCapture::fetchFrame(const long index)
+{
+	if (mapping == NULL || index < 0 || index >= frameCount)
+	{
+		return false;
+	}
+
+	frame = Mat(frameSize, frameType,
+				mapping + offset + (size_t) index * frameBytes);
+
+	return true;
+}
+
+/*
+ * Unmaps and closes file
+ */
+void CvRawCapture::unmap()
+{
+	frame.release();
+	frameCount = 0;
+
+#ifndef _WIN32
+	if (mapping != NULL)
+	{
+		munmap(mapping, mappingLength);
+		mapping = NULL;
+	}
+	mappingLength = 0;
+
+	if (fileDescriptor >= 0)
+	{
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+#endif
+}
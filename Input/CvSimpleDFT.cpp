@@ -7,6 +7,8 @@
 
 #include <limits>
 #include <cmath>
+#include <cstring>	// for memcpy
+#include <stdint.h>	// for int32_t
 
 //#include <iostream>
 //using namespace std;
@@ -25,25 +27,88 @@ const double CvSimpleDFT::minLogScaleFactor = 5.0;
  */
 const double CvSimpleDFT::maxLogScaleFactor = 30.0;
 
+/*
+ * Minimum DFT size for which the row and column passes of each
+ * channel's DFT are split among threads when there are more
+ * threads than channels.
+ * Default value is 512.
+ */
+const int CvSimpleDFT::parallelPassesMinSize = 512;
+
+/*
+ * Maximum number of averaged frames.
+ * Default value is 64.
+ */
+const int CvSimpleDFT::maxAveragingFrames = 64;
+
+/*
+ * Number of frames (rows) shown in spectrogram image.
+ * Default value is 256.
+ */
+const int CvSimpleDFT::spectrogramLength = 256;
+
+/*
+ * OpenCV border types corresponding to padding modes
+ */
+static const int paddingBorderTypes[CvSimpleDFT::NbPaddingModes] =
+{
+	BORDER_CONSTANT,
+	BORDER_REPLICATE,
+	BORDER_REFLECT_101,
+	BORDER_WRAP
+};
+
 /*
  * DFT processor constructor
  * @param sourceImage the source image
+ * @param precision the floating point precision of computations
+ * @param nbThreads number of threads (including the calling
+ * thread) used to transform channels. 0 uses the number of hardware
+ * threads
+ * @param frameMode part of the source frame which is transformed
  */
-CvSimpleDFT::CvSimpleDFT(Mat * sourceImage) :
+CvSimpleDFT::CvSimpleDFT(Mat * sourceImage,
+						 const Precision precision,
+						 const size_t nbThreads,
+						 const FrameMode frameMode) :
 	CvProcessor(sourceImage),
 	minSize(MIN(sourceImage->rows, sourceImage->cols)),
 	maxSize(MAX(sourceImage->rows, sourceImage->cols)),
 	borderSize((maxSize-minSize)/2),
-	optimalDFTSize(getOptimalDFTSize(minSize)),
-	dftSize(optimalDFTSize, optimalDFTSize),
-	inFrameSquare(dftSize, type),
+	optimalDFTSize(0),
+	dftSize(0, 0),
+	frameMode(frameMode < NbFrameModes ? frameMode : SQUARE_FRAME),
+	paddingMode(ZERO_PADDING),
+	precision(precision),
 	logScaleFactor(10.0),
-	spectrumMagnitudeImage(dftSize, type)
+	executor(nbThreads),
+	filterType(NO_FILTER),
+	filterShape(IDEAL_FILTER),
+	filterCutoff(32.0),
+	filterBandWidth(16.0),
+	filterOrder(2),
+	notchOffset(16, 16),
+	kernelSize(0),
+	convolver(Mat(), CvFFTConvolver::AUTO_CONVOLUTION,
+			  CvFFTConvolver::defaultTileSize, nbThreads),
+	averagingMode(NO_AVERAGING),
+	averagingFrames(8),
+	averagedFrames(0),
+	historyIndex(0),
+	spectrogramEnabled(false)
 {
+	updateDftSize();
+	inFrameSquare = CvDFTPlanCache::instance().acquire(dftSize, type);
+	spectrumMagnitudeImage = CvDFTPlanCache::instance().acquire(dftSize, type);
+	filteredImage = CvDFTPlanCache::instance().acquire(dftSize, type,
+		CvDFTPlanCache::INVERSE);
+
 	setup(sourceImage, false);
 
 	addImage("square", &inFrameSquare);
 	addImage("spectrum", &spectrumMagnitudeImage);
+	addImage("filtered", &filteredImage);
+	addImage("spectrogram", &spectrogramImage);
 }
 
 /*
@@ -55,12 +120,16 @@ CvSimpleDFT::~CvSimpleDFT()
 }
 
 /*
- * Setup internal attributes according to source image
+ * Setup internal attributes according to source image.
+ * Optimal DFT size and buffers are obtained from the shared
+ * CvDFTPlanCache
  * @param sourceImage a new source image
  * @param fullSetup full setup is needed when source image is changed
  */
 void CvSimpleDFT::setup(Mat *sourceImage, bool fullSetup)
 {
+	CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+
 	// Full setup starting point (already performed in constructor)
 	if (fullSetup)
 	{
@@ -68,73 +137,62 @@ void CvSimpleDFT::setup(Mat *sourceImage, bool fullSetup)
 		minSize = MIN(sourceImage->rows, sourceImage->cols);
 		maxSize = MAX(sourceImage->rows, sourceImage->cols);
 		borderSize = (maxSize-minSize)/2;
-		optimalDFTSize = getOptimalDFTSize(minSize);
-		dftSize.height = optimalDFTSize;
-		dftSize.width = optimalDFTSize;
-		inFrameSquare = Mat(dftSize, type);
+		updateDftSize();
+		inFrameSquare = cache.acquire(dftSize, type);
 //		logScaleFactor = 10.0;
-		spectrumMagnitudeImage = Mat(dftSize, type);
+		spectrumMagnitudeImage = cache.acquire(dftSize, type);
+		filteredImage = cache.acquire(dftSize, type, CvDFTPlanCache::INVERSE);
 	}
 
 	// Partial setup starting point
+	const int realType = (precision == SINGLE_PRECISION ? CV_32FC1 : CV_64FC1);
 	for (int i=0; i < nbChannels; i++)
 	{
-		channels.push_back(Mat(dftSize, CV_8UC1));
-		channelsDouble.push_back(Mat(dftSize, CV_64FC1));
-		channelsDoubleComplexComponents.push_back(vector<Mat>());
-		channelsComplexImages.push_back(Mat(dftSize, CV_64FC2));
-		channelsComplexSpectrums.push_back(Mat(dftSize, CV_64FC2));
-		channelsComplexSpectrumComponents.push_back(vector<Mat>());
-		channelsSpectrumMagnitude.push_back(Mat(dftSize, CV_64FC1));
-		channelsSpectrumLogMagnitude.push_back(Mat(dftSize, CV_64FC1));
-		channelsSpectrumLogMagnitudeDisplay.push_back(Mat(dftSize, CV_8UC1));
-
-		// complex channels
-		for (int j=0; j < 2; j++)
-		{
-			channelsDoubleComplexComponents[i].push_back(Mat(dftSize, CV_64FC1));
-			channelsComplexSpectrumComponents[i].push_back(Mat(dftSize, CV_64FC1));
-		}
-
-		// fill complex channels of channelsDoubleComplexComponents with 0
-		channelsDoubleComplexComponents[i][1] = Scalar(0.0);
+		channels.push_back(cache.acquire(dftSize, CV_8UC1));
+		channelsReal.push_back(cache.acquire(dftSize, realType));
+		channelsSpectrums.push_back(cache.acquire(dftSize, realType));
+		channelsProcessTime.push_back(0);
 	}
+
+	// Temporal averaging restarts with new sizes
+	lock_guard<mutex> lock(temporalLock);
+	resetAveraging();
+	setupRadialProfile();
 }
 
+/*
+ * Clean up internal atrtibutes before changing source image or
+ * cleaning up class before destruction. Buffers are released
+ * back to the shared CvDFTPlanCache
+ */
 void CvSimpleDFT::cleanup()
 {
+	CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+
 	for (int i=0; i < nbChannels; i++)
 	{
-		// complex channels
-		for (int j=0; j < 2; j++)
-		{
-			channelsComplexSpectrumComponents[i][j].release();
-			channelsDoubleComplexComponents[i][j].release();
-		}
+		cache.release(channelsSpectrums[i]);
+		cache.release(channelsReal[i]);
+		cache.release(channels[i]);
+	}
 
-		channelsSpectrumLogMagnitudeDisplay[i].release();
-		channelsSpectrumLogMagnitude[i].release();
-		channelsSpectrumMagnitude[i].release();
-		channelsComplexSpectrumComponents[i].clear();
-		channelsComplexSpectrums[i].release();
-		channelsComplexImages[i].release();
-		channelsDoubleComplexComponents[i].clear();
-		channelsDouble[i].release();
-		channels[i].release();
-	}
-
-	channelsSpectrumLogMagnitudeDisplay.clear();
-	channelsSpectrumLogMagnitude.clear();
-	channelsSpectrumMagnitude.clear();
-	channelsComplexSpectrumComponents.clear();
-	channelsComplexSpectrums.clear();
-	channelsComplexImages.clear();
-	channelsDoubleComplexComponents.clear();
-	channelsDouble.clear();
+	channelsSpectrums.clear();
+	channelsProcessTime.clear();
+	channelsReal.clear();
 	channels.clear();
 
-	spectrumMagnitudeImage.release();
-	inFrameSquare.release();
+	cache.release(filteredImage, CvDFTPlanCache::INVERSE);
+	cache.release(spectrumMagnitudeImage);
+	cache.release(inFrameSquare);
+
+	{
+		lock_guard<mutex> lock(temporalLock);
+		resetAveraging();
+		radiusIndex.release();
+		radiusCounts.clear();
+		radialProfile.release();
+		spectrogramImage.release();
+	}
 
 	// super cleanup
 	CvProcessor::cleanup();
@@ -146,37 +204,73 @@ void CvSimpleDFT::cleanup()
 void CvSimpleDFT::update()
 {
 //	clog << "CvSimpleDFT::update()" << endl;
+	const int64 start = getTickCount();
 
-	/*
-	 * Crop source image to center square and resize it to nearest
-	 * DFT optimal size
-	 * *sourceImage -> inFrameSquare
-	 */
-	if (sourceImage->cols > sourceImage->rows)
+	// Temporal settings and buffers remain unchanged during update
+	lock_guard<mutex> temporal(temporalLock);
+	prepareTemporal();
+
+	if (frameMode == FULL_FRAME)
 	{
-		// wider than high : resize a colRange(borderSize, borderSize + minSize)
-		// of sourceImage to dftSize in inFrameSquare
-		resize(sourceImage->colRange(borderSize, borderSize + minSize),
-			   inFrameSquare,
-			   dftSize,
-			   0,
-			   0,
-			   INTER_AREA);
+		/*
+		 * Pad whole source image to DFT optimal width and height, source
+		 * being centered (plain copy when source size is already optimal)
+		 * *sourceImage -> inFrameSquare
+		 */
+		const int top = (dftSize.height - sourceImage->rows) / 2;
+		const int left = (dftSize.width - sourceImage->cols) / 2;
+		copyMakeBorder(*sourceImage,
+					   inFrameSquare,
+					   top,
+					   dftSize.height - sourceImage->rows - top,
+					   left,
+					   dftSize.width - sourceImage->cols - left,
+					   paddingBorderTypes[paddingMode],
+					   Scalar::all(0));
 	}
 	else
 	{
-		// higher than wide : resize a rowRange(borderSize, borderSize + minSize)
-		// of sourceImage to dftSize in inFrameSquare
-		resize(sourceImage->rowRange(borderSize, borderSize + minSize),
-			   inFrameSquare,
-			   dftSize,
-			   0,
-			   0,
-			   INTER_AREA);
+		/*
+		 * Crop source image to center square and resize it to nearest
+		 * DFT optimal size (plain copy when square is already optimal)
+		 * *sourceImage -> inFrameSquare
+		 */
+		Mat square;
+		if (sourceImage->cols > sourceImage->rows)
+		{
+			// wider than high : colRange(borderSize, borderSize + minSize)
+			// of sourceImage
+			square = sourceImage->colRange(borderSize, borderSize + minSize);
+		}
+		else
+		{
+			// higher than wide : rowRange(borderSize, borderSize + minSize)
+			// of sourceImage
+			square = sourceImage->rowRange(borderSize, borderSize + minSize);
+		}
+
+		if (minSize == optimalDFTSize)
+		{
+			square.copyTo(inFrameSquare);
+		}
+		else
+		{
+			resize(square, inFrameSquare, dftSize, 0, 0, INTER_AREA);
+		}
+	}
+
+	/*
+	 * Blur input frame with box kernel in place (FFT on tiles for large
+	 * kernels, direct filtering otherwise)
+	 * inFrameSquare -> inFrameSquare
+	 */
+	if (kernelSize > 1)
+	{
+		convolver.apply(inFrameSquare, inFrameSquare);
 	}
 
 	/*
-	 * Split input frame square to individual channels
+	 * Split input frame to individual channels
 	 * inFrameSquare -> channels
 	 */
 	// TODO à compléter ...
@@ -184,91 +278,192 @@ void CvSimpleDFT::update()
 
 
 	// Process each component (1 for gray images, 3 for color images)
-	for (int i=0; i < nbChannels; i++)
+	// with selected precision and filter mask (if any)
+	const Precision currentPrecision = precision;
+	double dcGain = 1.0;
+	const Mat mask =
+		getFilterMask(currentPrecision == SINGLE_PRECISION ? CV_32F : CV_64F,
+					  dcGain);
+	if (mask.empty())
 	{
-		/*
-		 * Fourier transform processing
-		 * 	- Convert uchar center square image to CV_64F real component
-		 * 	- perform frequency shift on real image to obtain low frequencies
-		 * 		in the middle of the DFT image rather than in the corners
-		 * 	- merge real & imag component to complexImage before DFT
-		 * 		imag component could be filled with 0
-		 * 	- compute DFT
-		 * 	- split DFT channels
-		 * 	- compute DFT magnitude from DFT channels
-		 * 	- logScale magnitude with factor (5 to 20)
-		 * 	- convertScaleAbs logMagnitude to CV_8UC1 to display image
-		 *
-		 */
-
-		// convert component to double
-		// channels[] -> channelsDouble
-		// TODO à compléter ...
-        channels[i].convertTo(channelsDouble[i],CV_64FC1);
-
-
-		// Frequency shift channelsDouble to real complex component with
-		// frequencyShift<double>(...)
-		// Frequency shift allow to prepare spatial image components to
-		// produce frequency image later with low frequencies in the center
-		// of frequency image
-		// channelsDouble[] -> channelsDoubleComplexComponents[][0]
-		// TODO à compléter ...
-        frequencyShift<double>(channelsDouble[i],channelsDoubleComplexComponents[i][0]);
+		// No filter : filtered image is the input frame
+		inFrameSquare.copyTo(filteredImage);
+	}
+	// Filtered images with a reduced mean (high pass, band pass) are
+	// centered on mid gray in proportion of the rejected mean
+	const double offset = 128.0 * (1.0 - dcGain);
 
-		// channelsDoubleComplexComponents[i][1] is already filled with 0 in
-		// setup method so frequency shift is not necessary on imaginary part
+	if (executor.getNbThreads() > (size_t) nbChannels &&
+		dftSize.area() >= parallelPassesMinSize * parallelPassesMinSize)
+	{
+		// Not enough channels to keep all threads busy : channels one
+		// after another with each channel passes split among threads
+		for (int i=0; i < nbChannels; i++)
+		{
+			if (currentPrecision == SINGLE_PRECISION)
+			{
+				updateChannel<float>(i, true, mask, offset);
+			}
+			else
+			{
+				updateChannel<double>(i, true, mask, offset);
+			}
+		}
+	}
+	else
+	{
+		// Channels transformed concurrently
+		executor.run(nbChannels, [this, currentPrecision, &mask, offset]
+			(const Range & range)
+		{
+			for (int i = range.start; i < range.end; i++)
+			{
+				if (currentPrecision == SINGLE_PRECISION)
+				{
+					updateChannel<float>(i, false, mask, offset);
+				}
+				else
+				{
+					updateChannel<double>(i, false, mask, offset);
+				}
+			}
+		});
+	}
 
-		// Merge Real and Imaginary into a complex component image
-		// channelsDoubleComplexComponents[] -> channelsComplexImages[]
-		// TODO à compléter ...
+	finishTemporal((float) logScaleFactor);
 
-        cv::merge(channelsDoubleComplexComponents[i],channelsComplexImages[i]);
+	// process time in microseconds
+	processTime = (clock_t) (((double) (getTickCount() - start) * 1e6) /
+							 getTickFrequency());
+}
 
+/*
+ * Optimal dft size for current source image
+ * @return the current optimal dft size
+ */
+int CvSimpleDFT::getOptimalDftSize() const
+{
+	return optimalDFTSize;
+}
 
+/*
+ * DFT size for current source image and frame mode
+ * @return the current dft width and height
+ */
+Size CvSimpleDFT::getDftSize() const
+{
+	return dftSize;
+}
 
-		// Perform Fourier transform (dft) on Complex component image
-		// channelsComplexImages[] -> channelsComplexSpectrums[] with
-		// DFT_COMPLEX_OUTPUT
-		// TODO à compléter ...
-        dft(channelsComplexImages[i],channelsComplexSpectrums[i],DFT_COMPLEX_OUTPUT);
+/*
+ * Get current frame mode
+ * @return the part of the source frame which is transformed
+ */
+CvSimpleDFT::FrameMode CvSimpleDFT::getFrameMode() const
+{
+	return frameMode;
+}
 
+/*
+ * Sets frame mode. Buffers are reallocated to the new DFT size by
+ * setting up source image again
+ * @param frameMode the new frame mode
+ * @warning should be called in the thread running update since
+ * buffers are reallocated without lock
+ */
+void CvSimpleDFT::setFrameMode(const FrameMode frameMode)
+{
+	if (frameMode < NbFrameModes && frameMode != this->frameMode)
+	{
+		this->frameMode = frameMode;
+		setSourceImage(sourceImage);
+	}
+}
 
-		// Split component Complex spectrum to real/imag channels
-		// channelsComplexSpectrums[] -> channelsComplexSpectrumComponents[]
-		// TODO à compléter ...
-        split(channelsComplexSpectrums[i],channelsComplexSpectrumComponents[i]);
+/*
+ * Get current padding mode
+ * @return the border extrapolation used in FULL_FRAME mode
+ */
+CvSimpleDFT::PaddingMode CvSimpleDFT::getPaddingMode() const
+{
+	return paddingMode;
+}
 
-		// Compute component spectrum magnitude
-		// channelsComplexSpectrumComponents[][0 & 1] -> channelsSpectrumMagnitude[]
-        // TODO à compléter ...
-        magnitude(channelsComplexSpectrumComponents[i][0],channelsComplexSpectrumComponents[i][1],channelsSpectrumMagnitude[i]);
+/*
+ * Sets padding mode
+ * @param paddingMode the new border extrapolation used in
+ * FULL_FRAME mode
+ */
+void CvSimpleDFT::setPaddingMode(const PaddingMode paddingMode)
+{
+	if (paddingMode < NbPaddingModes)
+	{
+		this->paddingMode = paddingMode;
+	}
+}
 
-		// Log scale magnitude with logScaleImg<double>(...) and logScaleFactor
-		// channelsSpectrumMagnitude[] -> channelsSpectrumLogMagnitude[]
-		// TODO à compléter ...
-        logScaleImg<double>(channelsSpectrumMagnitude[i],channelsSpectrumLogMagnitude[i],maxLogScaleFactor);
-		// Convert Log scale channels Spectrum to display channels
-		// channelsSpectrumLogMagnitude[] -> channelsSpectrumLogMagnitudeDisplay[]
-		// TODO à compléter ...
-        convertScaleAbs(channelsSpectrumLogMagnitude[i],channelsSpectrumLogMagnitudeDisplay[i],CV_8UC1);
+/*
+ * Get current computations precision
+ * @return the current floating point precision
+ */
+CvSimpleDFT::Precision CvSimpleDFT::getPrecision() const
+{
+	return precision;
+}
 
-    }
+/*
+ * Sets computations precision. Buffers are reallocated with the
+ * new precision during next update.
+ * @param precision the new floating point precision
+ * @warning should be called in the thread running update
+ */
+void CvSimpleDFT::setPrecision(const Precision precision)
+{
+	if (precision < NbPrecisions)
+	{
+		this->precision = precision;
+	}
+}
 
-	// Merge channels spectrum Log magnitude to color spectrum image
-	// channelsSpectrumLogMagnitudeDisplay -> spectrumMagnitudeImage
-	// TODO à compléter ...
-    cv::merge(channelsSpectrumLogMagnitudeDisplay,spectrumMagnitudeImage);
+/*
+ * Number of threads used to transform channels
+ * @return the number of threads including the calling thread
+ */
+size_t CvSimpleDFT::getNbThreads() const
+{
+	return executor.getNbThreads();
+}
 
+/*
+ * Sets the number of threads used to transform channels
+ * @param nbThreads the number of threads including the calling
+ * thread. 0 uses the number of hardware threads
+ */
+void CvSimpleDFT::setNbThreads(const size_t nbThreads)
+{
+	executor.setNbThreads(nbThreads);
+	convolver.setNbThreads(nbThreads);
 }
 
 /*
- * Optimal dft size for current source image
- * @return the current optimal dft size
+ * Get processing time
+ * @param index 0 for the whole update, i > 0 for the
+ * channel i - 1 transform
+ * @return the processing time of last update in microseconds
+ * (or 0 if the channel does not exist)
  */
-int CvSimpleDFT::getOptimalDftSize() const
+double CvSimpleDFT::getProcessTime(const size_t index) const
 {
-	return optimalDFTSize;
+	if (index > 0)
+	{
+		if (index - 1 < channelsProcessTime.size())
+		{
+			return (double) channelsProcessTime[index - 1];
+		}
+		return 0.0;
+	}
+
+	return (double) processTime;
 }
 
 /*
@@ -300,48 +495,1211 @@ void CvSimpleDFT::setLogScaleFactor(double logScaleFactor)
 	}
 }
 
-// --------------------------------------------------------------------
-// Utility methods
-// --------------------------------------------------------------------
 /*
- * Modify image to obtain reverse frequencies on the Fourier transform
- * (low frequencies at the center of the image and high frequencies on
- * the border), or modify image obtained from reverse Fourier transform
- * with reversed frequencies.
- * @param imgIn source image
- * @param imgOut destination image
+ * Get current filter type
+ * @return the current filter type
  */
-template <typename T>
-void CvSimpleDFT::frequencyShift(Mat & imgIn, Mat & imgOut)
+CvSimpleDFT::FilterType CvSimpleDFT::getFilterType() const
 {
-	int i, j;
+	return filterType;
+}
 
-	for (i = 0; i < imgIn.rows; i++)
+/*
+ * Sets filter type
+ * @param filterType the new filter type
+ */
+void CvSimpleDFT::setFilterType(const FilterType filterType)
+{
+	if (filterType < NbFilterTypes)
 	{
-		for (j = 0; j < imgIn.cols; j++)
-		{
-			imgOut.at<T> (i, j) = imgIn.at<T> (i, j) * (T)pow(-1.0, i + j);
-		}
+		lock_guard<mutex> lock(filterLock);
+		this->filterType = filterType;
+		filterMasks.clear();
 	}
 }
 
 /*
- * Log scale T valued image
- * @param imgIn input image
- * @param imgOut output image
- * @param scaleFactor such as
- * \f$ imgOut = scaleFactor \times \log(1 + imgIn)\f$
+ * Get current filter shape
+ * @return the current filter shape
  */
-template <typename T>
-void CvSimpleDFT::logScaleImg(const Mat & imgIn, Mat & imgOut,
-	const T scaleFactor)
+CvSimpleDFT::FilterShape CvSimpleDFT::getFilterShape() const
+{
+	return filterShape;
+}
+
+/*
+ * Sets filter shape
+ * @param filterShape the new filter shape
+ */
+void CvSimpleDFT::setFilterShape(const FilterShape filterShape)
+{
+	if (filterShape < NbFilterShapes)
+	{
+		lock_guard<mutex> lock(filterLock);
+		this->filterShape = filterShape;
+		filterMasks.clear();
+	}
+}
+
+/*
+ * Get current filter cutoff frequency
+ * @return the current filter cutoff in frequency samples
+ */
+double CvSimpleDFT::getFilterCutoff() const
+{
+	return filterCutoff;
+}
+
+/*
+ * Sets filter cutoff frequency
+ * @param cutoff the new cutoff in frequency samples (> 0)
+ */
+void CvSimpleDFT::setFilterCutoff(const double cutoff)
+{
+	if (cutoff > 0.0)
+	{
+		lock_guard<mutex> lock(filterLock);
+		filterCutoff = cutoff;
+		filterMasks.clear();
+	}
+}
+
+/*
+ * Get current band pass filter width
+ * @return the current band width in frequency samples
+ */
+double CvSimpleDFT::getFilterBandWidth() const
+{
+	return filterBandWidth;
+}
+
+/*
+ * Sets band pass filter width
+ * @param bandWidth the new band width in frequency samples (> 0)
+ */
+void CvSimpleDFT::setFilterBandWidth(const double bandWidth)
+{
+	if (bandWidth > 0.0)
+	{
+		lock_guard<mutex> lock(filterLock);
+		filterBandWidth = bandWidth;
+		filterMasks.clear();
+	}
+}
+
+/*
+ * Get current Butterworth filters order
+ * @return the current filter order
+ */
+int CvSimpleDFT::getFilterOrder() const
+{
+	return filterOrder;
+}
+
+/*
+ * Sets Butterworth filters order
+ * @param order the new filter order (>= 1)
+ */
+void CvSimpleDFT::setFilterOrder(const int order)
+{
+	if (order >= 1)
+	{
+		lock_guard<mutex> lock(filterLock);
+		filterOrder = order;
+		filterMasks.clear();
+	}
+}
+
+/*
+ * Get current notches offset from spectrum center
+ * @return the current notches offset in frequency samples
+ */
+Point CvSimpleDFT::getNotchOffset() const
+{
+	return notchOffset;
+}
+
+/*
+ * Sets notches offset from spectrum center
+ * @param offset the new notches offset in frequency samples
+ */
+void CvSimpleDFT::setNotchOffset(const Point & offset)
 {
-	MatConstIterator_<T> inIt = imgIn.begin<T>();
-	MatConstIterator_<T> inItEnd = imgIn.end<T>();
-	MatIterator_<T> outIt = imgOut.begin<T>();
-	MatIterator_<T> outItEnd = imgOut.end<T>();
-	for (; inIt != inItEnd && outIt != outItEnd; ++inIt, ++outIt)
+	lock_guard<mutex> lock(filterLock);
+	notchOffset = offset;
+	filterMasks.clear();
+}
+
+/*
+ * Get current size of the box kernel blurring the frame
+ * @return the current kernel size (0 when frame is not blurred)
+ */
+int CvSimpleDFT::getKernelSize() const
+{
+	return kernelSize;
+}
+
+/*
+ * Sets the size of the normalized box kernel blurring the frame
+ * before its transform
+ * @param size the new kernel size (0 or 1 to disable blur)
+ */
+void CvSimpleDFT::setKernelSize(const int size)
+{
+	if (size > 1)
+	{
+		convolver.setKernel(Mat::ones(size, size, CV_32F) /
+							(double) (size * size));
+		kernelSize = size;
+	}
+	else if (size >= 0)
+	{
+		kernelSize = 0;
+		convolver.setKernel(Mat());
+	}
+}
+
+/*
+ * Get current method of frame blur convolution
+ * @return the current convolution method
+ */
+CvFFTConvolver::Method CvSimpleDFT::getConvolutionMethod() const
+{
+	return convolver.getMethod();
+}
+
+/*
+ * Sets the method of frame blur convolution
+ * @param method the new convolution method
+ */
+void CvSimpleDFT::setConvolutionMethod(const CvFFTConvolver::Method method)
+{
+	convolver.setMethod(method);
+}
+
+/*
+ * Get method used during last frame blur
+ * @return the method used during last frame blur (never
+ * CvFFTConvolver::AUTO_CONVOLUTION)
+ */
+CvFFTConvolver::Method CvSimpleDFT::getLastConvolutionMethod() const
+{
+	return convolver.getLastMethod();
+}
+
+/*
+ * Get current temporal averaging mode
+ * @return the current averaging mode
+ */
+CvSimpleDFT::AveragingMode CvSimpleDFT::getAveragingMode() const
+{
+	return averagingMode;
+}
+
+/*
+ * Sets temporal averaging mode and restarts averaging
+ * @param averagingMode the new averaging mode
+ */
+void CvSimpleDFT::setAveragingMode(const AveragingMode averagingMode)
+{
+	if (averagingMode < NbAveragingModes)
+	{
+		lock_guard<mutex> lock(temporalLock);
+		this->averagingMode = averagingMode;
+		resetAveraging();
+	}
+}
+
+/*
+ * Get number of averaged frames
+ * @return the number of averaged frames (box) or inverse of decay
+ * factor (exponential)
+ */
+int CvSimpleDFT::getAveragingFrames() const
+{
+	return averagingFrames;
+}
+
+/*
+ * Sets number of averaged frames and restarts averaging
+ * @param frames the number of averaged frames (box) or inverse of
+ * decay factor (exponential) in [1..maxAveragingFrames]
+ */
+void CvSimpleDFT::setAveragingFrames(const int frames)
+{
+	if (frames >= 1 && frames <= maxAveragingFrames)
+	{
+		lock_guard<mutex> lock(temporalLock);
+		averagingFrames = frames;
+		resetAveraging();
+	}
+}
+
+/*
+ * Spectrogram computation state
+ * @return true if spectrogram is computed
+ */
+bool CvSimpleDFT::isSpectrogramEnabled() const
+{
+	return spectrogramEnabled;
+}
+
+/*
+ * Enables or disables spectrogram computation. Spectrogram is
+ * cleared when enabled
+ * @param enabled the new spectrogram computation state
+ */
+void CvSimpleDFT::setSpectrogramEnabled(const bool enabled)
+{
+	lock_guard<mutex> lock(temporalLock);
+	if (enabled && !spectrogramEnabled)
 	{
-		(*outIt) = scaleFactor * (T)log(1.0 + (*inIt));
+		spectrogramImage.setTo(Scalar::all(0));
 	}
+	spectrogramEnabled = enabled;
+}
+
+/*
+ * Radially averaged power of last update
+ * @return one row per channel and one column per radius
+ * (CV_64FC1), empty if spectrogram is disabled
+ */
+const Mat & CvSimpleDFT::getRadialProfile() const
+{
+	static const Mat noProfile;
+	return spectrogramEnabled ? radialProfile : noProfile;
+}
+
+// --------------------------------------------------------------------
+// Utility methods
+// --------------------------------------------------------------------
+/*
+ * Computes DFT size according to frame mode and source image size :
+ * optimal size of the center square in SQUARE_FRAME mode or optimal
+ * width and height of the whole source in FULL_FRAME mode
+ */
+void CvSimpleDFT::updateDftSize()
+{
+	CvDFTPlanCache & cache = CvDFTPlanCache::instance();
+
+	if (frameMode == FULL_FRAME)
+	{
+		dftSize.width = cache.getOptimalSize(sourceImage->cols);
+		dftSize.height = cache.getOptimalSize(sourceImage->rows);
+		optimalDFTSize = MAX(dftSize.width, dftSize.height);
+	}
+	else
+	{
+		optimalDFTSize = cache.getOptimalSize(minSize);
+		dftSize.width = optimalDFTSize;
+		dftSize.height = optimalDFTSize;
+	}
+}
+
+/*
+ * Computes radius of each half spectrum element and number of
+ * elements for each radius according to DFT size, then allocates
+ * radial profile and spectrogram
+ */
+void CvSimpleDFT::setupRadialProfile()
+{
+	const int rows = dftSize.height;
+	const int halfCols = dftSize.width / 2;
+	// low frequencies are at the center of the spectrum due to the
+	// frequency shift
+	const double centerU = rows * 0.5;
+	const double centerV = dftSize.width * 0.5;
+	const int nbRadii =
+		cvRound(std::sqrt(centerU * centerU + centerV * centerV)) + 1;
+
+	radiusIndex.create(rows, halfCols + 1, CV_32SC1);
+	radiusCounts.assign(nbRadii, 0);
+
+	for (int u = 0; u < rows; u++)
+	{
+		int * radius = radiusIndex.ptr<int>(u);
+		const double du = u - centerU;
+		for (int v = 0; v <= halfCols; v++)
+		{
+			const double dv = v - centerV;
+			radius[v] = cvRound(std::sqrt(du * du + dv * dv));
+			radiusCounts[radius[v]]++;
+		}
+	}
+
+	radialProfile = Mat::zeros(nbChannels, nbRadii, CV_64FC1);
+	spectrogramImage = Mat::zeros(spectrogramLength, nbRadii,
+								  CV_8UC(nbChannels));
+}
+
+/*
+ * Allocates averaging buffers if needed and clears radial profile
+ * sums before transforming channels
+ */
+void CvSimpleDFT::prepareTemporal()
+{
+	const Size halfSize(dftSize.width / 2 + 1, dftSize.height);
+
+	if (averagingMode != NO_AVERAGING &&
+		channelsAverage.size() != (size_t) nbChannels)
+	{
+		channelsAverage.clear();
+		channelsHistory.clear();
+		for (int i = 0; i < nbChannels; i++)
+		{
+			channelsAverage.push_back(Mat::zeros(halfSize, CV_64FC1));
+			if (averagingMode == BOX_AVERAGING)
+			{
+				vector<Mat> history;
+				for (int f = 0; f < averagingFrames; f++)
+				{
+					history.push_back(Mat::zeros(halfSize, CV_32FC1));
+				}
+				channelsHistory.push_back(history);
+			}
+		}
+		averagedFrames = 0;
+		historyIndex = 0;
+	}
+
+	if (spectrogramEnabled)
+	{
+		radialProfile.setTo(Scalar::all(0));
+	}
+}
+
+/*
+ * Advances averaging history after all channels have been
+ * transformed, then normalizes radial profile sums and appends
+ * them to the spectrogram
+ * @param scaleFactor the log scale factor
+ */
+void CvSimpleDFT::finishTemporal(const float scaleFactor)
+{
+	if (averagingMode != NO_AVERAGING)
+	{
+		averagedFrames = MIN(averagedFrames + 1, averagingFrames);
+		historyIndex = (historyIndex + 1) % averagingFrames;
+	}
+
+	if (spectrogramEnabled && !spectrogramImage.empty())
+	{
+		// Scroll spectrogram one row up (continuous image) and write
+		// current frame in last row
+		const int lastRow = spectrogramImage.rows - 1;
+		memmove(spectrogramImage.ptr<uchar>(0),
+				spectrogramImage.ptr<uchar>(1),
+				spectrogramImage.step * lastRow);
+		uchar * out = spectrogramImage.ptr<uchar>(lastRow);
+		const int cn = spectrogramImage.channels();
+
+		for (int i = 0; i < nbChannels; i++)
+		{
+			double * power = radialProfile.ptr<double>(i);
+			for (int r = 0; r < radialProfile.cols; r++)
+			{
+				if (radiusCounts[r] > 0)
+				{
+					power[r] /= radiusCounts[r];
+				}
+				// log scaled RMS magnitude as in spectrum image
+				out[r * cn + i] = saturate_cast<uchar>(scaleFactor *
+					std::log(1.0 + std::sqrt(power[r])));
+			}
+		}
+	}
+}
+
+/*
+ * Releases averaging buffers so averaging restarts
+ */
+void CvSimpleDFT::resetAveraging()
+{
+	channelsAverage.clear();
+	channelsHistory.clear();
+	averagedFrames = 0;
+	historyIndex = 0;
+}
+
+/*
+ * Filter mask for current filter settings and DFT size from
+ * filterMasks or computed if not already there
+ * @param depth mask depth (CV_32F or CV_64F)
+ * @param dcGain set to the filter response at null frequency
+ * (1 when there is no filter)
+ * @return the filter mask in CCS format or an empty matrix when
+ * there is no filter
+ */
+Mat CvSimpleDFT::getFilterMask(const int depth, double & dcGain)
+{
+	lock_guard<mutex> lock(filterLock);
+
+	if (filterType == NO_FILTER)
+	{
+		dcGain = 1.0;
+		return Mat();
+	}
+
+	dcGain = filterResponse(0.0, 0.0);
+
+	const pair<pair<int, int>, int> key(make_pair(dftSize.width,
+												  dftSize.height),
+										depth);
+	map<pair<pair<int, int>, int>, Mat>::const_iterator it =
+		filterMasks.find(key);
+	if (it != filterMasks.end())
+	{
+		return it->second;
+	}
+
+	Mat mask = ccsFilterMask(dftSize, depth);
+	filterMasks[key] = mask;
+	return mask;
+}
+
+/*
+ * Computes filter mask for current filter settings in CCS format
+ * so it can be directly multiplied element wise by a packed
+ * spectrum : both elements of (Re, Im) pairs hold the same filter
+ * value
+ * @param size the size of the spectrum
+ * @param depth mask depth (CV_32F or CV_64F)
+ * @return the filter mask
+ * @pre filterLock is locked
+ */
+Mat CvSimpleDFT::ccsFilterMask(const Size & size, const int depth) const
+{
+	const int rows = size.height;
+	const int cols = size.width;
+	// low frequencies are at the center of the spectrum due to the
+	// frequency shift
+	const double centerU = rows * 0.5;
+	const double centerV = cols * 0.5;
+	Mat mask(size, CV_64FC1);
+
+	// Inner columns : (Re, Im) pairs
+	for (int u = 0; u < rows; u++)
+	{
+		double * out = mask.ptr<double>(u);
+		for (int v = 1; 2 * v < cols; v++)
+		{
+			const double h = filterResponse(u - centerU, v - centerV);
+			out[2 * v - 1] = h;
+			out[2 * v] = h;
+		}
+	}
+
+	// Columns 0 and cols / 2 (when cols is even) packed along rows
+	const int nbRealColumns = (cols % 2 == 0 && cols > 1) ? 2 : 1;
+	for (int c = 0; c < nbRealColumns; c++)
+	{
+		const int v = (c == 0 ? 0 : cols / 2);
+		const int packedColumn = (c == 0 ? 0 : cols - 1);
+
+		mask.at<double>(0, packedColumn) =
+			filterResponse(-centerU, v - centerV);
+		for (int k = 1; 2 * k < rows; k++)
+		{
+			const double h = filterResponse(k - centerU, v - centerV);
+			mask.at<double>(2 * k - 1, packedColumn) = h;
+			mask.at<double>(2 * k, packedColumn) = h;
+		}
+		if (rows % 2 == 0 && rows > 1)
+		{
+			mask.at<double>(rows - 1, packedColumn) =
+				filterResponse(rows / 2 - centerU, v - centerV);
+		}
+	}
+
+	if (depth != CV_64F)
+	{
+		Mat converted;
+		mask.convertTo(converted, CV_MAKETYPE(depth, 1));
+		return converted;
+	}
+
+	return mask;
+}
+
+/*
+ * Filter response for current filter settings
+ * @param fu vertical frequency from spectrum center
+ * @param fv horizontal frequency from spectrum center
+ * @return the filter response in [0..1]
+ * @pre filterLock is locked
+ */
+double CvSimpleDFT::filterResponse(const double fu, const double fv) const
+{
+	const double distance = std::sqrt(fu * fu + fv * fv);
+
+	switch (filterType)
+	{
+		case LOW_PASS:
+			return lowPassResponse(distance, filterCutoff);
+		case HIGH_PASS:
+			return 1.0 - lowPassResponse(distance, filterCutoff);
+		case BAND_PASS:
+		{
+			// band centered on cutoff : low pass on the distance to the
+			// band center with half band width as cutoff
+			const double halfWidth = filterBandWidth / 2.0;
+			return lowPassResponse(std::abs(distance - filterCutoff),
+								   halfWidth);
+		}
+		case NOTCH:
+		{
+			// high pass around each of the symmetric notches
+			const double du1 = fu - notchOffset.y;
+			const double dv1 = fv - notchOffset.x;
+			const double du2 = fu + notchOffset.y;
+			const double dv2 = fv + notchOffset.x;
+			return (1.0 - lowPassResponse(std::sqrt(du1 * du1 + dv1 * dv1),
+										  filterCutoff)) *
+				(1.0 - lowPassResponse(std::sqrt(du2 * du2 + dv2 * dv2),
+									   filterCutoff));
+		}
+		case NO_FILTER:
+		default:
+			return 1.0;
+	}
+}
+
+/*
+ * Low pass response for current filter shape and order
+ * @param distance distance to filter center
+ * @param cutoff cutoff distance
+ * @return the low pass response in [0..1]
+ */
+double CvSimpleDFT::lowPassResponse(const double distance,
+									const double cutoff) const
+{
+	switch (filterShape)
+	{
+		case BUTTERWORTH_FILTER:
+			return 1.0 / (1.0 + std::pow(distance / cutoff, 2 * filterOrder));
+		case GAUSSIAN_FILTER:
+			return std::exp(-(distance * distance) / (2.0 * cutoff * cutoff));
+		case IDEAL_FILTER:
+		default:
+			return distance <= cutoff ? 1.0 : 0.0;
+	}
+}
+
+/*
+ * Fourier transform of one channel with T valued (float or double)
+ * buffers : conversion, frequency shift, DFT, magnitude, log scale
+ * and conversion for display, then filtering and inverse DFT
+ * @param i the channel index
+ * @param splitPasses when true each step is split among
+ * executor threads : rows for conversion, row DFTs and display,
+ * columns for column DFTs
+ * @param mask the filter mask in CCS format (T valued) or an empty
+ * matrix when there is no filter
+ * @param offset the offset added to the filtered image (see
+ * unshiftedConvert)
+ */
+template <typename T>
+void CvSimpleDFT::updateChannel(const int i,
+								const bool splitPasses,
+								const Mat & mask,
+								const double offset)
+{
+	/*
+	 * Fourier transform processing
+	 * 	- Convert uchar input frame to T real component and
+	 * 		perform frequency shift during this conversion to obtain low
+	 * 		frequencies in the middle of the DFT image rather than in the
+	 * 		corners
+	 * 	- compute real to complex DFT : since input is real, spectrum
+	 * 		is conjugate symmetric and only half of it is computed
+	 * 		and stored in packed (CCS) format
+	 * 	- compute log scaled DFT magnitude (with factor 5 to 30) from the
+	 * 		half spectrum, quantize it to 8 bits directly in the
+	 * 		corresponding channel of the display image and mirror it
+	 * 	- when there is a filter, multiply spectrum by filter mask,
+	 * 		compute inverse DFT and convert it to the corresponding
+	 * 		channel of the filtered image
+	 *
+	 */
+	const int64 start = getTickCount();
+	const float scaleFactor = (float) logScaleFactor;
+	const bool temporal = averagingMode != NO_AVERAGING || spectrogramEnabled;
+	Mat & real = channelsReal[i];
+	Mat & spectrum = channelsSpectrums[i];
+
+	if (!splitPasses)
+	{
+		// convert component to T and frequency shift it in a single pass
+		// with shiftedConvert<T>(...) (buffers are reallocated here when
+		// precision changes).
+		// Frequency shift allow to prepare spatial image components to
+		// produce frequency image later with low frequencies in the center
+		// of frequency image
+		// channels[] -> channelsReal[]
+		shiftedConvert<T>(channels[i], real);
+
+		// Perform real to complex Fourier transform (dft) on real component
+		// image : no imaginary part to merge, half spectrum in CCS format
+		// channelsReal[] -> channelsSpectrums[]
+		dft(real, spectrum);
+
+		// Compute log scaled spectrum magnitude from half spectrum
+		// directly into display image channel, then mirror it
+		// channelsSpectrums[] -> spectrumMagnitudeImage[channel i]
+		// (or temporally averaged magnitude)
+		if (temporal)
+		{
+			ccsTemporalMagnitude<T>(i, scaleFactor);
+		}
+		else
+		{
+			ccsLogMagnitude<T>(spectrum, spectrumMagnitudeImage, i,
+							   scaleFactor);
+		}
+		mirrorSpectrum(spectrumMagnitudeImage, i);
+
+		if (!mask.empty())
+		{
+			// Filter spectrum in place then inverse transform it to real
+			// channelsSpectrums[] -> channelsReal[] -> filteredImage[channel i]
+			multiply(spectrum, mask, spectrum);
+			dft(spectrum, real, DFT_INVERSE | DFT_REAL_OUTPUT | DFT_SCALE);
+			unshiftedConvert<T>(real, filteredImage, i, (T) offset);
+		}
+	}
+	else
+	{
+		// Same steps split among threads. Buffers are (re)allocated
+		// before being shared by threads
+		real.create(dftSize, DataType<T>::type);
+		spectrum.create(dftSize, DataType<T>::type);
+
+		// Rows pass : conversion, frequency shift and rows DFTs
+		// channels[] -> channelsReal[] -> channelsSpectrums[]
+		executor.run(dftSize.height, [this, i, &real, &spectrum]
+			(const Range & rows)
+		{
+			if (!rows.empty())
+			{
+				shiftedConvert<T>(channels[i], real, rows);
+				Mat spectrumRows = spectrum.rowRange(rows);
+				dft(real.rowRange(rows), spectrumRows, DFT_ROWS);
+			}
+		});
+
+		// Columns pass : columns DFTs in place
+		// channelsSpectrums[] -> channelsSpectrums[]
+		executor.run(columnsDFTCount(dftSize.width), [&spectrum]
+			(const Range & columns)
+		{
+			columnsDFT<T>(spectrum, columns);
+		});
+
+		// Log scaled magnitude on half spectrum then mirror : mirrored
+		// rows are computed by other threads, hence two passes
+		// channelsSpectrums[] -> spectrumMagnitudeImage[channel i]
+		executor.run(dftSize.height, [this, i, &spectrum, scaleFactor,
+									  temporal]
+			(const Range & rows)
+		{
+			if (temporal)
+			{
+				ccsTemporalMagnitude<T>(i, scaleFactor, rows);
+			}
+			else
+			{
+				ccsLogMagnitude<T>(spectrum, spectrumMagnitudeImage, i,
+								   scaleFactor, rows);
+			}
+		});
+		// Mirror and filter spectrum in place
+		executor.run(dftSize.height, [this, i, &spectrum, &mask]
+			(const Range & rows)
+		{
+			mirrorSpectrum(spectrumMagnitudeImage, i, rows);
+			if (!mask.empty() && !rows.empty())
+			{
+				Mat spectrumRows = spectrum.rowRange(rows);
+				multiply(spectrumRows, mask.rowRange(rows), spectrumRows);
+			}
+		});
+
+		if (!mask.empty())
+		{
+			// Inverse columns pass then inverse rows pass and conversion
+			// channelsSpectrums[] -> channelsReal[] -> filteredImage[channel i]
+			executor.run(columnsDFTCount(dftSize.width), [&spectrum]
+				(const Range & columns)
+			{
+				columnsDFT<T>(spectrum, columns, true);
+			});
+			executor.run(dftSize.height, [this, i, &real, &spectrum, offset]
+				(const Range & rows)
+			{
+				if (!rows.empty())
+				{
+					Mat realRows = real.rowRange(rows);
+					dft(spectrum.rowRange(rows), realRows,
+						DFT_ROWS | DFT_INVERSE | DFT_REAL_OUTPUT | DFT_SCALE);
+					unshiftedConvert<T>(real, filteredImage, i, (T) offset,
+										rows);
+				}
+			});
+		}
+	}
+
+	// channel process time in microseconds
+	channelsProcessTime[i] =
+		(clock_t) (((double) (getTickCount() - start) * 1e6) /
+				   getTickFrequency());
+}
+
+/*
+ * Column pass of a 2D real to complex DFT on a range of columns :
+ * the spectrum already contains the DFT of each row in CCS format
+ * (see dft with DFT_ROWS) and columns are transformed in place to
+ * obtain the 2D CCS spectrum computed by dft :
+ *	- complex columns (pairs of Re, Im columns) are complex DFTs
+ *	- real columns 0 and cols / 2 (when cols is even) are real DFTs
+ *	packed along rows
+ * @param spectrum the row transformed spectrum (T valued single
+ * channel)
+ * @param columns the range of columns to transform : first
+ * (cols - 1) / 2 indices are complex columns pairs, then column 0
+ * and, when cols is even, column cols - 1
+ * @param inverse performs the inverse (and scaled) columns pass
+ * instead, to be followed by inverse rows DFTs
+ */
+template <typename T>
+void CvSimpleDFT::columnsDFT(Mat & spectrum,
+							 const Range & columns,
+							 const bool inverse)
+{
+	const int rows = spectrum.rows;
+	const int cols = spectrum.cols;
+	const int nbPairs = (cols - 1) / 2;
+	const int pairsEnd = MIN(columns.end, nbPairs);
+
+	// Complex columns : (Re, Im) columns 2p + 1 and 2p + 2 seen as a
+	// complex image, transposed so columns DFTs become rows DFTs
+	if (columns.start < pairsEnd)
+	{
+		Mat pairs(rows,
+				  pairsEnd - columns.start,
+				  CV_MAKETYPE(DataType<T>::depth, 2),
+				  spectrum.ptr<T>(0) + 2 * columns.start + 1,
+				  spectrum.step);
+		Mat transposed;
+		transpose(pairs, transposed);
+		dft(transposed, transposed,
+			DFT_ROWS | (inverse ? DFT_INVERSE | DFT_SCALE : 0));
+		transpose(transposed, pairs);
+	}
+
+	// Real columns 0 and cols - 1 (when cols is even)
+	for (int p = MAX(columns.start, nbPairs); p < columns.end; p++)
+	{
+		Mat column = spectrum.col(p == nbPairs ? 0 : cols - 1);
+		Mat row;
+		Mat packedRow;
+		transpose(column, row);
+		dft(row, packedRow,
+			inverse ? DFT_INVERSE | DFT_REAL_OUTPUT | DFT_SCALE : 0);
+		transpose(packedRow, column);
+	}
+}
+
+/*
+ * Number of columns to transform in columnsDFT
+ * @param cols the number of columns of the spectrum
+ * @return the number of complex columns pairs and real columns
+ */
+int CvSimpleDFT::columnsDFTCount(const int cols)
+{
+	return (cols - 1) / 2 + ((cols % 2 == 0 && cols > 1) ? 2 : 1);
+}
+
+/*
+ * Converts an uchar image to T values and applies the frequency
+ * shift in the same pass, in order to obtain reverse frequencies on the
+ * Fourier transform (low frequencies at the center of the image):
+ * imgOut(i,j) = (-1)^{i+j} . imgIn(i,j)
+ * Based on Z transform property TZ{a^k x_k} = X(z/a) : with a = -1 the
+ * spectrum is offset by half the sampling frequency.
+ * The alternating sign pattern only depends on the parity of
+ * i + j: even rows start with +, odd rows start with -, and signs
+ * alternate along each row, so no power is computed.
+ * @param imgIn source image (CV_8UC1)
+ * @param imgOut destination image (T valued single channel),
+ * (re)allocated if needed
+ * @param rows the range of rows to convert
+ */
+template <typename T>
+void CvSimpleDFT::shiftedConvert(const Mat & imgIn,
+								 Mat & imgOut,
+								 const Range & rows)
+{
+	const int cols = imgIn.cols;
+	const Range range = (rows == Range::all() ? Range(0, imgIn.rows) : rows);
+
+	imgOut.create(imgIn.size(), DataType<T>::type);
+
+	for (int i = range.start; i < range.end; i++)
+	{
+		const uchar * in = imgIn.ptr<uchar>(i);
+		T * out = imgOut.ptr<T>(i);
+		const T sign = (i & 1) ? (T)-1 : (T)1;
+		int j = 0;
+
+		for (; j < cols - 1; j += 2)
+		{
+			out[j] = sign * (T)in[j];
+			out[j + 1] = -sign * (T)in[j + 1];
+		}
+
+		if (j < cols)
+		{
+			out[j] = sign * (T)in[j];
+		}
+	}
+}
+
+/*
+ * Fast natural logarithm approximation for x >= 1 (finite).
+ * x = 2^e . m with m in [sqrt(1/2), sqrt(2)) then
+ * log(m) = 2 atanh(t) with t = (m - 1) / (m + 1), |t| < 0.172, expanded
+ * to t^7 (relative error < 1e-7 on log(m)).
+ * Branch free so loops over rows of values are vectorized by the compiler
+ * @param x the value
+ * @return log(x)
+ */
+static inline float fastLog(const float x)
+{
+	static const int32_t sqrtHalf = 0x3f3504f3; // bits of sqrt(1/2)
+	static const float ln2 = 0.69314718f;
+
+	int32_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	bits -= sqrtHalf;
+	const int32_t e = bits >> 23;
+	bits = (bits & 0x007fffff) + sqrtHalf;
+	float m;
+	memcpy(&m, &bits, sizeof(m));
+
+	const float t = (m - 1.0f) / (m + 1.0f);
+	const float t2 = t * t;
+	const float logm = 2.0f * t *
+		(1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f))));
+
+	return (float) e * ln2 + logm;
+}
+
+/*
+ * Log scaled magnitude of a full spectrum from the packed (CCS)
+ * half spectrum of a real image produced by dft without
+ * DFT_COMPLEX_OUTPUT, directly quantized to 8 bits in one channel
+ * of a display image:
+ * display(u, v) = scaleFactor * log(1 + |Y(u, v)|)
+ * rounded and saturated to [0..255].
+ * Values are computed on the half spectrum (columns 0 to
+ * cols / 2) only, the other half should be mirrored with
+ * mirrorSpectrum once all rows are computed.
+ * @param ccs the packed spectrum (T valued single channel)
+ * @param display the display image (CV_8UC<n> of the same size)
+ * @param channel the channel of display to write
+ * @param scaleFactor the log scale factor
+ * @param rows the range of rows to compute
+ * @par CCS format:
+ *	- columns 1 to (cols - 1) / 2 are stored as (Re, Im) pairs in
+ *	columns 2v - 1 and 2v of each row u
+ *	- columns 0 and cols / 2 (when cols is even, stored in last column)
+ *	are spectra of real columns, hence packed along rows (see
+ *	#packedMagnitude)
+ */
+template <typename T>
+void CvSimpleDFT::ccsLogMagnitude(const Mat & ccs,
+								  Mat & display,
+								  const int channel,
+								  const float scaleFactor,
+								  const Range & rows)
+{
+	const Range range = (rows == Range::all() ? Range(0, ccs.rows) : rows);
+	const int halfCols = ccs.cols / 2;
+	const int cn = display.channels();
+
+	// |Y(u, v)| for v in [0..cols / 2] of current row
+	vector<float> values(halfCols + 1);
+	float * value = &values[0];
+
+	for (int u = range.start; u < range.end; u++)
+	{
+		uchar * out = display.ptr<uchar>(u) + channel;
+
+		ccsMagnitudeRow<T>(ccs, u, value);
+
+		// log scale
+		for (int v = 0; v <= halfCols; v++)
+		{
+			value[v] = scaleFactor * fastLog(1.0f + value[v]);
+		}
+
+		// 8 bits quantization
+		for (int v = 0; v <= halfCols; v++)
+		{
+			out[v * cn] = saturate_cast<uchar>(value[v]);
+		}
+	}
+}
+
+/*
+ * Mirrors the half spectrum (columns 0 to cols / 2) of a display
+ * image channel to the other half since the spectrum
+ * of a real image is conjugate symmetric: |Y(u, v)| = |Y(-u, -v)|
+ * @param display the display image (CV_8UC<n>)
+ * @param channel the channel of display to mirror
+ * @param rows the range of rows to mirror
+ */
+void CvSimpleDFT::mirrorSpectrum(Mat & display,
+								 const int channel,
+								 const Range & rows)
+{
+	const Range range =
+		(rows == Range::all() ? Range(0, display.rows) : rows);
+	const int nbRows = display.rows;
+	const int cols = display.cols;
+	const int halfCols = cols / 2;
+	const int cn = display.channels();
+
+	for (int u = range.start; u < range.end; u++)
+	{
+		uchar * out = display.ptr<uchar>(u) + channel;
+		const uchar * mirror =
+			display.ptr<uchar>(u == 0 ? 0 : nbRows - u) + channel;
+		for (int v = halfCols + 1; v < cols; v++)
+		{
+			out[v * cn] = mirror[(cols - v) * cn];
+		}
+	}
+}
+
+/*
+ * Converts T values of an inverse transform to uchar values in one
+ * channel of a display image. The inverse transform of the frequency
+ * shifted spectrum is the filtered image with the same alternating
+ * signs as shiftedConvert, which are undone by the same sign pattern:
+ * display(i,j) = (-1)^{i+j} . imgIn(i,j) + offset
+ * rounded and saturated to [0..255]. Filters removing low frequencies
+ * (high pass, band pass) produce genuinely negative values around a
+ * null mean, hence the offset.
+ * @param imgIn the inverse transform (T valued single channel)
+ * @param display the display image (CV_8UC<n> of the same size)
+ * @param channel the channel of display to write
+ * @param offset the offset added to values : 128 for a filter
+ * rejecting null frequency, 0 for a filter keeping it
+ * @param rows the range of rows to convert
+ */
+template <typename T>
+void CvSimpleDFT::unshiftedConvert(const Mat & imgIn,
+								   Mat & display,
+								   const int channel,
+								   const T offset,
+								   const Range & rows)
+{
+	const Range range =
+		(rows == Range::all() ? Range(0, imgIn.rows) : rows);
+	const int cols = imgIn.cols;
+	const int cn = display.channels();
+
+	for (int u = range.start; u < range.end; u++)
+	{
+		const T * in = imgIn.ptr<T>(u);
+		uchar * out = display.ptr<uchar>(u) + channel;
+		const T sign = (u & 1) ? (T)-1 : (T)1;
+		int v = 0;
+
+		for (; v < cols - 1; v += 2)
+		{
+			out[v * cn] = saturate_cast<uchar>(sign * in[v] + offset);
+			out[(v + 1) * cn] = saturate_cast<uchar>(offset - sign * in[v + 1]);
+		}
+
+		if (v < cols)
+		{
+			out[v * cn] = saturate_cast<uchar>(sign * in[v] + offset);
+		}
+	}
+}
+
+/*
+ * Temporally averaged log scaled magnitude of a channel half
+ * spectrum directly quantized to 8 bits in the corresponding
+ * channel of the display image (see ccsLogMagnitude). In the
+ * same pass, current frame magnitudes update running averages
+ * in place (constant cost per frame whatever the number of
+ * averaged frames) and, when spectrogram is enabled, their
+ * squares are accumulated in the radial profile of the channel
+ * according to radiusIndex. The other half should be mirrored
+ * with mirrorSpectrum once all rows are computed.
+ * @param i the channel index
+ * @param scaleFactor the log scale factor
+ * @param rows the range of rows to compute
+ * @pre temporalLock is locked and prepareTemporal has been called
+ */
+template <typename T>
+void CvSimpleDFT::ccsTemporalMagnitude(const int i,
+									   const float scaleFactor,
+									   const Range & rows)
+{
+	const Mat & ccs = channelsSpectrums[i];
+	const Range range = (rows == Range::all() ? Range(0, ccs.rows) : rows);
+	if (range.empty())
+	{
+		return;
+	}
+
+	const int halfCols = ccs.cols / 2;
+	const int cn = spectrumMagnitudeImage.channels();
+	// current frame is the (averagedFrames + 1)th averaged frame
+	const int nbAveraged = MIN(averagedFrames + 1, averagingFrames);
+	const double invCount = 1.0 / nbAveraged;
+	const double decay = (averagedFrames == 0 ? 1.0 : 1.0 / averagingFrames);
+
+	// |Y(u, v)| for v in [0..cols / 2] of current row
+	vector<float> values(halfCols + 1);
+	float * value = &values[0];
+	// radial power sums of this range of rows
+	vector<double> powerSums(spectrogramEnabled ? radialProfile.cols : 0, 0.0);
+
+	for (int u = range.start; u < range.end; u++)
+	{
+		uchar * out = spectrumMagnitudeImage.ptr<uchar>(u) + i;
+
+		ccsMagnitudeRow<T>(ccs, u, value);
+
+		// radial power of current frame
+		if (spectrogramEnabled)
+		{
+			const int * radius = radiusIndex.ptr<int>(u);
+			for (int v = 0; v <= halfCols; v++)
+			{
+				powerSums[radius[v]] += (double) value[v] * (double) value[v];
+			}
+		}
+
+		// running averages updated in place
+		switch (averagingMode)
+		{
+			case BOX_AVERAGING:
+			{
+				// running sum : adds current frame, removes the frame it
+				// replaces in history
+				double * sum = channelsAverage[i].ptr<double>(u);
+				float * oldest = channelsHistory[i][historyIndex].ptr<float>(u);
+				for (int v = 0; v <= halfCols; v++)
+				{
+					sum[v] += (double) value[v] - (double) oldest[v];
+					oldest[v] = value[v];
+					value[v] = (float) (sum[v] * invCount);
+				}
+				break;
+			}
+			case EXPONENTIAL_AVERAGING:
+			{
+				double * mean = channelsAverage[i].ptr<double>(u);
+				for (int v = 0; v <= halfCols; v++)
+				{
+					mean[v] += decay * ((double) value[v] - mean[v]);
+					value[v] = (float) mean[v];
+				}
+				break;
+			}
+			case NO_AVERAGING:
+			default:
+				break;
+		}
+
+		// log scale and 8 bits quantization
+		for (int v = 0; v <= halfCols; v++)
+		{
+			out[v * cn] = saturate_cast<uchar>(scaleFactor *
+											   fastLog(1.0f + value[v]));
+		}
+	}
+
+	if (spectrogramEnabled)
+	{
+		lock_guard<mutex> lock(profileLock);
+		double * profile = radialProfile.ptr<double>(i);
+		for (size_t r = 0; r < powerSums.size(); r++)
+		{
+			profile[r] += powerSums[r];
+		}
+	}
+}
+
+/*
+ * Magnitudes of one row of a packed (CCS) spectrum on the half
+ * spectrum (columns 0 to cols / 2)
+ * @param ccs the packed spectrum (T valued single channel)
+ * @param u the row of the spectrum
+ * @param magnitude the cols / 2 + 1 magnitudes to compute
+ */
+template <typename T>
+void CvSimpleDFT::ccsMagnitudeRow(const Mat & ccs,
+								  const int u,
+								  float * magnitude)
+{
+	const T * in = ccs.ptr<T>(u);
+	const int cols = ccs.cols;
+
+	// Columns 0 and cols / 2 packed along rows
+	magnitude[0] = (float) packedMagnitude<T>(ccs, u, 0);
+	if ((cols % 2 == 0) && (cols > 1))
+	{
+		magnitude[cols / 2] = (float) packedMagnitude<T>(ccs, u, cols - 1);
+	}
+
+	// Inner columns : (Re, Im) pairs
+	for (int v = 1; 2 * v < cols; v++)
+	{
+		const T re = in[2 * v - 1];
+		const T im = in[2 * v];
+		magnitude[v] = (float) std::sqrt(re * re + im * im);
+	}
+}
+
+/*
+ * Magnitude of a row of the packed (CCS) spectrum columns 0 or
+ * cols / 2 (when cols is even) which are spectra of real columns,
+ * hence packed along rows: row 0 holds Re Y(0, v), rows 2k - 1 and 2k
+ * hold Re and Im of Y(k, v) and the last row holds Re Y(rows / 2, v)
+ * when rows is even. Since these columns are spectra of real columns
+ * |Y(k, v)| = |Y(rows - k, v)|.
+ * @param ccs the packed spectrum (T valued single channel)
+ * @param u the row of the spectrum
+ * @param packedColumn the packed column (0 or cols - 1)
+ * @return |Y(u, v)| for v = 0 or v = cols / 2
+ */
+template <typename T>
+T CvSimpleDFT::packedMagnitude(const Mat & ccs,
+							   const int u,
+							   const int packedColumn)
+{
+	const int rows = ccs.rows;
+
+	if (u == 0)
+	{
+		return std::abs(ccs.at<T>(0, packedColumn));
+	}
+
+	if ((rows % 2 == 0) && (2 * u == rows))
+	{
+		return std::abs(ccs.at<T>(rows - 1, packedColumn));
+	}
+
+	const int k = (2 * u < rows ? u : rows - u);
+	const T re = ccs.at<T>(2 * k - 1, packedColumn);
+	const T im = ccs.at<T>(2 * k, packedColumn);
+
+	return std::sqrt(re * re + im * im);
 }
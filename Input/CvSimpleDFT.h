@@ -9,12 +9,17 @@
 #define CVDFT_H_
 
 #include <vector>
+#include <map>
+#include <mutex>
 using namespace std;
 
 #include <opencv/cv.h>
 using namespace cv;
 
 #include "CvProcessor.h"
+#include "CvBandExecutor.h"
+#include "CvDFTPlanCache.h"
+#include "CvFFTConvolver.h"
 
 /**
  * Class to compute DFT on input image
@@ -22,6 +27,79 @@ using namespace cv;
 class CvSimpleDFT : virtual public CvProcessor
 {
 	public:
+		/**
+		 * Floating point precision of Fourier transform computations
+		 */
+		typedef enum
+		{
+			DOUBLE_PRECISION = 0,	//!< computations with doubles (CV_64F)
+			SINGLE_PRECISION,		//!< computations with floats (CV_32F)
+			NbPrecisions			//!< Number of precisions
+		} Precision;
+
+		/**
+		 * Part of the source frame which is transformed
+		 */
+		typedef enum
+		{
+			SQUARE_FRAME = 0,	//!< center square of source resized to
+								//!< optimal DFT size
+			FULL_FRAME,			//!< whole source padded to optimal DFT
+								//!< width and height
+			NbFrameModes		//!< Number of frame modes
+		} FrameMode;
+
+		/**
+		 * Border extrapolation of the padding added around the source
+		 * frame in FULL_FRAME mode
+		 */
+		typedef enum
+		{
+			ZERO_PADDING = 0,	//!< black borders (BORDER_CONSTANT)
+			REPLICATE_PADDING,	//!< edge pixels repeated (BORDER_REPLICATE)
+			REFLECT_PADDING,	//!< mirrored borders (BORDER_REFLECT_101)
+			WRAP_PADDING,		//!< periodic borders (BORDER_WRAP)
+			NbPaddingModes		//!< Number of padding modes
+		} PaddingMode;
+
+		/**
+		 * Temporal averaging of spectrum magnitude before display
+		 */
+		typedef enum
+		{
+			NO_AVERAGING = 0,		//!< current frame magnitude only
+			BOX_AVERAGING,			//!< mean of the last averagingFrames frames
+			EXPONENTIAL_AVERAGING,	//!< exponential decay of
+									//!< 1 / averagingFrames
+			NbAveragingModes		//!< Number of averaging modes
+		} AveragingMode;
+
+		/**
+		 * Frequency domain filters applied on spectrum before inverse
+		 * transform to filtered image
+		 */
+		typedef enum
+		{
+			NO_FILTER = 0,	//!< no filtering: filtered image is input frame
+			LOW_PASS,		//!< keeps frequencies below cutoff
+			HIGH_PASS,		//!< keeps frequencies above cutoff
+			BAND_PASS,		//!< keeps a band of bandWidth centered on cutoff
+			NOTCH,			//!< rejects frequencies within cutoff of
+							//!< +/- notch offset
+			NbFilterTypes	//!< Number of filter types
+		} FilterType;
+
+		/**
+		 * Transition shape of frequency domain filters
+		 */
+		typedef enum
+		{
+			IDEAL_FILTER = 0,	//!< sharp transition (0 or 1)
+			BUTTERWORTH_FILTER,	//!< Butterworth transition of filter order
+			GAUSSIAN_FILTER,	//!< Gaussian transition
+			NbFilterShapes		//!< Number of filter shapes
+		} FilterShape;
+
 		/**
 		 * Minimum log scale factor.
 		 * Default value is 5.
@@ -34,6 +112,26 @@ class CvSimpleDFT : virtual public CvProcessor
 		 */
 		static const double maxLogScaleFactor;
 
+		/**
+		 * Minimum DFT size for which the row and column passes of each
+		 * channel's DFT are split among threads when there are more
+		 * threads than channels.
+		 * Default value is 512.
+		 */
+		static const int parallelPassesMinSize;
+
+		/**
+		 * Maximum number of averaged frames.
+		 * Default value is 64.
+		 */
+		static const int maxAveragingFrames;
+
+		/**
+		 * Number of frames (rows) shown in spectrogram image.
+		 * Default value is 256.
+		 */
+		static const int spectrogramLength;
+
 	protected:
 		/**
 		 * Minimum of source image rows & cols for cropping source
@@ -51,17 +149,30 @@ class CvSimpleDFT : virtual public CvProcessor
 		int borderSize;
 
 		/**
-		 * DFT optimal size
+		 * DFT optimal size (largest dimension of #dftSize)
 		 */
 		int optimalDFTSize;
 
 		/**
-		 * Optimal Fourier size
+		 * Optimal Fourier size : square in SQUARE_FRAME mode, optimal
+		 * width and height in FULL_FRAME mode
 		 */
 		Size dftSize;
 
 		/**
-		 * Input frame cropped to square size for FFT: CV_8UC<nbChannels>
+		 * Part of the source frame which is transformed
+		 */
+		FrameMode frameMode;
+
+		/**
+		 * Border extrapolation of the padding in FULL_FRAME mode
+		 */
+		PaddingMode paddingMode;
+
+		/**
+		 * Input frame for FFT: CV_8UC<nbChannels>. Source cropped to
+		 * square and resized in SQUARE_FRAME mode or source padded to
+		 * #dftSize in FULL_FRAME mode
 		 */
 		Mat inFrameSquare;
 
@@ -71,65 +182,208 @@ class CvSimpleDFT : virtual public CvProcessor
 		vector<Mat> channels;
 
 		/**
-		 * Input frame square channels converted to doubles: CV_64FC1 x <nbChannels>
+		 * Precision used to compute Fourier transforms and spectra
+		 */
+		Precision precision;
+
+		/**
+		 * Input frame square channels converted to floating point values
+		 * and frequency shifted: CV_64FC1 or CV_32FC1 (according to
+		 * #precision) x <nbChannels>
 		 */
-		vector<Mat> channelsDouble;
+		vector<Mat> channelsReal;
 
 		/**
-		 * Input frame square channels complex channels:
-		 * CV_64FC1 x 2 x <nbChannels>
+		 * Packed (CCS) half spectrum of real channels computed by a real
+		 * to complex DFT: CV_64FC1 or CV_32FC1 x <nbChannels>
 		 */
-		vector<vector<Mat> > channelsDoubleComplexComponents;
+		vector<Mat> channelsSpectrums;
 
 		/**
-		 * Input frame square complex image: CV_64FC2 x <nbChannels>
+		 * LogScale factor to apply on log magnitude to show spectrum.
 		 */
-		vector<Mat> channelsComplexImages;
+		double logScaleFactor;
 
 		/**
-		 * Complex spectrum images: CV_64FC2 x <nbChannels>
+		 * Workers pool transforming channels concurrently or splitting
+		 * the row and column passes of large DFTs
 		 */
-		vector<Mat> channelsComplexSpectrums;
+		CvBandExecutor executor;
 
 		/**
-		 * Complex spectrum channels: CV_64FC1 x 2 x <nbChannels>
+		 * Processing time of each channel during last update in
+		 * microseconds
 		 */
-		vector<vector<Mat> > channelsComplexSpectrumComponents;
+		vector<clock_t> channelsProcessTime;
 
 		/**
-		 * Spectrum magnitude: CV_64FC1 x <nbChannels>
+		 * [Log] spectrum magnitude image converted for display:
+		 * CV_8UC<nbChannels>. Each channel is directly written from
+		 * the corresponding packed spectrum by #ccsLogMagnitude
 		 */
-		vector<Mat> channelsSpectrumMagnitude;
+		Mat spectrumMagnitudeImage;
 
 		/**
-		 * LogScale factor to apply on log magnitude to show spectrum.
+		 * Current filter type
 		 */
-		double logScaleFactor;
+		FilterType filterType;
 
 		/**
-		 * log spectrum magnitude: CV_64FC1 x <nbChannels>
+		 * Current filter shape
 		 */
-		vector<Mat> channelsSpectrumLogMagnitude;
+		FilterShape filterShape;
 
 		/**
-		 * [Log] spectrum magnitude channels converted for display:
-		 * CV_8UC1 x <nbChannels>
+		 * Filter cutoff frequency (distance to spectrum center in
+		 * frequency samples) : cutoff of low and high pass filters,
+		 * center of band pass filter and radius of notches
 		 */
-		vector<Mat> channelsSpectrumLogMagnitudeDisplay;
+		double filterCutoff;
 
 		/**
-		 * [Log] spectrum magnitude image converted for display:
+		 * Width of band pass filter in frequency samples
+		 */
+		double filterBandWidth;
+
+		/**
+		 * Order of Butterworth filters
+		 */
+		int filterOrder;
+
+		/**
+		 * Offset of notches from spectrum center in frequency samples
+		 * (notches are located at +/- offset)
+		 */
+		Point notchOffset;
+
+		/**
+		 * Size of the normalized box kernel blurring the frame before its
+		 * transform (0 when the frame is not blurred)
+		 */
+		int kernelSize;
+
+		/**
+		 * Convolution engine blurring the frame : FFT on tiles for large
+		 * kernels or direct filtering for small ones
+		 */
+		CvFFTConvolver convolver;
+
+		/**
+		 * Filter masks for current filter settings in CCS format
+		 * (see #ccsFilterMask) keyed by ((dft width, dft height), depth)
+		 * so they are computed only once per size. Masks are cleared each
+		 * time filter settings change
+		 */
+		map<pair<pair<int, int>, int>, Mat> filterMasks;
+
+		/**
+		 * Lock on filter settings and masks which can be changed while
+		 * update is in progress
+		 */
+		mutable mutex filterLock;
+
+		/**
+		 * Filtered image : inverse transform of filtered spectrum
 		 * CV_8UC<nbChannels>
 		 */
-		Mat spectrumMagnitudeImage;
+		Mat filteredImage;
+
+		/**
+		 * Current temporal averaging mode
+		 */
+		AveragingMode averagingMode;
+
+		/**
+		 * Number of averaged frames in BOX_AVERAGING mode or inverse of
+		 * decay factor in EXPONENTIAL_AVERAGING mode
+		 */
+		int averagingFrames;
+
+		/**
+		 * Number of frames accumulated in averages so far (up to
+		 * #averagingFrames)
+		 */
+		int averagedFrames;
+
+		/**
+		 * Slot of #channelsHistory replaced by current frame in
+		 * BOX_AVERAGING mode
+		 */
+		int historyIndex;
+
+		/**
+		 * Running averages of half spectrum magnitudes (columns 0 to
+		 * cols / 2): running sum of the last frames in BOX_AVERAGING
+		 * mode or exponential mean in EXPONENTIAL_AVERAGING mode:
+		 * CV_64FC1 x <nbChannels>
+		 */
+		vector<Mat> channelsAverage;
+
+		/**
+		 * Half spectrum magnitudes of the last #averagingFrames frames in
+		 * BOX_AVERAGING mode so the oldest can be removed from running
+		 * sums : CV_32FC1 x averagingFrames x <nbChannels>
+		 */
+		vector<vector<Mat> > channelsHistory;
+
+		/**
+		 * Spectrogram computation enabled
+		 */
+		bool spectrogramEnabled;
+
+		/**
+		 * Radius (distance to spectrum center rounded to nearest integer)
+		 * of each half spectrum element : CV_32SC1. Precomputed once per
+		 * DFT size so radial power is accumulated in the same pass as
+		 * magnitude
+		 */
+		Mat radiusIndex;
+
+		/**
+		 * Number of half spectrum elements for each radius
+		 */
+		vector<int> radiusCounts;
+
+		/**
+		 * Radially averaged power of each channel during last update :
+		 * CV_64FC1 with one row per channel and one column per radius
+		 */
+		Mat radialProfile;
+
+		/**
+		 * Lock on radial profile sums which are accumulated by several
+		 * threads when passes are split
+		 */
+		mutex profileLock;
+
+		/**
+		 * Spectrogram image : log scaled radial profile of each frame,
+		 * newest frame at the bottom : CV_8UC<nbChannels> with
+		 * #spectrogramLength rows and one column per radius
+		 */
+		Mat spectrogramImage;
+
+		/**
+		 * Lock on temporal settings and buffers which can be changed
+		 * while update is in progress
+		 */
+		mutable mutex temporalLock;
 
 	public:
 		/**
 		 * DFT processor constructor
 		 * @param sourceImage the source image
+		 * @param precision the floating point precision of computations
+		 * @param nbThreads number of threads (including the calling
+		 * thread) used to transform channels. 0 uses the number of hardware
+		 * threads
+		 * @param frameMode part of the source frame which is transformed
 		 * @pre source image is not NULL
 		 */
-		CvSimpleDFT(Mat * sourceImage);
+		CvSimpleDFT(Mat * sourceImage,
+					const Precision precision = DOUBLE_PRECISION,
+					const size_t nbThreads = 1,
+					const FrameMode frameMode = SQUARE_FRAME);
 
 		/**
 		 * DFT Processor destructor
@@ -139,18 +393,31 @@ class CvSimpleDFT : virtual public CvProcessor
 		/**
 		 * DFT Update.
 		 * Steps in update
-		 * 	- crop source image to a square according to optima FFT size
-		 * 	- split in frame square into color channels
-		 *	- converts these color channels to double
-		 *	- apply frequency shift on double channels to
+		 * 	- crop source image to a square and resize it to optimal FFT
+		 * 	size (SQUARE_FRAME mode, no resize when the square is
+		 * 	already optimal) or pad the whole source image to optimal FFT
+		 * 	width and height (FULL_FRAME mode)
+		 * 	- blur in frame with the box kernel when kernel size is
+		 * 	greater than 1 (FFT on tiles or direct filtering)
+		 * 	- split in frame into color channels
+		 *	- converts these color channels to double or float according to
+		 *	precision and apply frequency shift during this conversion to
 		 *		- produce the shifted real component of source channels
 		 *		- produce later a spectrum with low frequencies at image center
-		 *	- merge real/image channels into complex image per channel
-		 *	- compute dft on each channel
-		 *	- split channels complex spectrum in to real/imag components
-		 *	- compute channels spectrum magnitude from real/imag components
-		 *	- log scale channels spectrum magnitude
-		 *	- converts channels log magnitude for display
+		 *	- compute real to complex dft on each channel producing a packed
+		 *	(CCS) half spectrum. Channels are transformed concurrently, or,
+		 *	when there are more threads than channels and DFT size is at
+		 *	least #parallelPassesMinSize squared, one after another with rows and
+		 *	columns passes split among threads
+		 *	- compute log scaled channels spectrum magnitude from the half
+		 *	spectrum, quantized for display in the corresponding channel of
+		 *	the spectrum image, and mirror it to obtain the full spectrum
+		 *	- when a filter is selected, multiply the packed spectrum by
+		 *	the filter mask and compute the inverse dft to the filtered
+		 *	image
+		 *	- when averaging or spectrogram is enabled, magnitude is
+		 *	averaged over frames before display and radial power is
+		 *	accumulated in the same pass, then appended to the spectrogram
 		 */
 		virtual void update();
 
@@ -164,6 +431,76 @@ class CvSimpleDFT : virtual public CvProcessor
 		 */
 		int getOptimalDftSize() const;
 
+		/**
+		 * DFT size for current source image and frame mode
+		 * @return the current dft width and height
+		 */
+		Size getDftSize() const;
+
+		/**
+		 * Get current frame mode
+		 * @return the part of the source frame which is transformed
+		 */
+		FrameMode getFrameMode() const;
+
+		/**
+		 * Sets frame mode. Buffers are reallocated to the new DFT size by
+		 * setting up source image again
+		 * @param frameMode the new frame mode
+		 * @warning should be called in the thread running #update since
+		 * buffers are reallocated without lock
+		 */
+		virtual void setFrameMode(const FrameMode frameMode);
+
+		/**
+		 * Get current padding mode
+		 * @return the border extrapolation used in FULL_FRAME mode
+		 */
+		PaddingMode getPaddingMode() const;
+
+		/**
+		 * Sets padding mode
+		 * @param paddingMode the new border extrapolation used in
+		 * FULL_FRAME mode
+		 */
+		virtual void setPaddingMode(const PaddingMode paddingMode);
+
+		/**
+		 * Get current computations precision
+		 * @return the current floating point precision
+		 */
+		Precision getPrecision() const;
+
+		/**
+		 * Sets computations precision. Buffers are reallocated with the
+		 * new precision during next update.
+		 * @param precision the new floating point precision
+		 * @warning should be called in the thread running #update
+		 */
+		virtual void setPrecision(const Precision precision);
+
+		/**
+		 * Number of threads used to transform channels
+		 * @return the number of threads including the calling thread
+		 */
+		size_t getNbThreads() const;
+
+		/**
+		 * Sets the number of threads used to transform channels
+		 * @param nbThreads the number of threads including the calling
+		 * thread. 0 uses the number of hardware threads
+		 */
+		virtual void setNbThreads(const size_t nbThreads);
+
+		/**
+		 * Get processing time
+		 * @param index 0 for the whole update, i > 0 for the
+		 * channel i - 1 transform
+		 * @return the processing time of last update in microseconds
+		 * (or 0 if the channel does not exist)
+		 */
+		double getProcessTime(const size_t index = 0) const;
+
 		/**
 		 * Get current log scale factor
 		 * @return the current log scale factor
@@ -176,6 +513,156 @@ class CvSimpleDFT : virtual public CvProcessor
 		 */
 		virtual void setLogScaleFactor(double logScaleFactor);
 
+		/**
+		 * Get current filter type
+		 * @return the current filter type
+		 */
+		FilterType getFilterType() const;
+
+		/**
+		 * Sets filter type
+		 * @param filterType the new filter type
+		 */
+		virtual void setFilterType(const FilterType filterType);
+
+		/**
+		 * Get current filter shape
+		 * @return the current filter shape
+		 */
+		FilterShape getFilterShape() const;
+
+		/**
+		 * Sets filter shape
+		 * @param filterShape the new filter shape
+		 */
+		virtual void setFilterShape(const FilterShape filterShape);
+
+		/**
+		 * Get current filter cutoff frequency
+		 * @return the current filter cutoff in frequency samples
+		 */
+		double getFilterCutoff() const;
+
+		/**
+		 * Sets filter cutoff frequency
+		 * @param cutoff the new cutoff in frequency samples (> 0)
+		 */
+		virtual void setFilterCutoff(const double cutoff);
+
+		/**
+		 * Get current band pass filter width
+		 * @return the current band width in frequency samples
+		 */
+		double getFilterBandWidth() const;
+
+		/**
+		 * Sets band pass filter width
+		 * @param bandWidth the new band width in frequency samples (> 0)
+		 */
+		virtual void setFilterBandWidth(const double bandWidth);
+
+		/**
+		 * Get current Butterworth filters order
+		 * @return the current filter order
+		 */
+		int getFilterOrder() const;
+
+		/**
+		 * Sets Butterworth filters order
+		 * @param order the new filter order (>= 1)
+		 */
+		virtual void setFilterOrder(const int order);
+
+		/**
+		 * Get current notches offset from spectrum center
+		 * @return the current notches offset in frequency samples
+		 */
+		Point getNotchOffset() const;
+
+		/**
+		 * Sets notches offset from spectrum center
+		 * @param offset the new notches offset in frequency samples
+		 */
+		virtual void setNotchOffset(const Point & offset);
+
+		/**
+		 * Get current size of the box kernel blurring the frame
+		 * @return the current kernel size (0 when frame is not blurred)
+		 */
+		int getKernelSize() const;
+
+		/**
+		 * Sets the size of the normalized box kernel blurring the frame
+		 * before its transform
+		 * @param size the new kernel size (0 or 1 to disable blur)
+		 */
+		virtual void setKernelSize(const int size);
+
+		/**
+		 * Get current method of frame blur convolution
+		 * @return the current convolution method
+		 */
+		CvFFTConvolver::Method getConvolutionMethod() const;
+
+		/**
+		 * Sets the method of frame blur convolution
+		 * @param method the new convolution method
+		 */
+		virtual void setConvolutionMethod(const CvFFTConvolver::Method method);
+
+		/**
+		 * Get method used during last frame blur
+		 * @return the method used during last frame blur (never
+		 * CvFFTConvolver::AUTO_CONVOLUTION)
+		 */
+		CvFFTConvolver::Method getLastConvolutionMethod() const;
+
+		/**
+		 * Get current temporal averaging mode
+		 * @return the current averaging mode
+		 */
+		AveragingMode getAveragingMode() const;
+
+		/**
+		 * Sets temporal averaging mode and restarts averaging
+		 * @param averagingMode the new averaging mode
+		 */
+		virtual void setAveragingMode(const AveragingMode averagingMode);
+
+		/**
+		 * Get number of averaged frames
+		 * @return the number of averaged frames (box) or inverse of decay
+		 * factor (exponential)
+		 */
+		int getAveragingFrames() const;
+
+		/**
+		 * Sets number of averaged frames and restarts averaging
+		 * @param frames the number of averaged frames (box) or inverse of
+		 * decay factor (exponential) in [1..#maxAveragingFrames]
+		 */
+		virtual void setAveragingFrames(const int frames);
+
+		/**
+		 * Spectrogram computation state
+		 * @return true if spectrogram is computed
+		 */
+		bool isSpectrogramEnabled() const;
+
+		/**
+		 * Enables or disables spectrogram computation. Spectrogram is
+		 * cleared when enabled
+		 * @param enabled the new spectrogram computation state
+		 */
+		virtual void setSpectrogramEnabled(const bool enabled);
+
+		/**
+		 * Radially averaged power of last update
+		 * @return one row per channel and one column per radius
+		 * (CV_64FC1), empty if spectrogram is disabled
+		 */
+		const Mat & getRadialProfile() const;
+
 	protected:
 
 		// --------------------------------------------------------------------
@@ -183,7 +670,9 @@ class CvSimpleDFT : virtual public CvProcessor
 		// --------------------------------------------------------------------
 
 		/**
-		 * Setup internal attributes according to source image
+		 * Setup internal attributes according to source image.
+		 * Optimal DFT size and buffers are obtained from the shared
+		 * CvDFTPlanCache
 		 * @param sourceImage a new source image
 		 * @param fullSetup full setup is needed when source image is changed
 		 */
@@ -191,7 +680,8 @@ class CvSimpleDFT : virtual public CvProcessor
 
 		/**
 		 * Clean up internal atrtibutes before changing source image or
-		 * cleaning up class before destruction
+		 * cleaning up class before destruction. Buffers are released
+		 * back to the shared CvDFTPlanCache
 		 */
 		void cleanup();
 
@@ -199,12 +689,140 @@ class CvSimpleDFT : virtual public CvProcessor
 		// Utility methods
 		// --------------------------------------------------------------------
 		/**
-		 * Modify image to obtain reverse frequencies on the Fourier transform
-		 * (low frequencies at the center of the image and high frequencies on
-		 * the border), or modify image obtained from reverse Fourier transform
-		 * with reversed frequencies.
-		 * @param imgIn source image
-		 * @param imgOut destination image
+		 * Computes DFT size according to frame mode and source image size :
+		 * optimal size of the center square in SQUARE_FRAME mode or optimal
+		 * width and height of the whole source in FULL_FRAME mode
+		 */
+		void updateDftSize();
+
+		/**
+		 * Computes radius of each half spectrum element and number of
+		 * elements for each radius according to DFT size, then allocates
+		 * radial profile and spectrogram
+		 */
+		void setupRadialProfile();
+
+		/**
+		 * Allocates averaging buffers if needed and clears radial profile
+		 * sums before transforming channels
+		 * @pre temporalLock is locked
+		 */
+		void prepareTemporal();
+
+		/**
+		 * Advances averaging history after all channels have been
+		 * transformed, then normalizes radial profile sums and appends
+		 * them to the spectrogram
+		 * @param scaleFactor the log scale factor
+		 * @pre temporalLock is locked
+		 */
+		void finishTemporal(const float scaleFactor);
+
+		/**
+		 * Releases averaging buffers so averaging restarts
+		 * @pre temporalLock is locked
+		 */
+		void resetAveraging();
+
+		/**
+		 * Fourier transform of one channel with T valued (float or double)
+		 * buffers : conversion, frequency shift, DFT, magnitude, log scale
+		 * and conversion for display
+		 * @param i the channel index
+		 * @param splitPasses when true each step is split among
+		 * #executor threads : rows for conversion, row DFTs and display,
+		 * columns for column DFTs
+		 * @param mask the filter mask in CCS format (T valued) or an empty
+		 * matrix when there is no filter
+		 * @param offset the offset added to the filtered image (see
+		 * #unshiftedConvert)
+		 */
+		template <typename T>
+		void updateChannel(const int i,
+						   const bool splitPasses,
+						   const Mat & mask,
+						   const double offset);
+
+		/**
+		 * Filter mask for current filter settings and DFT size from
+		 * #filterMasks or computed if not already there
+		 * @param depth mask depth (CV_32F or CV_64F)
+		 * @param dcGain set to the filter response at null frequency
+		 * (1 when there is no filter)
+		 * @return the filter mask in CCS format or an empty matrix when
+		 * there is no filter
+		 */
+		Mat getFilterMask(const int depth, double & dcGain);
+
+		/**
+		 * Computes filter mask for current filter settings in CCS format
+		 * so it can be directly multiplied element wise by a packed
+		 * spectrum : both elements of (Re, Im) pairs hold the same filter
+		 * value
+		 * @param size the size of the spectrum
+		 * @param depth mask depth (CV_32F or CV_64F)
+		 * @return the filter mask
+		 * @pre filterLock is locked
+		 */
+		Mat ccsFilterMask(const Size & size, const int depth) const;
+
+		/**
+		 * Filter response for current filter settings
+		 * @param fu vertical frequency from spectrum center
+		 * @param fv horizontal frequency from spectrum center
+		 * @return the filter response in [0..1]
+		 * @pre filterLock is locked
+		 */
+		double filterResponse(const double fu, const double fv) const;
+
+		/**
+		 * Low pass response for current filter shape and order
+		 * @param distance distance to filter center
+		 * @param cutoff cutoff distance
+		 * @return the low pass response in [0..1]
+		 */
+		double lowPassResponse(const double distance,
+							   const double cutoff) const;
+
+		/**
+		 * Column pass of a 2D real to complex DFT on a range of columns :
+		 * the spectrum already contains the DFT of each row in CCS format
+		 * (see dft with DFT_ROWS) and columns are transformed in place to
+		 * obtain the 2D CCS spectrum computed by dft :
+		 *	- complex columns (pairs of Re, Im columns) are complex DFTs
+		 *	- real columns 0 and cols / 2 (when cols is even) are real DFTs
+		 *	packed along rows
+		 * @param spectrum the row transformed spectrum (T valued single
+		 * channel)
+		 * @param columns the range of columns to transform : first
+		 * (cols - 1) / 2 indices are complex columns pairs, then column 0
+		 * and, when cols is even, column cols - 1
+		 * @param inverse performs the inverse (and scaled) columns pass
+		 * instead, to be followed by inverse rows DFTs
+		 */
+		template <typename T>
+		static void columnsDFT(Mat & spectrum,
+							   const Range & columns,
+							   const bool inverse = false);
+
+		/**
+		 * Number of columns to transform in #columnsDFT
+		 * @param cols the number of columns of the spectrum
+		 * @return the number of complex columns pairs and real columns
+		 */
+		static int columnsDFTCount(const int cols);
+
+		/**
+		 * Converts an uchar image to T values and applies the frequency
+		 * shift in the same pass, in order to obtain reverse frequencies
+		 * on the Fourier transform (low frequencies at the center of the
+		 * image and high frequencies on the border):
+		 * \f[
+		 * imgOut(i,j) = (-1)^{i+j} \cdot imgIn(i,j)
+		 * \f]
+		 * The alternating sign pattern only depends on the parity of
+		 * i + j: even rows start with +, odd rows start with -, and signs
+		 * alternate along each row, so no power is computed.
 		 * @par Algorithm:
 		 * This is based on the following property of the Z transform :
 		 * \f[
@@ -238,19 +856,125 @@ class CvSimpleDFT : virtual public CvProcessor
 		 * \f]
 		 * \f$f_{e}\f$ is at the center of the spectrum image in 2D, which
 		 * means, low frequencies will be located at the center of the image.
+		 * @param imgIn source image (CV_8UC1)
+		 * @param imgOut destination image (T valued single channel),
+		 * (re)allocated if needed
+		 * @param rows the range of rows to convert
+		 */
+		template <typename T>
+		void shiftedConvert(const Mat & imgIn,
+							Mat & imgOut,
+							const Range & rows = Range::all());
+
+		/**
+		 * Log scaled magnitude of a full spectrum from the packed (CCS)
+		 * half spectrum of a real image produced by dft without
+		 * DFT_COMPLEX_OUTPUT, directly quantized to 8 bits in one channel
+		 * of a display image:
+		 * \f[
+		 * display(u, v) = scaleFactor \times \log(1 + |Y(u, v)|)
+		 * \f]
+		 * rounded and saturated to [0..255].
+		 * Values are computed on the half spectrum (columns 0 to
+		 * cols / 2) only, the other half should be mirrored with
+		 * #mirrorSpectrum once all rows are computed.
+		 * @param ccs the packed spectrum (T valued single channel)
+		 * @param display the display image (CV_8UC<n> of the same size)
+		 * @param channel the channel of display to write
+		 * @param scaleFactor the log scale factor
+		 * @param rows the range of rows to compute
+		 */
+		template <typename T>
+		void ccsLogMagnitude(const Mat & ccs,
+							 Mat & display,
+							 const int channel,
+							 const float scaleFactor,
+							 const Range & rows = Range::all());
+
+		/**
+		 * Mirrors the half spectrum (columns 0 to cols / 2) of a display
+		 * image channel to the other half since the spectrum
+		 * of a real image is conjugate symmetric:
+		 * \f$|Y(u, v)| = |Y(-u, -v)|\f$
+		 * @param display the display image (CV_8UC<n>)
+		 * @param channel the channel of display to mirror
+		 * @param rows the range of rows to mirror
+		 */
+		static void mirrorSpectrum(Mat & display,
+								   const int channel,
+								   const Range & rows = Range::all());
+
+		/**
+		 * Converts T values of an inverse transform to uchar values in one
+		 * channel of a display image. The inverse transform of the
+		 * frequency shifted spectrum is the filtered image with the same
+		 * alternating signs as #shiftedConvert, which are undone by the
+		 * same sign pattern:
+		 * \f[
+		 * display(i,j) = (-1)^{i+j} \cdot imgIn(i,j) + offset
+		 * \f]
+		 * rounded and saturated to [0..255]. Filters removing low
+		 * frequencies (high pass, band pass) produce genuinely negative
+		 * values around a null mean, hence the offset.
+		 * @param imgIn the inverse transform (T valued single channel)
+		 * @param display the display image (CV_8UC<n> of the same size)
+		 * @param channel the channel of display to write
+		 * @param offset the offset added to values : 128 for a filter
+		 * rejecting null frequency, 0 for a filter keeping it
+		 * @param rows the range of rows to convert
+		 */
+		template <typename T>
+		static void unshiftedConvert(const Mat & imgIn,
+									 Mat & display,
+									 const int channel,
+									 const T offset,
+									 const Range & rows = Range::all());
+
+		/**
+		 * Temporally averaged log scaled magnitude of a channel half
+		 * spectrum directly quantized to 8 bits in the corresponding
+		 * channel of the display image (see #ccsLogMagnitude). In the
+		 * same pass, current frame magnitudes update running averages
+		 * in place (constant cost per frame whatever the number of
+		 * averaged frames) and, when spectrogram is enabled, their
+		 * squares are accumulated in the radial profile of the channel
+		 * according to #radiusIndex. The other half should be mirrored
+		 * with #mirrorSpectrum once all rows are computed.
+		 * @param i the channel index
+		 * @param scaleFactor the log scale factor
+		 * @param rows the range of rows to compute
+		 * @pre temporalLock is locked and #prepareTemporal has been called
+		 */
+		template <typename T>
+		void ccsTemporalMagnitude(const int i,
+								  const float scaleFactor,
+								  const Range & rows = Range::all());
+
+		/**
+		 * Magnitudes of one row of a packed (CCS) spectrum on the half
+		 * spectrum (columns 0 to cols / 2)
+		 * @param ccs the packed spectrum (T valued single channel)
+		 * @param u the row of the spectrum
+		 * @param magnitude the cols / 2 + 1 magnitudes to compute
 		 */
 		template <typename T>
-		void frequencyShift(Mat & imgIn, Mat & imgOut);
+		static void ccsMagnitudeRow(const Mat & ccs,
+									const int u,
+									float * magnitude);
 
 		/**
-		 * Log scale T valued image
-		 * @param imgIn input image
-		 * @param imgOut output image
-		 * @param scaleFactor such as
-		 * \f$ imgOut = scaleFactor \times \log(1 + imgIn)\f$
+		 * Magnitude of a row of the packed (CCS) spectrum columns 0 or
+		 * cols / 2 (when cols is even) which are spectra of real columns,
+		 * hence packed along rows
+		 * @param ccs the packed spectrum (T valued single channel)
+		 * @param u the row of the spectrum
+		 * @param packedColumn the packed column (0 or cols - 1)
+		 * @return |Y(u, v)| for v = 0 or v = cols / 2
 		 */
 		template <typename T>
-		void logScaleImg(const Mat & imgIn, Mat & imgOut, const T scaleFactor);
+		static T packedMagnitude(const Mat & ccs,
+								 const int u,
+								 const int packedColumn);
 };
 
 #endif /* CVDFT_H_ */
@@ -0,0 +1,162 @@
+/*
+ * CvSyntheticCapture.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef CVSYNTHETICCAPTURE_H_
+#define CVSYNTHETICCAPTURE_H_
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "CvFrameSource.h"
+
+/**
+ * Synthetic frame source generating deterministic BGR frames without any
+ * camera or codec, in order to benchmark processors end to end.
+ * All frames are generated once into a preallocated pool when the source is
+ * set up (or resized), then grabbing a frame only copies a pool frame, so
+ * the cost of the source itself is close to the cost of a camera driver
+ * copy. Frames loop over the pool, and a given (size, pattern, pool size,
+ * seed) always produces the same frames sequence.
+ */
+class CvSyntheticCapture : public CvFrameSource
+{
+	public:
+		/**
+		 * Synthetic frames patterns
+		 */
+		typedef enum
+		{
+			GRADIENT = 0,	//!< color gradients slowly cycling
+			NOISE,			//!< uniform color noise
+			MOVING,			//!< moving bars and disc over a gradient
+			NBPATTERNS
+		} Pattern;
+
+	protected:
+		/**
+		 * Current pattern
+		 */
+		Pattern pattern;
+
+		/**
+		 * Preallocated frames pool
+		 */
+		vector<Mat> pool;
+
+		/**
+		 * Maximum number of frames in the pool
+		 */
+		size_t maxPoolSize;
+
+		/**
+		 * Number of frames in the pool for current frames size :
+		 * maxPoolSize frames limited to poolBudget bytes
+		 */
+		size_t poolSize;
+
+		/**
+		 * Random seed used by NOISE pattern
+		 */
+		uint64 seed;
+
+		/**
+		 * Default maximum number of frames in the pool
+		 */
+		static const size_t defaultPoolSize;
+
+		/**
+		 * Maximum number of bytes used by the frames pool (at least one
+		 * frame is always generated)
+		 */
+		static const size_t poolBudget;
+
+		/**
+		 * Patterns names used by #parse
+		 */
+		static const char * patternNames[NBPATTERNS];
+
+	public:
+		/**
+		 * Synthetic capture constructor
+		 * @param size frames size
+		 * @param frameRate target frame rate or 0 for unthrottled capture
+		 * @param pattern the pattern to generate
+		 * @param poolSize maximum number of distinct frames to generate
+		 * (limited by #poolBudget)
+		 * @param seed random seed used by NOISE pattern
+		 */
+		CvSyntheticCapture(const Size & size,
+						   const double frameRate = 0.0,
+						   const Pattern pattern = MOVING,
+						   const size_t poolSize = defaultPoolSize,
+						   const uint64 seed = 0);
+
+		/**
+		 * Synthetic capture destructor
+		 */
+		virtual ~CvSyntheticCapture();
+
+		/**
+		 * Pattern accessor
+		 * @return the current pattern
+		 */
+		Pattern getPattern() const;
+
+		/**
+		 * Synthetic frames can be resized
+		 * @return true
+		 */
+		bool isResizable() const;
+
+		/**
+		 * Parse synthetic capture specification
+		 * <width>x<height>[@<rate>][:<pattern>] where pattern is one of
+		 * gradient, noise or moving (e.g. 1920x1080@120:noise). A missing
+		 * or 0 rate means unthrottled capture and a missing pattern means
+		 * moving pattern.
+		 * @param spec the specification to parse
+		 * @param size the parsed frames size
+		 * @param frameRate the parsed frame rate
+		 * @param pattern the parsed pattern
+		 * @return true if specification has been parsed successfully
+		 */
+		static bool parse(const string & spec,
+						  Size & size,
+						  double & frameRate,
+						  Pattern & pattern);
+
+		/**
+		 * Pattern name
+		 * @param pattern the pattern
+		 * @return the name of the pattern
+		 */
+		static const char * patternName(const Pattern pattern);
+
+	protected:
+		/**
+		 * Allocates and fills frames pool for current size
+		 * @return true if frames pool has been generated
+		 */
+		bool setup();
+
+		/**
+		 * Fetch frame at index from frames pool
+		 * @param index the index of the frame to fetch
+		 * @return true
+		 */
+		bool fetchFrame(const long index);
+
+		/**
+		 * Generates pool frame
+		 * @param index index of the frame in the pool
+		 * @param image the image to fill
+		 */
+		void generate(const size_t index, Mat & image) const;
+};
+
+#endif /* CVSYNTHETICCAPTURE_H_ */
@@ -27,12 +27,20 @@ MODULES = CvProcessor \
 	QcvProcessor \
 	CvSimpleDFT \
 	QcvSimpleDFT \
+	CvBandExecutor \
+	CvDFTPlanCache \
+	CvFFTConvolver \
 	QcvMatWidget \
 	QcvMatWidgetLabel \
 	QcvMatWidgetImage \
 	QcvMatWidgetGL \
 	QGLImageRender \
 	QcvVideoCapture \
+	QcvCapturePool \
+	CvFrameSource \
+	CvSyntheticCapture \
+	CvRawCapture \
+	CvImageSequenceCapture \
 	CaptureFactory \
 	mainwindow
 for(f, MODULES){
@@ -0,0 +1,164 @@
+/*
+ * QcvCapturePool.h
+ *
+ *  Created on: 18 oct. 2026
+ *	  Author: davidroussel
+ */
+
+#ifndef QCVCAPTUREPOOL_H_
+#define QCVCAPTUREPOOL_H_
+
+#include <vector>
+using namespace std;
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QString>
+
+#include "QcvVideoCapture.h"
+
+/**
+ * Pool of captures sharing a fixed number of update threads.
+ * Instead of running each capture in its own thread, captures are
+ * distributed (round robin) on a small set of worker threads, which is
+ * required when many streams (cameras or files) are opened at once.
+ * The pool owns both its threads and its captures and provides per stream
+ * and aggregate capture statistics.
+ */
+class QcvCapturePool : public QObject
+{
+	Q_OBJECT
+
+	protected:
+		/**
+		 * The worker threads shared by captures (might be empty in which
+		 * case captures are updated in the current thread)
+		 */
+		vector<QThread *> threads;
+
+		/**
+		 * The captures managed by this pool
+		 */
+		vector<QcvVideoCapture *> captures;
+
+		/**
+		 * Index of the next thread to hand out in #nextThread
+		 */
+		size_t threadIndex;
+
+		/**
+		 * Timer used to periodically report statistics
+		 */
+		QTimer * reportTimer;
+
+		/**
+		 * Indicates threads have been stopped
+		 */
+		bool stopped;
+
+	public:
+		/**
+		 * Capture pool constructor
+		 * @param nbThreads the number of worker threads to share among
+		 * captures. 0 means captures are updated in the current thread.
+		 * @param parent the parent QObject
+		 */
+		QcvCapturePool(const size_t nbThreads = 0, QObject * parent = NULL);
+
+		/**
+		 * Capture pool destructor.
+		 * Stops worker threads, then deletes captures and threads
+		 */
+		virtual ~QcvCapturePool();
+
+		/**
+		 * Number of worker threads accessor
+		 * @return the number of worker threads
+		 */
+		size_t getNbThreads() const;
+
+		/**
+		 * Number of streams accessor
+		 * @return the number of captures in this pool
+		 */
+		size_t getNbStreams() const;
+
+		/**
+		 * Provides the thread the next capture should be run in
+		 * (round robin among worker threads)
+		 * @return the next worker thread or NULL if this pool has no threads
+		 */
+		QThread * nextThread();
+
+		/**
+		 * Adds a capture to this pool. The pool takes ownership of the
+		 * capture. Since its thread is shared, the capture should not quit
+		 * its thread when finished, so this connection is removed.
+		 * @param capture the capture to add
+		 */
+		void addCapture(QcvVideoCapture * capture);
+
+		/**
+		 * Capture accessor
+		 * @param index the index of the stream
+		 * @return the capture at this index or NULL if index is out of bounds
+		 */
+		QcvVideoCapture * getCapture(const size_t index) const;
+
+		/**
+		 * Per stream statistics accessor
+		 * @param index the index of the stream
+		 * @return the statistics of this stream
+		 */
+		QcvVideoCapture::Statistics getStatistics(const size_t index) const;
+
+		/**
+		 * Aggregate statistics of all streams: frames counts and frame rates
+		 * are summed, latency is averaged over streams
+		 * @return the aggregate statistics
+		 */
+		QcvVideoCapture::Statistics getAggregateStatistics() const;
+
+		/**
+		 * Builds a text report of aggregate and per stream statistics
+		 * @param perStream include per stream statistics
+		 * @return the statistics report
+		 */
+		QString statisticsReport(const bool perStream = false) const;
+
+		/**
+		 * Stops (quit and wait) all worker threads.
+		 * Should be called before deleting processors sharing these threads
+		 */
+		void stop();
+
+	public slots:
+		/**
+		 * Sets statistics report interval
+		 * @param interval the interval between reports in ms or 0 to stop
+		 * reporting
+		 */
+		void setReportInterval(const int interval);
+
+		/**
+		 * Resets statistics of all streams
+		 */
+		void resetStatistics();
+
+	protected slots:
+		/**
+		 * Emits #messageChanged with aggregate statistics report
+		 */
+		void report();
+
+	signals:
+		/**
+		 * Signal to send statistics report
+		 * @param message the message
+		 * @param timeout number of ms the message should be displayed
+		 */
+		void messageChanged(const QString & message, int timeout = 0);
+};
+
+#endif /* QCVCAPTUREPOOL_H_ */
@@ -5,6 +5,10 @@
  *	  Author: davidroussel
  */
 #include <QtDebug>
+#if QT_VERSION >= 0x050000
+#include <QGuiApplication>
+#include <QScreen>
+#endif
 #include "QcvMatWidget.h"
 
 /*
@@ -27,6 +31,16 @@ const Scalar QcvMatWidget::drawingColor(0xFF,0xCC,0x00,0x88);
  */
 const int QcvMatWidget::drawingWidth(3);
 
+/*
+ * Default display refresh rate : 0 (screen refresh rate)
+ */
+double QcvMatWidget::defaultDisplayRate = 0.0;
+
+/*
+ * Refresh rate to use when screen refresh rate is unknown
+ */
+double QcvMatWidget::fallbackDisplayRate = 60.0;
+
 /*
  * OpenCV QT Widget default constructor
  * @param parent parent widget
@@ -38,7 +52,16 @@ QcvMatWidget::QcvMatWidget(QWidget *parent,
 	sourceImage(NULL),
 	aspectRatio(defaultAspectRatio),
 	mousePressed(false),
-	mouseSense(mouseSense)
+	mouseSense(mouseSense),
+	frameDirty(false),
+	refreshTimer(new QTimer(this)),
+	displayRate(defaultDisplayRate),
+	paintedFrames(0),
+	skippedFrames(0),
+	previewEnabled(false),
+	previewFactor(1),
+	previewScale(1.0),
+	previewValid(false)
 //	count(0)
 {
 	setup();
@@ -57,7 +80,16 @@ QcvMatWidget::QcvMatWidget(Mat * sourceImage,
 	sourceImage(sourceImage),
 	aspectRatio((double)sourceImage->cols / (double)sourceImage->rows),
 	mousePressed(false),
-	mouseSense(mouseSense)
+	mouseSense(mouseSense),
+	frameDirty(false),
+	refreshTimer(new QTimer(this)),
+	displayRate(defaultDisplayRate),
+	paintedFrames(0),
+	skippedFrames(0),
+	previewEnabled(false),
+	previewFactor(1),
+	previewScale(1.0),
+	previewValid(false)
 //	count(0)
 {
 	setup();
@@ -81,6 +113,10 @@ void QcvMatWidget::paintEvent(QPaintEvent * event)
 {
 	Q_UNUSED(event);
 
+	// Lazy conversion of the last source image update (if any)
+	convertIfDirty();
+	paintClock.restart();
+
 	if (displayImage.data != NULL)
 	{
 		// evt draw in image
@@ -122,6 +158,12 @@ void QcvMatWidget::setup()
 	layout = new QHBoxLayout();
 	layout->setContentsMargins(0,0,0,0);
 	setLayout(layout);
+
+	refreshTimer->setSingleShot(true);
+#if QT_VERSION >= 0x050000
+	refreshTimer->setTimerType(Qt::PreciseTimer);
+#endif
+	connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
 }
 
 /*
@@ -138,6 +180,9 @@ void QcvMatWidget::setSourceImage(Mat * sourceImage)
 	aspectRatio = (double)sourceImage->cols / (double)sourceImage->rows;
 	// qDebug ("aspect ratio changed to %4.2f", aspectRatio);
 
+	// new source image needs to be converted
+	frameDirty = true;
+	previewValid = false;
 }
 
 /*
@@ -152,6 +197,8 @@ void QcvMatWidget::convertImage()
 	int depth = sourceImage->depth();
 	int channels = sourceImage->channels();
 
+	updatePreviewFactor();
+
 	// Converts any image type to RGB format
 	switch (depth)
 	{
@@ -159,10 +206,26 @@ void QcvMatWidget::convertImage()
 			switch (channels)
 			{
 				case 1: // gray level image
-					cvtColor(*sourceImage, displayImage,CV_GRAY2RGB);
+					if (previewFactor > 1)
+					{
+						downscaleToRGB(*sourceImage, displayImage,
+									   previewFactor, previewSums);
+					}
+					else
+					{
+						cvtColor(*sourceImage, displayImage,CV_GRAY2RGB);
+					}
 					break;
 				case 3: // Color image (OpenCV produces BGR images)
-					cvtColor(*sourceImage, displayImage, CV_BGR2RGB);
+					if (previewFactor > 1)
+					{
+						downscaleToRGB(*sourceImage, displayImage,
+									   previewFactor, previewSums);
+					}
+					else
+					{
+						cvtColor(*sourceImage, displayImage, CV_BGR2RGB);
+					}
 					break;
 				default:
 					qFatal("This number of channels (%d) is not supported",
@@ -177,6 +240,186 @@ void QcvMatWidget::convertImage()
 	}
 }
 
+/*
+ * Computes #previewScale and #previewFactor from current widget size
+ * and source image size if they are not valid anymore
+ */
+void QcvMatWidget::updatePreviewFactor()
+{
+	if (previewValid)
+	{
+		return;
+	}
+
+	previewFactor = 1;
+	previewScale = 1.0;
+
+	if (previewEnabled && (sourceImage != NULL) &&
+		(sourceImage->cols > 0) && (sourceImage->rows > 0) &&
+		(width() > 0) && (height() > 0))
+	{
+		// scale fitting the whole source image in the widget
+		double scale = MIN((double) width() / (double) sourceImage->cols,
+						   (double) height() / (double) sourceImage->rows);
+		if (scale < 1.0)
+		{
+			previewScale = scale;
+			// box filter down to at least the preview size, painter
+			// performs the remaining downscale
+			previewFactor = MAX(1, (int) (1.0 / scale));
+		}
+	}
+
+	previewValid = true;
+}
+
+/*
+ * Area of the widget where display image is drawn : the source image
+ * size scaled by previewScale for a preview, or the display image size
+ * otherwise
+ * @return the display image area in widget coordinates
+ */
+QRect QcvMatWidget::previewRect() const
+{
+	if (previewScale < 1.0 && sourceImage != NULL)
+	{
+		return QRect(0, 0,
+					 MAX(1, cvRound(sourceImage->cols * previewScale)),
+					 MAX(1, cvRound(sourceImage->rows * previewScale)));
+	}
+
+	return QRect(0, 0, displayImage.cols, displayImage.rows);
+}
+
+/*
+ * Resize event reimplemented to invalidate downscaled preview
+ * @param event the resize event
+ */
+void QcvMatWidget::resizeEvent(QResizeEvent * event)
+{
+	QWidget::resizeEvent(event);
+
+	if (previewEnabled)
+	{
+		previewValid = false;
+		frameDirty = true;
+	}
+}
+
+/*
+ * Box filter downscale fused with conversion to RGB
+ * @param src the BGR or gray source image (CV_8UC3 or CV_8UC1)
+ * @param dst the RGB destination image (CV_8UC3)
+ * @param factor the integer downscale factor
+ * @param sums row sums buffer
+ */
+void QcvMatWidget::downscaleToRGB(const Mat & src,
+								  Mat & dst,
+								  const int factor,
+								  vector<int> & sums)
+{
+	const int channels = src.channels();
+	// full blocks, then partial last blocks (if any) so no source
+	// column or row is dropped
+	const int fullCols = src.cols / factor;
+	const int lastWidth = src.cols - fullCols * factor;
+	const int dstCols = fullCols + (lastWidth > 0 ? 1 : 0);
+	const int dstRows = (src.rows + factor - 1) / factor;
+
+	dst.create(dstRows, dstCols, CV_8UC3);
+	sums.resize(dstCols * channels);
+
+	for (int y = 0; y < dstRows; y++)
+	{
+		const int blockRows = MIN(factor, src.rows - y * factor);
+		std::fill(sums.begin(), sums.end(), 0);
+
+		// accumulate blockRows source rows into per destination pixel sums
+		for (int k = 0; k < blockRows; k++)
+		{
+			const uchar * srcRow = src.ptr<uchar>(y * factor + k);
+			int * sum = &sums[0];
+
+			if (channels == 3)
+			{
+				for (int x = 0; x < fullCols; x++, sum += 3)
+				{
+					for (int j = 0; j < factor; j++, srcRow += 3)
+					{
+						sum[0] += srcRow[0];
+						sum[1] += srcRow[1];
+						sum[2] += srcRow[2];
+					}
+				}
+				for (int j = 0; j < lastWidth; j++, srcRow += 3)
+				{
+					sum[0] += srcRow[0];
+					sum[1] += srcRow[1];
+					sum[2] += srcRow[2];
+				}
+			}
+			else
+			{
+				for (int x = 0; x < fullCols; x++, sum++)
+				{
+					for (int j = 0; j < factor; j++, srcRow++)
+					{
+						sum[0] += srcRow[0];
+					}
+				}
+				for (int j = 0; j < lastWidth; j++, srcRow++)
+				{
+					sum[0] += srcRow[0];
+				}
+			}
+		}
+
+		// normalize by actual block area and write RGB pixels
+		uchar * dstRow = dst.ptr<uchar>(y);
+		const int * sum = &sums[0];
+		for (int x = 0; x < dstCols; x++, dstRow += 3)
+		{
+			const int area = blockRows * (x < fullCols ? factor : lastWidth);
+			const int half = area / 2;
+			if (channels == 3)
+			{
+				dstRow[0] = (uchar)((sum[2] + half) / area);
+				dstRow[1] = (uchar)((sum[1] + half) / area);
+				dstRow[2] = (uchar)((sum[0] + half) / area);
+				sum += 3;
+			}
+			else
+			{
+				uchar value = (uchar)((sum[0] + half) / area);
+				dstRow[0] = value;
+				dstRow[1] = value;
+				dstRow[2] = value;
+				sum++;
+			}
+		}
+	}
+}
+
+/*
+ * Maps a point in widget coordinates to display image coordinates.
+ * Downscaled preview is drawn into previewRect, so the mapping uses
+ * the actual scale along each axis rather than the integer preview
+ * factor
+ * @param p the point in widget coordinates
+ * @return the point in display image coordinates
+ */
+Point QcvMatWidget::toDisplayPoint(const QPoint & p) const
+{
+	if (previewScale < 1.0)
+	{
+		QRect area = previewRect();
+		return Point((p.x() * displayImage.cols) / area.width(),
+					 (p.y() * displayImage.rows) / area.height());
+	}
+
+	return Point(p.x(), p.y());
+}
+
 /*
  * Callback called when mouse button pressed event occurs.
  * reimplemented to send pressPoint signal when left mouse button is
@@ -257,8 +500,9 @@ void QcvMatWidget::mouseReleaseEvent(QMouseEvent *event)
  */
 void QcvMatWidget::drawCross(const QPoint & p)
 {
-	int x0 = p.x();
-	int y0 = p.y();
+	Point center = toDisplayPoint(p);
+	int x0 = center.x;
+	int y0 = center.y;
 	int x1, x2, x3, x4;
 	int y1, y2, y3, y4;
 	int offset = 10;
@@ -293,13 +537,8 @@ void QcvMatWidget::drawCross(const QPoint & p)
  */
 void QcvMatWidget::drawRectangle(const QRect & r)
 {
-	int x1 = r.left();
-	int x2 = r.right();
-	int y1 = r.top();
-	int y2 = r.bottom();
-
-	Point p1(x1, y1);
-	Point p2(x2, y2);
+	Point p1 = toDisplayPoint(r.topLeft());
+	Point p2 = toDisplayPoint(r.bottomRight());
 
 	rectangle(displayImage, p1, p2, drawingColor, drawingWidth, CV_AA);
 }
@@ -387,17 +626,131 @@ bool QcvMatWidget::isMouseDragable() const
 }
 
 /*
- * Update slot customized to include convertImage before actually
- * updating
+ * Gets the maximum display refresh rate
+ * @return the maximum display refresh rate in frames per second or 0
+ * if screen refresh rate is used
+ */
+double QcvMatWidget::getDisplayRate() const
+{
+	return displayRate;
+}
+
+/*
+ * Number of frames converted and painted since last counters reset
+ * @return the number of painted frames
+ */
+size_t QcvMatWidget::getPaintedFrames() const
+{
+	return paintedFrames;
+}
+
+/*
+ * Number of source updates which have been coalesced (hence never
+ * converted nor painted) since last counters reset
+ * @return the number of skipped frames
+ */
+size_t QcvMatWidget::getSkippedFrames() const
+{
+	return skippedFrames;
+}
+
+/*
+ * Reset painted and skipped frames counters
+ */
+void QcvMatWidget::resetFrameCounters()
+{
+	paintedFrames = 0;
+	skippedFrames = 0;
+}
+
+/*
+ * Minimum interval between two paints according to #displayRate
+ * @return the minimum interval between two paints in ms
+ */
+int QcvMatWidget::displayInterval() const
+{
+	double rate = displayRate;
+
+	if (rate <= 0.0)
+	{
+		rate = fallbackDisplayRate;
+#if QT_VERSION >= 0x050000
+		QScreen * screen = QGuiApplication::primaryScreen();
+		if ((screen != NULL) && (screen->refreshRate() > 0.0))
+		{
+			rate = screen->refreshRate();
+		}
+#endif
+	}
+
+	return (int)(1000.0 / rate);
+}
+
+/*
+ * Converts source image into display image if it has been updated
+ * since last conversion
+ */
+void QcvMatWidget::convertIfDirty()
+{
+	if (frameDirty && (sourceImage != NULL))
+	{
+		convertImage();
+		paintedFrames++;
+	}
+	frameDirty = false;
+}
+
+/*
+ * Refresh slot triggered by #refreshTimer : schedules an actual
+ * repaint of the widget
+ */
+void QcvMatWidget::refresh()
+{
+	QWidget::update();
+}
+
+/*
+ * Update slot customized to mark source image as updated and schedule a
+ * repaint. Conversion of the source image is deferred until paint time
  */
 void QcvMatWidget::update()
 {
 //	count++;
 //	qDebug() << "QcvMatWidget::update " << count;
-//	std::cerr << "{o";
-	convertImage();
-	QWidget::update();
-//	std::cerr << "}";
+	if (frameDirty)
+	{
+		// previous update has not been painted yet and never will be
+		skippedFrames++;
+	}
+	frameDirty = true;
+
+	if (!refreshTimer->isActive())
+	{
+		int interval = displayInterval();
+		int remaining = 0;
+		if (paintClock.isValid())
+		{
+			remaining = interval - (int)paintClock.elapsed();
+		}
+		refreshTimer->start(remaining > 0 ? remaining : 0);
+	}
+}
+
+/*
+ * Sets the maximum display refresh rate
+ * @param rate the maximum number of paints per second or 0 to use
+ * the screen refresh rate
+ */
+void QcvMatWidget::setDisplayRate(const double rate)
+{
+	if (rate >= 0.0)
+	{
+		displayRate = rate;
+	}
+	else
+	{
+		qWarning("QcvMatWidget::setDisplayRate: invalid rate %f", rate);
+	}
 }
 
 // ----------------------------------------------------------------------------
@@ -14,14 +14,21 @@
  * @param imageLock the mutex on source image
  * @param updateThread the thread in which this processor runs
  * @param parent parent QObject
+ * @param precision the floating point precision of computations
+ * @param nbThreads number of threads used to transform channels
+ * (0 uses the number of hardware threads)
+ * @param frameMode part of the source frame which is transformed
  */
 QcvSimpleDFT::QcvSimpleDFT(Mat * image,
 						   QMutex * imageLock,
 						   QThread * updateThread,
-						   QObject * parent) :
+						   QObject * parent,
+						   const Precision precision,
+						   const size_t nbThreads,
+						   const FrameMode frameMode) :
 	CvProcessor(image), // <-- virtual base class constructor first
 	QcvProcessor(image, imageLock, updateThread, parent),
-	CvSimpleDFT(image)
+	CvSimpleDFT(image, precision, nbThreads, frameMode)
 {
 }
 
@@ -33,6 +40,273 @@ QcvSimpleDFT::~QcvSimpleDFT()
 	message.clear();
 }
 
+/*
+ * Sets computations precision and sends message.
+ * When called from another thread than this processor's thread,
+ * the change is queued into this processor's thread so it never
+ * happens during update
+ * @param precision the new floating point precision
+ */
+void QcvSimpleDFT::setPrecision(const Precision precision)
+{
+	if (QThread::currentThread() != thread())
+	{
+		QMetaObject::invokeMethod(this, "changePrecision",
+								  Qt::QueuedConnection,
+								  Q_ARG(int, (int) precision));
+	}
+	else
+	{
+		changePrecision((int) precision);
+	}
+}
+
+/*
+ * Sets the number of threads used to transform channels and sends
+ * message
+ * @param nbThreads the number of threads including the calling
+ * thread. 0 uses the number of hardware threads
+ */
+void QcvSimpleDFT::setNbThreads(const size_t nbThreads)
+{
+	CvSimpleDFT::setNbThreads(nbThreads);
+
+	message.clear();
+	message.append(tr("Fourier transform threads set to "));
+	message.append(QString::number((qulonglong) getNbThreads()));
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets filter type and sends message
+ * @param filterType the new filter type
+ */
+void QcvSimpleDFT::setFilterType(const FilterType filterType)
+{
+	CvSimpleDFT::setFilterType(filterType);
+
+	message.clear();
+	message.append(tr("Filter set to "));
+	switch (this->filterType)
+	{
+		case LOW_PASS:
+			message.append(tr("low pass"));
+			break;
+		case HIGH_PASS:
+			message.append(tr("high pass"));
+			break;
+		case BAND_PASS:
+			message.append(tr("band pass"));
+			break;
+		case NOTCH:
+			message.append(tr("notch"));
+			break;
+		case NO_FILTER:
+		default:
+			message.append(tr("none"));
+			break;
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets filter shape and sends message
+ * @param filterShape the new filter shape
+ */
+void QcvSimpleDFT::setFilterShape(const FilterShape filterShape)
+{
+	CvSimpleDFT::setFilterShape(filterShape);
+
+	message.clear();
+	message.append(tr("Filter shape set to "));
+	switch (this->filterShape)
+	{
+		case BUTTERWORTH_FILTER:
+			message.append(tr("Butterworth"));
+			break;
+		case GAUSSIAN_FILTER:
+			message.append(tr("Gaussian"));
+			break;
+		case IDEAL_FILTER:
+		default:
+			message.append(tr("ideal"));
+			break;
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets the size of the box kernel blurring the frame and sends
+ * message
+ * @param size the new kernel size (0 or 1 to disable blur)
+ */
+void QcvSimpleDFT::setKernelSize(const int size)
+{
+	CvSimpleDFT::setKernelSize(size);
+
+	message.clear();
+	if (kernelSize > 1)
+	{
+		message.append(tr("Frame blurred with "));
+		message.append(QString::number(kernelSize));
+		message.append(tr("x"));
+		message.append(QString::number(kernelSize));
+		message.append(tr(" box kernel"));
+	}
+	else
+	{
+		message.append(tr("Frame blur disabled"));
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets the method of frame blur convolution and sends message
+ * @param method the new convolution method
+ */
+void QcvSimpleDFT::setConvolutionMethod(const CvFFTConvolver::Method method)
+{
+	CvSimpleDFT::setConvolutionMethod(method);
+
+	message.clear();
+	message.append(tr("Blur convolution method set to "));
+	switch (getConvolutionMethod())
+	{
+		case CvFFTConvolver::DIRECT_CONVOLUTION:
+			message.append(tr("direct"));
+			break;
+		case CvFFTConvolver::OVERLAP_SAVE:
+			message.append(tr("overlap-save"));
+			break;
+		case CvFFTConvolver::OVERLAP_ADD:
+			message.append(tr("overlap-add"));
+			break;
+		case CvFFTConvolver::AUTO_CONVOLUTION:
+		default:
+			message.append(tr("automatic"));
+			break;
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets frame mode and sends message. Images are reallocated
+ * and their changed signals are emitted.
+ * When called from another thread than this processor's thread,
+ * the change is queued into this processor's thread so buffers
+ * are never reallocated during update
+ * @param frameMode the new frame mode
+ */
+void QcvSimpleDFT::setFrameMode(const FrameMode frameMode)
+{
+	if (QThread::currentThread() != thread())
+	{
+		QMetaObject::invokeMethod(this, "changeFrameMode",
+								  Qt::QueuedConnection,
+								  Q_ARG(int, (int) frameMode));
+	}
+	else
+	{
+		changeFrameMode((int) frameMode);
+	}
+}
+
+/*
+ * Sets padding mode and sends message
+ * @param paddingMode the new padding mode
+ */
+void QcvSimpleDFT::setPaddingMode(const PaddingMode paddingMode)
+{
+	CvSimpleDFT::setPaddingMode(paddingMode);
+
+	message.clear();
+	message.append(tr("Frame padding set to "));
+	switch (this->paddingMode)
+	{
+		case REPLICATE_PADDING:
+			message.append(tr("replicate"));
+			break;
+		case REFLECT_PADDING:
+			message.append(tr("reflect"));
+			break;
+		case WRAP_PADDING:
+			message.append(tr("wrap"));
+			break;
+		case ZERO_PADDING:
+		default:
+			message.append(tr("zero"));
+			break;
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Sets temporal averaging mode and sends message
+ * @param averagingMode the new averaging mode
+ */
+void QcvSimpleDFT::setAveragingMode(const AveragingMode averagingMode)
+{
+	CvSimpleDFT::setAveragingMode(averagingMode);
+
+	message.clear();
+	message.append(tr("Spectrum averaging set to "));
+	switch (this->averagingMode)
+	{
+		case BOX_AVERAGING:
+			message.append(tr("box over "));
+			message.append(QString::number(averagingFrames));
+			message.append(tr(" frames"));
+			break;
+		case EXPONENTIAL_AVERAGING:
+			message.append(tr("exponential decay 1/"));
+			message.append(QString::number(averagingFrames));
+			break;
+		case NO_AVERAGING:
+		default:
+			message.append(tr("none"));
+			break;
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Enables or disables spectrogram and sends message
+ * @param enabled the new spectrogram computation state
+ */
+void QcvSimpleDFT::setSpectrogramEnabled(const bool enabled)
+{
+	CvSimpleDFT::setSpectrogramEnabled(enabled);
+
+	message.clear();
+	message.append(tr("Spectrogram "));
+	message.append(spectrogramEnabled ? tr("enabled") : tr("disabled"));
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * DFT size text for display : a single size for square DFT or
+ * <width>x<height> otherwise
+ * @return the DFT size text
+ */
+QString QcvSimpleDFT::getDftSizeText() const
+{
+	if (dftSize.width == dftSize.height)
+	{
+		return QString::number(dftSize.width);
+	}
+
+	return QString::number(dftSize.width) + "x" +
+		QString::number(dftSize.height);
+}
+
 /*
  * Update computed images slot and sends updated signal
  * required
@@ -78,13 +352,64 @@ void QcvSimpleDFT::setSourceImage(Mat *image)
 
 	emit spectrumImageChanged(&spectrumMagnitudeImage);
 
+	emit inverseImageChanged(&filteredImage);
+
+	emit spectrogramImageChanged(&spectrogramImage);
+
 	if ((previousDftSize.width != dftSize.width) ||
 		(previousDftSize.height != dftSize.height))
 	{
 		emit imageSizeChanged();
-		emit sendText(QString::number(optimalDFTSize));
+		emit sendText(getDftSizeText());
 	}
 
 	// Force update
 	update();
 }
+
+/*
+ * Precision change slot run in this processor's thread
+ * @param precision the new floating point precision
+ */
+void QcvSimpleDFT::changePrecision(const int precision)
+{
+	CvSimpleDFT::setPrecision((Precision) precision);
+
+	message.clear();
+	message.append(tr("Fourier transform precision set to "));
+	if (this->precision == SINGLE_PRECISION)
+	{
+		message.append(tr("float"));
+	}
+	else
+	{
+		message.append(tr("double"));
+	}
+
+	emit sendMessage(message, defaultTimeOut);
+}
+
+/*
+ * Frame mode change slot run in this processor's thread
+ * @param frameMode the new frame mode
+ */
+void QcvSimpleDFT::changeFrameMode(const int frameMode)
+{
+	CvSimpleDFT::setFrameMode((FrameMode) frameMode);
+
+	message.clear();
+	message.append(tr("Fourier transform of "));
+	if (this->frameMode == FULL_FRAME)
+	{
+		message.append(tr("full padded frame"));
+	}
+	else
+	{
+		message.append(tr("center square"));
+	}
+	message.append(tr(" (size "));
+	message.append(getDftSizeText());
+	message.append(tr(")"));
+
+	emit sendMessage(message, defaultTimeOut);
+}
@@ -26,11 +26,18 @@ class QcvSimpleDFT: public QcvProcessor, public CvSimpleDFT
 		 * @param imageLock the mutex on source image
 		 * @param updateThread the thread in which this processor runs
 		 * @param parent parent QObject
+		 * @param precision the floating point precision of computations
+		 * @param nbThreads number of threads used to transform channels
+		 * (0 uses the number of hardware threads)
+		 * @param frameMode part of the source frame which is transformed
 		 */
 		QcvSimpleDFT(Mat * image,
 					 QMutex * imageLock = NULL,
 					 QThread * updateThread = NULL,
-					 QObject * parent = NULL);
+					 QObject * parent = NULL,
+					 const Precision precision = DOUBLE_PRECISION,
+					 const size_t nbThreads = 1,
+					 const FrameMode frameMode = SQUARE_FRAME);
 
 		/**
 		 * QcvSimpleDFT destructor
@@ -40,6 +47,82 @@ class QcvSimpleDFT: public QcvProcessor, public CvSimpleDFT
 		// --------------------------------------------------------------------
 		// Options settings with message notification
 		// --------------------------------------------------------------------
+		/**
+		 * Sets computations precision and sends message.
+		 * When called from another thread than this processor's thread,
+		 * the change is queued into this processor's thread so it never
+		 * happens during #update
+		 * @param precision the new floating point precision
+		 */
+		void setPrecision(const Precision precision);
+
+		/**
+		 * Sets the number of threads used to transform channels and sends
+		 * message
+		 * @param nbThreads the number of threads including the calling
+		 * thread. 0 uses the number of hardware threads
+		 */
+		void setNbThreads(const size_t nbThreads);
+
+		/**
+		 * Sets filter type and sends message
+		 * @param filterType the new filter type
+		 */
+		void setFilterType(const FilterType filterType);
+
+		/**
+		 * Sets filter shape and sends message
+		 * @param filterShape the new filter shape
+		 */
+		void setFilterShape(const FilterShape filterShape);
+
+		/**
+		 * Sets the size of the box kernel blurring the frame and sends
+		 * message
+		 * @param size the new kernel size (0 or 1 to disable blur)
+		 */
+		void setKernelSize(const int size);
+
+		/**
+		 * Sets the method of frame blur convolution and sends message
+		 * @param method the new convolution method
+		 */
+		void setConvolutionMethod(const CvFFTConvolver::Method method);
+
+		/**
+		 * Sets frame mode and sends message. Images are reallocated
+		 * and their changed signals are emitted.
+		 * When called from another thread than this processor's thread,
+		 * the change is queued into this processor's thread so buffers
+		 * are never reallocated during #update
+		 * @param frameMode the new frame mode
+		 */
+		void setFrameMode(const FrameMode frameMode);
+
+		/**
+		 * Sets padding mode and sends message
+		 * @param paddingMode the new padding mode
+		 */
+		void setPaddingMode(const PaddingMode paddingMode);
+
+		/**
+		 * Sets temporal averaging mode and sends message
+		 * @param averagingMode the new averaging mode
+		 */
+		void setAveragingMode(const AveragingMode averagingMode);
+
+		/**
+		 * Enables or disables spectrogram and sends message
+		 * @param enabled the new spectrogram computation state
+		 */
+		void setSpectrogramEnabled(const bool enabled);
+
+		/**
+		 * DFT size text for display : a single size for square DFT or
+		 * <width>x<height> otherwise
+		 * @return the DFT size text
+		 */
+		QString getDftSizeText() const;
 
 	public slots:
 		/**
@@ -56,6 +139,21 @@ class QcvSimpleDFT: public QcvProcessor, public CvSimpleDFT
 		void setSourceImage(Mat * image)
 			throw (CvProcessorException);
 
+	protected slots:
+		/**
+		 * Precision change slot run in this processor's thread
+		 * @param precision the new floating point precision
+		 * @see #setPrecision
+		 */
+		void changePrecision(const int precision);
+
+		/**
+		 * Frame mode change slot run in this processor's thread
+		 * @param frameMode the new frame mode
+		 * @see #setFrameMode
+		 */
+		void changeFrameMode(const int frameMode);
+
 	signals:
 
 //		/**
@@ -80,6 +178,12 @@ class QcvSimpleDFT: public QcvProcessor, public CvSimpleDFT
 		 * @param image the new inverse image
 		 */
 		void inverseImageChanged(Mat * image);
+
+		/**
+		 * Signal sent when spectrogram image has been reallocated
+		 * @param image the new spectrogram image
+		 */
+		void spectrogramImageChanged(Mat * image);
 };
 
 #endif /* QCVDFT_H_ */
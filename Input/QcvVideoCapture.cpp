@@ -28,6 +28,11 @@ size_t QcvVideoCapture::defaultFrameNumberTest = 5;
  */
 int QcvVideoCapture::messageDelay = 5000;
 
+/*
+ * Smoothing factor used for frame rate and latency moving averages
+ */
+double QcvVideoCapture::statisticsSmoothing = 0.1;
+
 /*
  * QcvVideoCapture constructor.
  * Opens the default camera (0)
@@ -79,8 +84,10 @@ QcvVideoCapture::QcvVideoCapture(const int deviceId,
 								 QObject * parent) :
 	QObject(parent),
 	filename(),
-	capture(deviceId),
+	capture(new VideoCapture(deviceId)),
+	frameSource(false),
 	timer(new QTimer(updateThread == NULL ? this : NULL)),
+	unthrottled(0),
 	updateThread(updateThread),
 	mutex(QMutex::NonRecursive),
 	lockLevel(0),
@@ -93,8 +100,12 @@ QcvVideoCapture::QcvVideoCapture(const int deviceId,
 	size(0, 0),
 	originalSize(0, 0),
 	frameRate(0.0),
-	statusMessage()
+	statusMessage(),
+	lastGrabTime(-1),
+	statisticsMutex(QMutex::NonRecursive)
 {
+	resetStatistics();
+
 	if (updateThread != NULL)
 	{
 		moveToThread(this->updateThread);
@@ -150,8 +161,10 @@ QcvVideoCapture::QcvVideoCapture(const QString & fileName,
 								 QObject * parent) :
 	QObject(parent),
 	filename(fileName),
-	capture(fileName.toStdString()),
+	capture(new VideoCapture(fileName.toStdString())),
+	frameSource(false),
 	timer(new QTimer(updateThread == NULL ? this : NULL)),
+	unthrottled(0),
 	updateThread(updateThread),
 	mutex(QMutex::NonRecursive),
 	lockLevel(0),
@@ -164,8 +177,12 @@ QcvVideoCapture::QcvVideoCapture(const QString & fileName,
 	size(0, 0),
 	originalSize(0, 0),
 	frameRate(0.0),
-	statusMessage()
+	statusMessage(),
+	lastGrabTime(-1),
+	statisticsMutex(QMutex::NonRecursive)
 {
+	resetStatistics();
+
 	if (updateThread != NULL)
 	{
 		moveToThread(this->updateThread);
@@ -193,6 +210,95 @@ QcvVideoCapture::QcvVideoCapture(const QString & fileName,
 	}
 }
 
+/*
+ * QcvVideoCapture constructor from frame source
+ * @param source the frame source to capture frames from
+ * @param name the name of the source used in status messages
+ * @param flipVideo mirror image
+ * @param gray convert image to gray
+ * @param skip indicates capture can skip an image. When the capture
+ * result has not been processed yet, or when false that capture should
+ * wait for the result to be processed before grabbing a new image.
+ * This only applies when #updateThread is not NULL.
+ * @param width desired width or 0 to keep capture width
+ * @param height desired height or 0 to keep capture height
+ * @param updateThread the thread used to run this capture
+ * @param parent the parent QObject
+ */
+QcvVideoCapture::QcvVideoCapture(const Ptr<VideoCapture> & source,
+								 const QString & name,
+								 const bool flipVideo,
+								 const bool gray,
+								 const bool skip,
+								 const unsigned int width,
+								 const unsigned int height,
+								 QThread * updateThread,
+								 QObject * parent) :
+	QObject(parent),
+	filename(),
+	capture(source),
+	frameSource(true),
+	timer(new QTimer(updateThread == NULL ? this : NULL)),
+	unthrottled(0),
+	updateThread(updateThread),
+	mutex(QMutex::NonRecursive),
+	lockLevel(0),
+	liveVideo(true), // frame sources never run out of frames
+	flipVideo(flipVideo),
+	resize(false),
+	directResize(false),
+	gray(gray),
+	skip(skip),
+	size(0, 0),
+	originalSize(0, 0),
+	frameRate(0.0),
+	statusMessage(),
+	lastGrabTime(-1),
+	statisticsMutex(QMutex::NonRecursive)
+{
+	resetStatistics();
+
+	if (updateThread != NULL)
+	{
+		moveToThread(this->updateThread);
+		connect(this, SIGNAL(finished()), updateThread, SLOT(quit()),
+				Qt::DirectConnection);
+	}
+
+	timer->setSingleShot(false);
+#if QT_VERSION >= 0x050000
+	// frame sources may run at high rates so timer should be precise
+	timer->setTimerType(Qt::PreciseTimer);
+#endif
+	connect(timer, SIGNAL(timeout()), SLOT(update()));
+
+	if (grabTest())
+	{
+		setSize(width, height);
+		QString message(name);
+		message.append(" ");
+
+		int delay = grabInterval(message);
+		if (updateThread != NULL)
+		{
+			updateThread->start();
+		}
+
+		if (delay == 0 && updateThread != NULL)
+		{
+			// unthrottled grabs are chained in the update thread
+			unthrottled.storeRelease(1);
+			QMetaObject::invokeMethod(this, "grabNext", Qt::QueuedConnection);
+			qDebug("unthrottled grabbing started");
+		}
+		else
+		{
+			timer->start(delay);
+			qDebug("timer started with %d ms delay", delay);
+		}
+	}
+}
+
 /*
  * QcvVideoCapture destructor.
  * releases video capture and image
@@ -210,6 +316,8 @@ QcvVideoCapture::~QcvVideoCapture()
 		lockLevel++;
 	}
 
+	unthrottled.storeRelease(0);
+
 	if (timer != NULL)
 	{
 		if (timer->isActive())
@@ -241,7 +349,7 @@ QcvVideoCapture::~QcvVideoCapture()
 
 	// relesase OpenCV ressources
 	filename.clear();
-	capture.release();
+	capture->release();
 	imageDisplay.release();
 	imageFlipped.release();
 	imageResized.release();
@@ -270,15 +378,16 @@ bool QcvVideoCapture::open(const int deviceId,
 	}
 
 	filename.clear();
+	unthrottled.storeRelease(0);
 	if (timer->isActive())
 	{
 		timer->stop();
 		qDebug("timer stopped");
 	}
 
-	if (capture.isOpened())
+	if (capture->isOpened())
 	{
-		capture.release();
+		capture->release();
 	}
 
 	if (!image.empty())
@@ -286,7 +395,14 @@ bool QcvVideoCapture::open(const int deviceId,
 		image.release();
 	}
 
-	capture.open(deviceId);
+	if (frameSource)
+	{
+		// frame sources can't open devices or files
+		capture = Ptr<VideoCapture>(new VideoCapture());
+		frameSource = false;
+	}
+
+	capture->open(deviceId);
 
 	bool grabbed = grabTest();
 
@@ -334,6 +450,7 @@ bool QcvVideoCapture::open(const QString & fileName,
 {
 	filename = fileName;
 
+	unthrottled.storeRelease(0);
 	if (timer->isActive())
 	{
 		timer->stop();
@@ -350,9 +467,9 @@ bool QcvVideoCapture::open(const QString & fileName,
 		lockLevel++;
 	}
 
-	if (capture.isOpened())
+	if (capture->isOpened())
 	{
-		capture.release();
+		capture->release();
 	}
 
 	if (!image.empty())
@@ -360,7 +477,14 @@ bool QcvVideoCapture::open(const QString & fileName,
 		image.release();
 	}
 
-	capture.open(fileName.toStdString());
+	if (frameSource)
+	{
+		// frame sources can't open devices or files
+		capture = Ptr<VideoCapture>(new VideoCapture());
+		frameSource = false;
+	}
+
+	capture->open(fileName.toStdString());
 
 	bool grabbed = grabTest();
 
@@ -727,6 +851,138 @@ QMutex * QcvVideoCapture::getMutex()
 }
 
 
+/*
+ * Capture statistics accessor
+ * @return a copy of the current capture statistics
+ */
+QcvVideoCapture::Statistics QcvVideoCapture::getStatistics() const
+{
+	QMutexLocker locker(&statisticsMutex);
+	return statistics;
+}
+
+/*
+ * Update thread accessor
+ * @return the thread running this capture or NULL if capture is
+ * updated in the main thread
+ */
+QThread * QcvVideoCapture::getUpdateThread() const
+{
+	return updateThread;
+}
+
+/*
+ * Resets capture statistics
+ */
+void QcvVideoCapture::resetStatistics()
+{
+	QMutexLocker locker(&statisticsMutex);
+	statistics.grabbedFrames = 0;
+	statistics.droppedFrames = 0;
+	statistics.frameRate = 0.0;
+	statistics.latency = 0.0;
+	lastGrabTime = -1;
+	statisticsClock.start();
+}
+
+/*
+ * Refresh headers of the image chain sharing the image buffer
+ * @return true if imageDisplay size or type changed, false if only its
+ * buffer changed
+ */
+bool QcvVideoCapture::relinkImageChain()
+{
+	if (updateThread != NULL)
+	{
+		if (lockLevel == 0)
+		{
+			mutex.lock();
+		}
+		lockLevel++;
+	}
+
+	Size previousSize = imageDisplay.size();
+	int previousType = imageDisplay.type();
+
+	// see setSize, setFlipVideo and setGray
+	if (!resize || directResize)
+	{
+		imageResized = image;
+	}
+
+	if (!flipVideo)
+	{
+		imageFlipped = imageResized;
+	}
+
+	if (!gray)
+	{
+		imageDisplay = imageFlipped;
+	}
+
+	bool changed = (imageDisplay.size() != previousSize) ||
+				   (imageDisplay.type() != previousType);
+
+	if (updateThread != NULL)
+	{
+		lockLevel--;
+		if (lockLevel == 0)
+		{
+			mutex.unlock();
+		}
+	}
+
+	return changed;
+}
+
+/*
+ * Records a successfully grabbed frame in statistics
+ * @param startTime time at which grabbing this frame started (in ns
+ * from statisticsClock start)
+ */
+void QcvVideoCapture::recordGrab(const qint64 startTime)
+{
+	QMutexLocker locker(&statisticsMutex);
+	qint64 now = statisticsClock.nsecsElapsed();
+	double latency = (double)(now - startTime) / 1e6;
+
+	if (statistics.grabbedFrames == 0)
+	{
+		statistics.latency = latency;
+	}
+	else
+	{
+		statistics.latency += statisticsSmoothing *
+			(latency - statistics.latency);
+	}
+
+	if (lastGrabTime >= 0 && now > lastGrabTime)
+	{
+		double rate = 1e9 / (double)(now - lastGrabTime);
+		if (statistics.frameRate <= 0.0)
+		{
+			statistics.frameRate = rate;
+		}
+		else
+		{
+			statistics.frameRate += statisticsSmoothing *
+				(rate - statistics.frameRate);
+		}
+	}
+
+	lastGrabTime = now;
+	statistics.grabbedFrames++;
+}
+
+/*
+ * Records a dropped frame in statistics
+ */
+void QcvVideoCapture::recordDrop()
+{
+	QMutexLocker locker(&statisticsMutex);
+	statistics.droppedFrames++;
+}
+
 /*
  * Performs a grab test to fill #image
  * @return true if capture is opened and successfully grabs a first
@@ -737,18 +993,18 @@ bool QcvVideoCapture::grabTest()
 //	qDebug("Grab test");
 	bool result = false;
 
-	if (capture.isOpened())
+	if (capture->isOpened())
 	{
 #ifndef Q_OS_LINUX // V4L does not support these queries
-		int capWidth = capture.get(CV_CAP_PROP_FRAME_WIDTH);
-		int capHeight = capture.get(CV_CAP_PROP_FRAME_HEIGHT);
+		int capWidth = capture->get(CV_CAP_PROP_FRAME_WIDTH);
+		int capHeight = capture->get(CV_CAP_PROP_FRAME_HEIGHT);
 
 		qDebug("Capture grab test with %d x %d image", capWidth, capHeight);
 #endif
 		// grabs first frame
-		if (capture.grab())
+		if (capture->grab())
 		{
-			bool retrieved = capture.retrieve(image);
+			bool retrieved = capture->retrieve(image);
 			if (retrieved)
 			{
 				size.setWidth(image.cols);
@@ -803,11 +1059,33 @@ int QcvVideoCapture::grabInterval(const QString & message)
 	// For instance it does not work wirh linuxes equipped with V4L
 	// --------------------------------------------------------------------
 #ifndef Q_OS_LINUX
-	frameRate = capture.get(CV_CAP_PROP_FPS);
+	frameRate = capture->get(CV_CAP_PROP_FPS);
 #else
 	frameRate = -1.0;
 #endif
 
+	// Frame sources always provide their frame rate: 0 means unthrottled
+	if (frameSource)
+	{
+		frameRate = capture->get(CV_CAP_PROP_FPS);
+		if (frameRate > 0.0)
+		{
+			frameDelay = (int)(1000.0 / frameRate);
+			statusMessage.sprintf("%s frame rate = %4.2f images/s",
+								  message.toStdString().c_str(), frameRate);
+		}
+		else
+		{
+			frameDelay = 0;
+			statusMessage.sprintf("%s unthrottled",
+								  message.toStdString().c_str());
+		}
+		qDebug("%s", statusMessage.toStdString().c_str());
+		emit messageChanged(statusMessage, messageDelay);
+
+		return frameDelay;
+	}
+
 //	qDebug("framerate direct query = %f", frameRate);
 
 	/*
@@ -826,7 +1104,7 @@ int QcvVideoCapture::grabInterval(const QString & message)
 
 			for (size_t i=0; i < defaultFrameNumberTest; i++)
 			{
-				capture >> image;
+				*capture >> image;
 			}
 
 			frameDelay = (int)(localTimer.elapsed() / defaultFrameNumberTest);
@@ -836,7 +1114,7 @@ int QcvVideoCapture::grabInterval(const QString & message)
 		/*
 		 * FIXME else ???
 		 * video files read through capture should provide framerate with
-		 * capture.get(CV_CAP_PROP_FPS) but what happens if they don't ???
+		 * capture->get(CV_CAP_PROP_FPS) but what happens if they don't ???
 		 */
 	}
 	else
@@ -860,7 +1138,7 @@ int QcvVideoCapture::grabInterval(const QString & message)
  * @param width the width property to set on capture
  * @param height the height property to set on capture
  * @return true if capture is opened and if width and height have been
- * set successfully through @code capture.set(...) @endcode. Returns
+ * set successfully through @code capture->set(...) @endcode. Returns
  * false otherwise.
  * @post if at least width or height have been set successfully, capture
  * image is released then updated again so it will have the right
@@ -869,10 +1147,6 @@ int QcvVideoCapture::grabInterval(const QString & message)
 bool QcvVideoCapture::setDirectSize(const unsigned int width,
 									const unsigned int height)
 {
-#ifdef Q_OS_LINUX
-	Q_UNUSED(width);
-	Q_UNUSED(height);
-#endif
 	bool done = false;
 
 	/*
@@ -883,23 +1157,28 @@ bool QcvVideoCapture::setDirectSize(const unsigned int width,
 	 * lead to a DEADlock, so mutex HAS to be recursive !
 	 */
 
-#ifndef Q_OS_LINUX
-	if (capture.isOpened())
+#ifdef Q_OS_LINUX
+	// V4L does not support these settings but frame sources might
+	bool settable = frameSource;
+#else
+	bool settable = true;
+#endif
+
+	if (settable && capture->isOpened())
 	{
-		bool setWidth = capture.set(CV_CAP_PROP_FRAME_WIDTH, (double)width);
-		bool setHeight = capture.set(CV_CAP_PROP_FRAME_HEIGHT, (double)height);
+		bool setWidth = capture->set(CV_CAP_PROP_FRAME_WIDTH, (double)width);
+		bool setHeight = capture->set(CV_CAP_PROP_FRAME_HEIGHT, (double)height);
 		if (setWidth || setHeight)
 		{
 			// release old capture image
 			image.release();
 
 			// force image update to get the right size
-			capture >> image;
+			*capture >> image;
 
 			done = true;
 		}
 	}
-#endif
 
 	return done;
 }
@@ -913,6 +1192,8 @@ void QcvVideoCapture::update()
 {
 	bool locked = true;
 	bool image_updated = false;
+	bool chain_changed = false;
+	qint64 startTime = statisticsClock.nsecsElapsed();
 
 	if (updateThread != NULL)
 	{
@@ -937,9 +1218,17 @@ void QcvVideoCapture::update()
 		}
 	}
 
-	if (capture.isOpened() && locked)
+	if (capture->isOpened() && locked)
 	{
-		capture >> image;
+		uchar * previousData = image.data;
+
+		*capture >> image;
+
+		// zero copy frame sources provide a new buffer for each frame
+		if (frameSource && image.data != NULL && image.data != previousData)
+		{
+			chain_changed = relinkImageChain();
+		}
 
 		if (!image.data) // captured image has no data
 		{
@@ -953,7 +1242,7 @@ void QcvVideoCapture::update()
 					qDebug("timer stopped");
 				}
 
-				capture.release();
+				capture->release();
 
 				statusMessage.sprintf("No more frames to capture ...");
 				emit messageChanged(statusMessage, 0);
@@ -962,7 +1251,7 @@ void QcvVideoCapture::update()
 			else // not live video ==> video file
 			{
 				// We'll try to rewinds the file back to frame 0
-				bool restart = capture.set(CV_CAP_PROP_POS_FRAMES, 0.0);
+				bool restart = capture->set(CV_CAP_PROP_POS_FRAMES, 0.0);
 
 				if (restart)
 				{
@@ -976,7 +1265,7 @@ void QcvVideoCapture::update()
 				}
 				else
 				{
-					capture.release();
+					capture->release();
 
 					statusMessage.sprintf("Failed to restart capture ...");
 					emit messageChanged(statusMessage, 0);
@@ -1037,6 +1326,12 @@ void QcvVideoCapture::update()
 
 		if (image_updated)
 		{
+			// consumers only need to be set up again on geometry changes
+			if (chain_changed)
+			{
+				emit imageChanged(&imageDisplay);
+			}
+			recordGrab(startTime);
 			emit updated();
 		}
 	}
@@ -1044,5 +1339,23 @@ void QcvVideoCapture::update()
 	{
 		// mutex hasn't been locked, so we skipped one capture
 		// qDebug() << "Capture skipped an image";
+		if (!locked)
+		{
+			recordDrop();
+		}
+	}
+}
+
+/*
+ * Unthrottled grabbing slot run in update thread : grabs a new image
+ * then queues the next grab as long as unthrottled is set
+ */
+void QcvVideoCapture::grabNext()
+{
+	update();
+
+	if (unthrottled.loadAcquire() != 0)
+	{
+		QMetaObject::invokeMethod(this, "grabNext", Qt::QueuedConnection);
 	}
 }
@@ -2,10 +2,12 @@
 #include <QThread>
 #include <libgen.h>		// for basename
 #include <iostream>		// for cout
+#include <cstdlib>		// for EXIT_SUCCESS & EXIT_FAILURE
 
 #include "QcvVideoCapture.h"
 #include "CaptureFactory.h"
 #include "QcvSimpleDFT.h"
+#include "CvFFTConvolver.h"
 #include "mainwindow.h"
 
 /**
@@ -14,6 +16,27 @@
  */
 void usage(char * name);
 
+/**
+ * Compares double and single precision Fourier transforms runtimes
+ * on random images for several DFT sizes and prints results on
+ * standard output
+ * @param frames number of timed updates for each size and precision
+ * @param nbWorkers number of threads transforming channels
+ */
+void benchmark(const int frames, const size_t nbWorkers);
+
+/**
+ * Compares direct and FFT (overlap-save and overlap-add) filtering
+ * runtimes on a random VGA color image for several odd and even kernel
+ * sizes and prints results on standard output along with the method
+ * chosen by automatic selection and the maximum absolute difference
+ * between FFT and cv::filter2D results (on the VGA image and on an image
+ * whose size is not a multiple of tiles size, so border tiles are partial)
+ * @param frames number of timed filterings for each kernel size and method
+ * @param nbWorkers number of threads filtering tiles
+ */
+void convolutionBenchmark(const int frames, const size_t nbWorkers);
+
 /**
  * Test program OpenCV2 + QT4
  * @param argc argument count
@@ -23,9 +46,23 @@ void usage(char * name);
  * [--mirror | -m] [--size | -s] <width>x<height>
  * 	- device : [--device | -d] <device #> (0, 1, ...) Opens capture device #
  * 	- filename : [--file | -f ] <filename> Opens a video file or URL (including rtsp)
+ * 	only the first device or file is opened when several are provided
+ * 	(multiple streams and [--pool | -p] are not supported here)
  * 	- mirror : mirrors image horizontally before display
  *	- size : [--size | -s] <width>x<height> resize capture to fit desired <width>
  *	and <height>
+ *	- float : [--float] computes Fourier transforms with floats rather than
+ *	doubles
+ *	- full frame : [--full-frame] transforms the whole frame padded to
+ *	optimal width and height rather than its center square resized
+ *	- workers : [--workers] <n> number of threads transforming channels
+ *	(0 uses the number of hardware threads)
+ *	- kernel : [--kernel] <size> blurs frame with a <size>x<size> box
+ *	kernel before its transform (FFT on tiles for large kernels)
+ *	- benchmark : [--benchmark] [<frames>] compares double and float
+ *	Fourier transforms runtimes for several DFT sizes, then direct and FFT
+ *	convolutions runtimes and errors against cv::filter2D for several
+ *	kernel sizes, then exits
  */
 int main(int argc, char *argv[])
 {
@@ -38,7 +75,13 @@ int main(int argc, char *argv[])
 	QStringList argList = QCoreApplication::arguments();
 
 	int threadNumber = 3;
-	// parse arguments for --threads tag
+	CvSimpleDFT::Precision precision = CvSimpleDFT::DOUBLE_PRECISION;
+	CvSimpleDFT::FrameMode frameMode = CvSimpleDFT::SQUARE_FRAME;
+	int benchmarkFrames = 0;
+	int nbWorkers = 1;
+	int kernelSize = 0;
+	// parse arguments for --threads, --float, --full-frame, --workers,
+	// --kernel and --benchmark tags
 	for (QListIterator<QString> it(argList); it.hasNext(); )
 	{
 		QString currentArg(it.next());
@@ -63,7 +106,83 @@ int main(int argc, char *argv[])
 			}
 
 		}
+
+		if (currentArg == "--float")
+		{
+			precision = CvSimpleDFT::SINGLE_PRECISION;
+		}
+
+		if (currentArg == "--full-frame")
+		{
+			frameMode = CvSimpleDFT::FULL_FRAME;
+		}
+
+		if (currentArg == "--workers")
+		{
+			// Next argument should be workers number integer
+			if (it.hasNext())
+			{
+				QString workersString(it.next());
+				bool convertOk;
+				nbWorkers = workersString.toInt(&convertOk,10);
+				if (!convertOk || nbWorkers < 0)
+				{
+					qWarning("Warning: Invalid workers number %d",nbWorkers);
+					nbWorkers = 1;
+				}
+			}
+			else
+			{
+				qWarning("Warning: workers tag found with no following workers number");
+			}
+		}
+
+		if (currentArg == "--kernel")
+		{
+			// Next argument should be kernel size integer
+			if (it.hasNext())
+			{
+				QString kernelString(it.next());
+				bool convertOk;
+				kernelSize = kernelString.toInt(&convertOk,10);
+				if (!convertOk || kernelSize < 0)
+				{
+					qWarning("Warning: Invalid kernel size %d",kernelSize);
+					kernelSize = 0;
+				}
+			}
+			else
+			{
+				qWarning("Warning: kernel tag found with no following kernel size");
+			}
+		}
+
+		if (currentArg == "--benchmark")
+		{
+			benchmarkFrames = 100;
+			// Next argument might be the number of frames
+			if (it.hasNext() && !it.peekNext().startsWith("-"))
+			{
+				QString framesString(it.next());
+				bool convertOk;
+				benchmarkFrames = framesString.toInt(&convertOk,10);
+				if (!convertOk || benchmarkFrames < 1)
+				{
+					qWarning("Warning: Invalid benchmark frames number %d",
+							 benchmarkFrames);
+					benchmarkFrames = 100;
+				}
+			}
+		}
+	}
+
+	if (benchmarkFrames > 0)
+	{
+		benchmark(benchmarkFrames, (size_t) nbWorkers);
+		convolutionBenchmark(benchmarkFrames, (size_t) nbWorkers);
+		return 0;
 	}
+
 	// ------------------------------------------------------------------------
 	// Create Capture factory using program arguments and
 	// open Video Capture
@@ -71,6 +190,13 @@ int main(int argc, char *argv[])
 	CaptureFactory factory(argList);
 	factory.setSkippable(true);
 
+	// Multiple streams are only handled by ColorModels capture pool
+	if (factory.getNbStreams() > 1)
+	{
+		qWarning("Warning: %d streams requested, only the first one is opened",
+				 factory.getNbStreams());
+	}
+
 	// Helper thread for capture
 	QThread * capThread = NULL;
 	if (threadNumber > 1)
@@ -81,6 +207,17 @@ int main(int argc, char *argv[])
 	// Capture
 	QcvVideoCapture * capture = factory.getCaptureInstance(capThread);
 
+	if (capture == NULL)
+	{
+		cerr << "Unable to open video source" << endl;
+		usage(argv[0]);
+		if (capThread != NULL)
+		{
+			delete capThread;
+		}
+		return EXIT_FAILURE;
+	}
+
 	// ------------------------------------------------------------------------
 	// Create Fourier Processor
 	// ------------------------------------------------------------------------
@@ -102,7 +239,13 @@ int main(int argc, char *argv[])
 	QcvSimpleDFT * processor = NULL;
 	if (procThread == NULL)
 	{
-		processor = new QcvSimpleDFT(capture->getImage());
+		processor = new QcvSimpleDFT(capture->getImage(),
+									 NULL,
+									 NULL,
+									 NULL,
+									 precision,
+									 (size_t) nbWorkers,
+									 frameMode);
 	}
 	else
 	{
@@ -110,16 +253,26 @@ int main(int argc, char *argv[])
 		{
 			processor = new QcvSimpleDFT(capture->getImage(),
 										 capture->getMutex(),
-										 procThread);
+										 procThread,
+										 NULL,
+										 precision,
+										 (size_t) nbWorkers,
+										 frameMode);
 		}
 		else // procThread == capThread
 		{
 			processor = new QcvSimpleDFT(capture->getImage(),
 										 NULL,
-										 procThread);
+										 procThread,
+										 NULL,
+										 precision,
+										 (size_t) nbWorkers,
+										 frameMode);
 		}
 	}
 
+	processor->setKernelSize(kernelSize);
+
 	// ------------------------------------------------------------------------
 	// Connects capture to processor
 	// ------------------------------------------------------------------------
@@ -172,7 +325,161 @@ void usage(char * name)
 		 << "[-d | --device] <device number> "
 		 << "[-v | --video] <video file> "
 		 << "[-s | --size] <width>x<height> "
+		 << "[-y | --synthetic] <width>x<height>[@<rate>][:<pattern>] "
+		 << "[--raw] <path>:<width>x<height>[@<rate>] "
+		 << "[--sequence] <glob pattern>[@<rate>] "
 		 << "[-m | --mirror]"
 		 << "[-g | --gray]"
+		 << "[--float]"
+		 << "[--full-frame]"
+		 << "[--workers] <n>"
+		 << "[--kernel] <size>"
+		 << "[--benchmark] [<frames>]"
 		 << endl;
 }
+
+/*
+ * Compares double and single precision Fourier transforms runtimes
+ * on random images for several DFT sizes and prints results on
+ * standard output
+ * @param frames number of timed updates for each size and precision
+ * @param nbWorkers number of threads transforming channels
+ */
+void benchmark(const int frames, const size_t nbWorkers)
+{
+	static const int sizes[] = {128, 256, 384, 512, 640, 768, 1024};
+	static const size_t nbSizes = sizeof(sizes) / sizeof(int);
+	static const int warmupFrames = 5;
+
+	cout << "size\tdft\tdouble (ms)\tfloat (ms)\tspeedup" << endl;
+
+	for (size_t s = 0; s < nbSizes; s++)
+	{
+		Mat image(sizes[s], sizes[s], CV_8UC3);
+		randu(image, Scalar::all(0), Scalar::all(256));
+
+		double times[CvSimpleDFT::NbPrecisions];
+		int dftSize = 0;
+
+		for (int p = 0; p < CvSimpleDFT::NbPrecisions; p++)
+		{
+			CvSimpleDFT dft(&image, (CvSimpleDFT::Precision) p, nbWorkers);
+			dftSize = dft.getOptimalDftSize();
+
+			for (int i = 0; i < warmupFrames; i++)
+			{
+				dft.update();
+			}
+
+			int64 start = getTickCount();
+			for (int i = 0; i < frames; i++)
+			{
+				dft.update();
+			}
+			times[p] = ((double) (getTickCount() - start) * 1000.0) /
+				(getTickFrequency() * (double) frames);
+		}
+
+		cout << sizes[s] << "\t" << dftSize << "\t"
+			 << times[CvSimpleDFT::DOUBLE_PRECISION] << "\t\t"
+			 << times[CvSimpleDFT::SINGLE_PRECISION] << "\t\t"
+			 << times[CvSimpleDFT::DOUBLE_PRECISION] /
+				times[CvSimpleDFT::SINGLE_PRECISION]
+			 << endl;
+	}
+}
+
+/*
+ * Compares direct and FFT (overlap-save and overlap-add) filtering
+ * runtimes on a random VGA color image for several odd and even kernel
+ * sizes and prints results on standard output along with the method
+ * chosen by automatic selection and the maximum absolute difference
+ * between FFT and cv::filter2D results (on the VGA image and on an image
+ * whose size is not a multiple of tiles size, so border tiles are partial)
+ * @param frames number of timed filterings for each kernel size and method
+ * @param nbWorkers number of threads filtering tiles
+ */
+void convolutionBenchmark(const int frames, const size_t nbWorkers)
+{
+	static const int kernelSizes[] = {5, 8, 15, 16, 31, 32, 45, 63, 64};
+	static const size_t nbKernelSizes = sizeof(kernelSizes) / sizeof(int);
+	static const char * methodNames[CvFFTConvolver::NbMethods] =
+	{
+		"auto",
+		"direct",
+		"save",
+		"add"
+	};
+
+	Mat image(480, 640, CV_8UC3);
+	randu(image, Scalar::all(0), Scalar::all(256));
+	Mat filtered;
+
+	// odd sized image : last tiles of each row and column are partial
+	Mat oddImage(301, 517, CV_8UC3);
+	randu(oddImage, Scalar::all(0), Scalar::all(256));
+	const Mat * checkedImages[] = {&image, &oddImage};
+	Mat reference;
+	Mat result;
+
+	cout << "kernel\tdirect (ms)\tsave (ms)\tadd (ms)\tauto"
+		 << "\tsave error\tadd error" << endl;
+
+	for (size_t k = 0; k < nbKernelSizes; k++)
+	{
+		Mat kernel(kernelSizes[k], kernelSizes[k], CV_32F);
+		randu(kernel, Scalar::all(0), Scalar::all(1));
+		kernel /= sum(kernel)[0];
+
+		CvFFTConvolver convolver(kernel,
+								 CvFFTConvolver::AUTO_CONVOLUTION,
+								 CvFFTConvolver::defaultTileSize,
+								 nbWorkers);
+
+		double times[CvFFTConvolver::NbMethods];
+		for (int m = CvFFTConvolver::DIRECT_CONVOLUTION;
+			 m < CvFFTConvolver::NbMethods; m++)
+		{
+			convolver.setMethod((CvFFTConvolver::Method) m);
+			// warmup computes kernel spectrum and allocates buffers
+			convolver.apply(image, filtered);
+
+			int64 start = getTickCount();
+			for (int i = 0; i < frames; i++)
+			{
+				convolver.apply(image, filtered);
+			}
+			times[m] = ((double) (getTickCount() - start) * 1000.0) /
+				(getTickFrequency() * (double) frames);
+		}
+
+		// max abs difference with filter2D on float results (so rounding
+		// to 8 bits does not hide errors) for both FFT methods
+		double errors[CvFFTConvolver::NbMethods] = {0.0, 0.0, 0.0, 0.0};
+		for (size_t i = 0; i < 2; i++)
+		{
+			filter2D(*checkedImages[i], reference, CV_32F, kernel,
+					 Point(-1, -1), 0.0, BORDER_REFLECT_101);
+
+			for (int m = CvFFTConvolver::OVERLAP_SAVE;
+				 m < CvFFTConvolver::NbMethods; m++)
+			{
+				convolver.setMethod((CvFFTConvolver::Method) m);
+				convolver.apply(*checkedImages[i], result, CV_32F,
+								BORDER_REFLECT_101);
+				errors[m] = std::max(errors[m],
+									 norm(reference, result, NORM_INF));
+			}
+		}
+		convolver.setMethod(CvFFTConvolver::AUTO_CONVOLUTION);
+
+		cout << kernelSizes[k] << "x" << kernelSizes[k] << "\t"
+			 << times[CvFFTConvolver::DIRECT_CONVOLUTION] << "\t\t"
+			 << times[CvFFTConvolver::OVERLAP_SAVE] << "\t\t"
+			 << times[CvFFTConvolver::OVERLAP_ADD] << "\t\t"
+			 << methodNames[convolver.selectMethod(image.size())] << "\t"
+			 << errors[CvFFTConvolver::OVERLAP_SAVE] << "\t\t"
+			 << errors[CvFFTConvolver::OVERLAP_ADD]
+			 << endl;
+	}
+}
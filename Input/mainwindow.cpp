@@ -30,6 +30,8 @@ MainWindow::MainWindow(QcvVideoCapture * capture,
 	ui->setupUi(this);
 	ui->scrollAreaSource->setBackgroundRole(QPalette::Mid);
 	ui->scrollAreaSpectrum->setBackgroundRole(QPalette::Mid);
+	ui->scrollAreaFiltered->setBackgroundRole(QPalette::Mid);
+	ui->scrollAreaSpectrogram->setBackgroundRole(QPalette::Mid);
 
 	// ------------------------------------------------------------------------
 	// Assertions
@@ -47,7 +49,7 @@ MainWindow::MainWindow(QcvVideoCapture * capture,
 	// connects processor->image changed to image widgets->setSourceImage
 	setRenderingMode(RENDER_IMAGE);
 
-	ui->labelFFTSizeValue->setText(QString::number(processor->getOptimalDftSize()));
+	ui->labelFFTSizeValue->setText(processor->getDftSizeText());
 
 	// ------------------------------------------------------------------------
 	// rest of Signal/Slot connections
@@ -143,6 +145,36 @@ MainWindow::MainWindow(QcvVideoCapture * capture,
 	ui->spinBoxMag->setValue((int)processor->getLogScaleFactor());
 	ui->spinBoxMag->setMinimum((int)processor->minLogScaleFactor);
 	ui->spinBoxMag->setMaximum((int)processor->maxLogScaleFactor);
+
+	// Sets single precision checkbox state
+	ui->checkBoxFloat->setChecked(processor->getPrecision() ==
+								  CvSimpleDFT::SINGLE_PRECISION);
+
+	// Sets frame mode widgets values
+	ui->checkBoxFullFrame->setChecked(processor->getFrameMode() ==
+									  CvSimpleDFT::FULL_FRAME);
+	ui->comboBoxPadding->setCurrentIndex((int)processor->getPaddingMode());
+	ui->comboBoxPadding->setEnabled(ui->checkBoxFullFrame->isChecked());
+
+	// Sets filter widgets values
+	ui->comboBoxFilterType->setCurrentIndex((int)processor->getFilterType());
+	ui->comboBoxFilterShape->setCurrentIndex((int)processor->getFilterShape());
+	ui->spinBoxCutoff->setValue((int)processor->getFilterCutoff());
+	ui->spinBoxBandWidth->setValue((int)processor->getFilterBandWidth());
+	ui->spinBoxOrder->setValue(processor->getFilterOrder());
+	ui->spinBoxNotchX->setValue(processor->getNotchOffset().x);
+	ui->spinBoxNotchY->setValue(processor->getNotchOffset().y);
+
+	// Sets blur widgets values
+	ui->spinBoxKernelSize->setValue(MAX(processor->getKernelSize(), 1));
+	ui->comboBoxConvolution->setCurrentIndex(
+		(int)processor->getConvolutionMethod());
+
+	// Sets temporal widgets values
+	ui->comboBoxAveraging->setCurrentIndex((int)processor->getAveragingMode());
+	ui->spinBoxAveragingFrames->setMaximum(processor->maxAveragingFrames);
+	ui->spinBoxAveragingFrames->setValue(processor->getAveragingFrames());
+	ui->checkBoxSpectrogram->setChecked(processor->isSpectrogramEnabled());
 }
 
 /*
@@ -327,65 +359,101 @@ void MainWindow::setRenderingMode(const RenderMode mode)
 			   ui->sourceImage, SLOT(update()));
 	disconnect(processor, SIGNAL(updated()),
 			   ui->spectrumImage, SLOT(update()));
+	disconnect(processor, SIGNAL(updated()),
+			   ui->filteredImage, SLOT(update()));
+	disconnect(processor, SIGNAL(updated()),
+			   ui->spectrogramImage, SLOT(update()));
 
 	disconnect(processor, SIGNAL(squareImageChanged(Mat*)),
 			   ui->sourceImage, SLOT(setSourceImage(Mat*)));
 	disconnect(processor, SIGNAL(spectrumImageChanged(Mat*)),
 			   ui->spectrumImage, SLOT(setSourceImage(Mat*)));
+	disconnect(processor, SIGNAL(inverseImageChanged(Mat*)),
+			   ui->filteredImage, SLOT(setSourceImage(Mat*)));
+	disconnect(processor, SIGNAL(spectrogramImageChanged(Mat*)),
+			   ui->spectrogramImage, SLOT(setSourceImage(Mat*)));
 
 	// remove widgets in scroll areas
 	QWidget * wSource = ui->scrollAreaSource->takeWidget();
 	QWidget * wSpectrum = ui->scrollAreaSpectrum->takeWidget();
+	QWidget * wFiltered = ui->scrollAreaFiltered->takeWidget();
+	QWidget * wSpectrogram = ui->scrollAreaSpectrogram->takeWidget();
 
 	if ((wSource == ui->sourceImage) &&
-		(wSpectrum == ui->spectrumImage))
+		(wSpectrum == ui->spectrumImage) &&
+		(wFiltered == ui->filteredImage) &&
+		(wSpectrogram == ui->spectrogramImage))
 	{
 		// delete removed widgets
 		delete ui->sourceImage;
 		delete ui->spectrumImage;
+		delete ui->filteredImage;
+		delete ui->spectrogramImage;
 
 		// create new widget
 		Mat * sourceMat = processor->getImagePtr("square");
 		Mat * spectrumMat = processor->getImagePtr("spectrum");
+		Mat * filteredMat = processor->getImagePtr("filtered");
+		Mat * spectrogramMat = processor->getImagePtr("spectrogram");
 
 		switch (mode)
 		{
 			case RENDER_PIXMAP:
 				ui->sourceImage = new QcvMatWidgetLabel(sourceMat);
 				ui->spectrumImage = new QcvMatWidgetLabel(spectrumMat);
+				ui->filteredImage = new QcvMatWidgetLabel(filteredMat);
+				ui->spectrogramImage = new QcvMatWidgetLabel(spectrogramMat);
 				break;
 			case RENDER_GL:
 				ui->sourceImage = new QcvMatWidgetGL(sourceMat);
 				ui->spectrumImage = new QcvMatWidgetGL(spectrumMat);
+				ui->filteredImage = new QcvMatWidgetGL(filteredMat);
+				ui->spectrogramImage = new QcvMatWidgetGL(spectrogramMat);
 				break;
 			case RENDER_IMAGE:
 			default:
 				ui->sourceImage = new QcvMatWidgetImage(sourceMat);
 				ui->spectrumImage = new QcvMatWidgetImage(spectrumMat);
+				ui->filteredImage = new QcvMatWidgetImage(filteredMat);
+				ui->spectrogramImage = new QcvMatWidgetImage(spectrogramMat);
 				break;
 		}
 
 		if ((ui->sourceImage != NULL) &&
-			(ui->spectrumImage != NULL))
+			(ui->spectrumImage != NULL) &&
+			(ui->filteredImage != NULL) &&
+			(ui->spectrogramImage != NULL))
 		{
 			// Name the new images widgets with same name as in UI files
 			 ui->sourceImage->setObjectName(QString::fromUtf8("sourceImage"));
 			 ui->spectrumImage->setObjectName(QString::fromUtf8("spectrumImage"));
+			 ui->filteredImage->setObjectName(QString::fromUtf8("filteredImage"));
+			 ui->spectrogramImage->setObjectName(QString::fromUtf8("spectrogramImage"));
 
 			// add to scroll areas
 			ui->scrollAreaSource->setWidget(ui->sourceImage);
 			ui->scrollAreaSpectrum->setWidget(ui->spectrumImage);
+			ui->scrollAreaFiltered->setWidget(ui->filteredImage);
+			ui->scrollAreaSpectrogram->setWidget(ui->spectrogramImage);
 
 			// Reconnect signals to slots
 			connect(processor, SIGNAL(updated()),
 					ui->sourceImage, SLOT(update()));
 			connect(processor, SIGNAL(updated()),
 					ui->spectrumImage, SLOT(update()));
+			connect(processor, SIGNAL(updated()),
+					ui->filteredImage, SLOT(update()));
+			connect(processor, SIGNAL(updated()),
+					ui->spectrogramImage, SLOT(update()));
 
 			connect(processor, SIGNAL(squareImageChanged(Mat*)),
 					ui->sourceImage, SLOT(setSourceImage(Mat*)));
 			connect(processor, SIGNAL(spectrumImageChanged(Mat*)),
 					ui->spectrumImage, SLOT(setSourceImage(Mat*)));
+			connect(processor, SIGNAL(inverseImageChanged(Mat*)),
+					ui->filteredImage, SLOT(setSourceImage(Mat*)));
+			connect(processor, SIGNAL(spectrogramImageChanged(Mat*)),
+					ui->spectrogramImage, SLOT(setSourceImage(Mat*)));
 
 			// Sends message to status bar and sets menu checks
 			message.clear();
@@ -429,6 +497,30 @@ void MainWindow::setRenderingMode(const RenderMode mode)
 void MainWindow::setupProcessorFromUI()
 {
 	processor->setLogScaleFactor((double)ui->spinBoxMag->value());
+	processor->setPrecision(ui->checkBoxFloat->isChecked() ?
+							CvSimpleDFT::SINGLE_PRECISION :
+							CvSimpleDFT::DOUBLE_PRECISION);
+	processor->setPaddingMode((CvSimpleDFT::PaddingMode)
+							  ui->comboBoxPadding->currentIndex());
+	processor->setFrameMode(ui->checkBoxFullFrame->isChecked() ?
+							CvSimpleDFT::FULL_FRAME :
+							CvSimpleDFT::SQUARE_FRAME);
+	processor->setFilterType((CvSimpleDFT::FilterType)
+							 ui->comboBoxFilterType->currentIndex());
+	processor->setFilterShape((CvSimpleDFT::FilterShape)
+							  ui->comboBoxFilterShape->currentIndex());
+	processor->setFilterCutoff((double)ui->spinBoxCutoff->value());
+	processor->setFilterBandWidth((double)ui->spinBoxBandWidth->value());
+	processor->setFilterOrder(ui->spinBoxOrder->value());
+	processor->setNotchOffset(Point(ui->spinBoxNotchX->value(),
+									ui->spinBoxNotchY->value()));
+	processor->setKernelSize(ui->spinBoxKernelSize->value());
+	processor->setConvolutionMethod((CvFFTConvolver::Method)
+									ui->comboBoxConvolution->currentIndex());
+	processor->setAveragingMode((CvSimpleDFT::AveragingMode)
+								ui->comboBoxAveraging->currentIndex());
+	processor->setAveragingFrames(ui->spinBoxAveragingFrames->value());
+	processor->setSpectrogramEnabled(ui->checkBoxSpectrogram->isChecked());
 }
 
 /*
@@ -552,3 +644,148 @@ void MainWindow::on_spinBoxMag_valueChanged(int value)
 
 	ui->spinBoxMag->setValue((int)realScale);
 }
+
+/*
+ * Changes Fourier transform precision
+ * changes processor precision to float when checked and double
+ * otherwise
+ */
+void MainWindow::on_checkBoxFloat_clicked()
+{
+	processor->setPrecision(ui->checkBoxFloat->isChecked() ?
+							CvSimpleDFT::SINGLE_PRECISION :
+							CvSimpleDFT::DOUBLE_PRECISION);
+}
+
+/*
+ * Changes processor frame mode : full padded frame when checked,
+ * center square otherwise
+ */
+void MainWindow::on_checkBoxFullFrame_clicked()
+{
+	bool fullFrame = ui->checkBoxFullFrame->isChecked();
+	ui->comboBoxPadding->setEnabled(fullFrame);
+	processor->setFrameMode(fullFrame ? CvSimpleDFT::FULL_FRAME :
+							CvSimpleDFT::SQUARE_FRAME);
+}
+
+/*
+ * Changes processor full frame padding mode
+ * @param index the index of the padding mode in combobox
+ * (Zero, Replicate, Reflect, Wrap)
+ */
+void MainWindow::on_comboBoxPadding_currentIndexChanged(int index)
+{
+	processor->setPaddingMode((CvSimpleDFT::PaddingMode) index);
+}
+
+/*
+ * Changes processor filter type
+ * @param index the index of the filter type in combobox
+ * (None, Low pass, High pass, Band pass, Notch)
+ */
+void MainWindow::on_comboBoxFilterType_currentIndexChanged(int index)
+{
+	processor->setFilterType((CvSimpleDFT::FilterType) index);
+}
+
+/*
+ * Changes processor filter shape
+ * @param index the index of the filter shape in combobox
+ * (Ideal, Butterworth, Gaussian)
+ */
+void MainWindow::on_comboBoxFilterShape_currentIndexChanged(int index)
+{
+	processor->setFilterShape((CvSimpleDFT::FilterShape) index);
+}
+
+/*
+ * Changes processor filter cutoff frequency
+ * @param value the new cutoff frequency
+ */
+void MainWindow::on_spinBoxCutoff_valueChanged(int value)
+{
+	processor->setFilterCutoff((double)value);
+}
+
+/*
+ * Changes processor band pass filter width
+ * @param value the new band width
+ */
+void MainWindow::on_spinBoxBandWidth_valueChanged(int value)
+{
+	processor->setFilterBandWidth((double)value);
+}
+
+/*
+ * Changes processor Butterworth filter order
+ * @param value the new filter order
+ */
+void MainWindow::on_spinBoxOrder_valueChanged(int value)
+{
+	processor->setFilterOrder(value);
+}
+
+/*
+ * Changes processor notches horizontal offset
+ * @param value the new horizontal offset
+ */
+void MainWindow::on_spinBoxNotchX_valueChanged(int value)
+{
+	processor->setNotchOffset(Point(value, ui->spinBoxNotchY->value()));
+}
+
+/*
+ * Changes processor notches vertical offset
+ * @param value the new vertical offset
+ */
+void MainWindow::on_spinBoxNotchY_valueChanged(int value)
+{
+	processor->setNotchOffset(Point(ui->spinBoxNotchX->value(), value));
+}
+
+/*
+ * Changes processor frame blur kernel size
+ * @param value the new kernel size (1 disables blur)
+ */
+void MainWindow::on_spinBoxKernelSize_valueChanged(int value)
+{
+	processor->setKernelSize(value);
+}
+
+/*
+ * Changes processor frame blur convolution method
+ * @param index the index of the method in combobox
+ * (Auto, Direct, Overlap-save, Overlap-add)
+ */
+void MainWindow::on_comboBoxConvolution_currentIndexChanged(int index)
+{
+	processor->setConvolutionMethod((CvFFTConvolver::Method) index);
+}
+
+/*
+ * Changes processor temporal averaging mode
+ * @param index the index of the averaging mode in combobox
+ * (None, Box, Exponential)
+ */
+void MainWindow::on_comboBoxAveraging_currentIndexChanged(int index)
+{
+	processor->setAveragingMode((CvSimpleDFT::AveragingMode) index);
+}
+
+/*
+ * Changes processor number of averaged frames
+ * @param value the new number of averaged frames
+ */
+void MainWindow::on_spinBoxAveragingFrames_valueChanged(int value)
+{
+	processor->setAveragingFrames(value);
+}
+
+/*
+ * Enables or disables processor spectrogram
+ */
+void MainWindow::on_checkBoxSpectrogram_clicked()
+{
+	processor->setSpectrogramEnabled(ui->checkBoxSpectrogram->isChecked());
+}
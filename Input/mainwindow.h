@@ -274,6 +274,101 @@ class MainWindow : public QMainWindow
 		 */
 		void on_spinBoxMag_valueChanged(int value);
 
+		/**
+		 * Changes Fourier transform precision
+		 * changes processor precision to float when checked and double
+		 * otherwise
+		 */
+		void on_checkBoxFloat_clicked();
+
+		/**
+		 * Changes processor frame mode : full padded frame when checked,
+		 * center square otherwise
+		 */
+		void on_checkBoxFullFrame_clicked();
+
+		/**
+		 * Changes processor full frame padding mode
+		 * @param index the index of the padding mode in combobox
+		 * (Zero, Replicate, Reflect, Wrap)
+		 */
+		void on_comboBoxPadding_currentIndexChanged(int index);
+
+		/**
+		 * Changes processor filter type
+		 * @param index the index of the filter type in combobox
+		 * (None, Low pass, High pass, Band pass, Notch)
+		 */
+		void on_comboBoxFilterType_currentIndexChanged(int index);
+
+		/**
+		 * Changes processor filter shape
+		 * @param index the index of the filter shape in combobox
+		 * (Ideal, Butterworth, Gaussian)
+		 */
+		void on_comboBoxFilterShape_currentIndexChanged(int index);
+
+		/**
+		 * Changes processor filter cutoff frequency
+		 * @param value the new cutoff frequency
+		 */
+		void on_spinBoxCutoff_valueChanged(int value);
+
+		/**
+		 * Changes processor band pass filter width
+		 * @param value the new band width
+		 */
+		void on_spinBoxBandWidth_valueChanged(int value);
+
+		/**
+		 * Changes processor Butterworth filter order
+		 * @param value the new filter order
+		 */
+		void on_spinBoxOrder_valueChanged(int value);
+
+		/**
+		 * Changes processor notches horizontal offset
+		 * @param value the new horizontal offset
+		 */
+		void on_spinBoxNotchX_valueChanged(int value);
+
+		/**
+		 * Changes processor notches vertical offset
+		 * @param value the new vertical offset
+		 */
+		void on_spinBoxNotchY_valueChanged(int value);
+
+		/**
+		 * Changes processor frame blur kernel size
+		 * @param value the new kernel size (1 disables blur)
+		 */
+		void on_spinBoxKernelSize_valueChanged(int value);
+
+		/**
+		 * Changes processor frame blur convolution method
+		 * @param index the index of the method in combobox
+		 * (Auto, Direct, Overlap-save, Overlap-add)
+		 */
+		void on_comboBoxConvolution_currentIndexChanged(int index);
+
+		/**
+		 * Changes processor temporal averaging mode
+		 * @param index the index of the averaging mode in combobox
+		 * (None, Box, Exponential)
+		 */
+		void on_comboBoxAveraging_currentIndexChanged(int index);
+
+		/**
+		 * Changes processor number of averaged frames
+		 * @param value the new number of averaged frames
+		 */
+		void on_spinBoxAveragingFrames_valueChanged(int value);
+
+		/**
+		 * Enables or disables processor spectrogram
+		 */
+		void on_checkBoxSpectrogram_clicked();
+
 };
 
 #endif // MAINWINDOW_H